@@ -1,257 +1,542 @@
-/********************************************************************************
-* person.c: Innehller definitioner av associerade funktioner tillhrande
-*           strukten person, som anvnds fr agring samt utskrift av persondata.
-********************************************************************************/
-#include "person.h"
-
-/********************************************************************************
-* person_mem: Strukt innehllande variabler fr lagring av persondata.
-********************************************************************************/
-typedef struct person_mem
-{
-   const char* name;       /* Personens namn. */
-   unsigned int age;       /* Personens lder. */
-   const char* address;    /* Personens hemadress. */
-   const char* occupation; /* Personens yrke. */
-   enum gender gender;     /* Personens kn. */
-} person_mem_t, *person_mem_ptr_t;
-
-/* Statiska funktioner: */
-static struct person_vtable* person_vtable_ptr_new(void);
-static struct person_mem* person_mem_new(const char* name,
-                                         const unsigned age,
-                                         const char* address,
-                                         const char* occupation,
-                                         const enum gender gender);
-static void person_mem_delete(struct person_mem** self);
-
-/********************************************************************************
-* person_init: Lagrar angiven persondata i ett person-objekt.
-*
-*              - self      : Pekare till objektet som ska lagra uppgifterna.
-*              - name      : Personens namn.
-*              - age       : Personens lder.
-*              - address   : Personens hemadress.
-*              - occupation: Personens yrke.
-*              - gender    : Personens kn.
-********************************************************************************/
-void person_init(struct person* self,
-                 const char* name,
-                 const unsigned int age,
-                 const char* address,
-                 const char* occupation,
-                 const enum gender gender)
-{
-   self->mem = person_mem_new(name, age, address, occupation, gender);
-   self->vptr = person_vtable_ptr_new();
-   return;
-}
-
-/********************************************************************************
-* person_clear: Nollstller persondata lagrat av angivet person-objekt.
-*
-*               - self: Pekare till objektet som ska nollstllas.
-********************************************************************************/
-void person_clear(struct person* self)
-{
-   person_mem_delete(&self->mem);
-   self->vptr = 0;
-   return;
-}
-
-/********************************************************************************
-* person_new: Allokerar minne och lagrar angiven persondata i ett person-objekt.
-*             En pekare till det dynamiskt allokerade objektet returneras.
-*             Om minnesallokeringen misslyckas s returneras null.
-*
-*             - name      : Personens namn.
-*             - age       : Personens lder.
-*             - address   : Personens hemadress.
-*             - occupation: Personens yrke.
-*             - gender    : Personens kn.
-********************************************************************************/
-struct person* person_new(const char* name,
-                          const unsigned int age,
-                          const char* address,
-                          const char* occupation,
-                          const enum gender gender)
-{
-   struct person* self = (struct person*)malloc(sizeof(struct person));
-   if (!self) return 0;
-   person_init(self, name, age, address, occupation, gender);
-   return self;
-}
-
-/********************************************************************************
-* person_delete: Raderar angivet person-objekt genom att frigra dynamiskt
-*                allokerat minne fr denna och stter motsvarande pekare till
-*                null. Fr att mjliggra detta passeras adressen till den pekare 
-*                som pekar p det dynamiskt allokerade minnet.
-*
-*                - self: Adressen till den pekare som pekar p objektet som
-*                        som ska raderas.
-********************************************************************************/
-void person_delete(struct person** self)
-{
-   free(*self);
-   *self = 0;
-   return;
-}
-
-/********************************************************************************
-* person_print: Skriver ut lagrad persondata via angiven utstrm, dr
-*               standardutenheten stdout anvnds som default fr utskrift
-*               i terminalen.
-*
-*               - self   : Pekare till objektet som lagrar persondatan.
-*               - ostream: Pekare till angiven utstrm (default = stdout).
-********************************************************************************/
-void person_print(const struct person* self,
-                  FILE* ostream)
-{
-   if (!ostream) ostream = stdout;
-   fprintf(ostream, "--------------------------------------------------------------------------------\n");
-   fprintf(ostream, "Name: %s\n", self->mem->name);
-   fprintf(ostream, "Age: %u\n", self->mem->age);
-   fprintf(ostream, "Address: %s\n", self->mem->address);
-   fprintf(ostream, "Occupation: %s\n", self->mem->occupation);
-   fprintf(ostream, "Gender: %s\n", person_gender_str(self));
-   fprintf(ostream, "--------------------------------------------------------------------------------\n\n");
-   return;
-}
-
-/********************************************************************************
-* person_gender_str: Returnerar personens kn p textform.
-*
-*                    - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-const char* person_gender_str(const struct person* self)
-{ 
-   if (self->mem->gender == GENDER_MALE) return "Male";
-   else if (self->mem->gender == GENDER_FEMALE) return "Female";
-   else if (self->mem->gender == GENDER_OTHER) return "Other";
-   else return "Unspecified";
-}
-
-/********************************************************************************
-* person_name: Returnerar personens namn.
-*
-*              - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-const char* person_name(const struct person* self)
-{
-   return self->mem->name;
-}
-
-/********************************************************************************
-* person_age: Returnerar personens lder.
-*
-*             - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-unsigned int person_age(const struct person* self)
-{
-   return self->mem->age;
-}
-
-/********************************************************************************
-* person_address: Returnerar personens hemadress.
-*
-*                 - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-const char* person_address(const struct person* self)
-{
-   return self->mem->address;
-}
-
-/********************************************************************************
-* person_occupation: Returnerar personens yrke.
-*
-*                    - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-const char* person_occupation(const struct person* self)
-{
-   return self->mem->occupation;
-}
-
-/********************************************************************************
-* person_gender: Returnerar personens kn som en enumerator av enumeration
-*                gender, allts GENDER_MALE, GENDER_FEMALE, GENDER_OTHER eller
-*                GENDER_NONE.
-*
-*                - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-enum gender person_gender(const struct person* self)
-{
-   return self->mem->gender;
-}
-
-/********************************************************************************
-* person_vtable_ptr_new: Returnerar en pekare till ett vtable innehllande
-*                        funktionspekare till associerade funktioner fr
-*                        strukten person. Tabellen deklareras statiskt s att
-*                        minnet fr den kvarstr hela programmet. Pekarna stts
-*                        till att peka p motsvarande funktioner vid start.
-*                        Vid anrop av denna funktion returneras sedan en pekare
-*                        till denna tabell.
-********************************************************************************/
-static struct person_vtable* person_vtable_ptr_new(void)
-{
-   static struct person_vtable self = 
-   {
-      .print = &person_print,
-      .gender_str = &person_gender_str,
-      .name = &person_name,
-      .age = &person_age,
-      .address = &person_address,
-      .occupation = &person_occupation,
-      .gender = &person_gender,
-      .clear = &person_clear
-   };
-
-   return &self;
-}
-
-/********************************************************************************
-* person_mem_new: Allokerar minne fr lagring av ny persondata och returnerar
-*                 en pekare till det objekt som lagrar persondatan. Ifall
-*                 minnesallokeringen misslyckas s returneras en nullpekare.
-* 
-*                 - name      : Personens namn.
-*                 - age       : Personens lder.
-*                 - address   : Personens hemadress.
-*                 - occupation: Personens yrke.
-*                 - gender    : Personens kn.
-********************************************************************************/
-static struct person_mem* person_mem_new(const char* name,
-                                         const unsigned age,
-                                         const char* address,
-                                         const char* occupation,
-                                         const enum gender gender)
-{
-   struct person_mem* self = (struct person_mem*)malloc(sizeof(struct person_mem));
-   if (!self) return 0;
-   self->name = name;
-   self->age = age;
-   self->address = address;
-   self->occupation = occupation;
-   self->gender = gender;
-   return self;
-}
-
-/********************************************************************************
-* person_mem_delete: Frigr minne allokerat fr lagring av persondata och
-*                    stter motsvarande pekare till null. Fr att mjliggra
-*                    detta s passeras adressen till den pekare som pekar p
-*                    personuppgifterna (annars hade en kopia av denna pekare
-*                    kommit fram och vi hade d inte kunnat stta ordinarie
-*                    pekaren till null, bara kopian).
-*
-*                    - self: Adressen till den pekare som pekar p 
-*                            personuppgifterna.
-********************************************************************************/
-static void person_mem_delete(struct person_mem** self)
-{
-   free(*self);
-   *self = 0;
-   return;
-}
\ No newline at end of file
+/********************************************************************************
+* person.c: Innehåller definitioner av associerade funktioner tillhörande
+*           strukten person, som används för agring samt utskrift av persondata.
+********************************************************************************/
+#include "person.h"
+#include "person_mem.h"
+#include "person_alloc.h"
+#include "person_stats.h"
+#include <stdatomic.h>
+#include <string.h>
+
+/* Global generation. Ändrade objekt stämplas med aktuellt värde, som enbart
+   räknas upp av person_generation_current (dvs. vid export). */
+static _Atomic uint64_t person_generation_counter = 1;
+
+/* Statiska funktioner: */
+static struct person_vtable* person_vtable_ptr_new(void);
+static struct person_mem* person_mem_new(const struct person_allocator* allocator,
+                                         const char* name,
+                                         const unsigned age,
+                                         const char* address,
+                                         const char* occupation,
+                                         const enum gender gender);
+static void person_mem_delete(struct person_mem** self);
+static void person_changed(struct person* self);
+
+/********************************************************************************
+* person_init: Lagrar angiven persondata i ett person-objekt.
+*
+*              - self      : Pekare till objektet som ska lagra uppgifterna.
+*              - name      : Personens namn.
+*              - age       : Personens ålder.
+*              - address   : Personens hemadress.
+*              - occupation: Personens yrke.
+*              - gender    : Personens kön.
+********************************************************************************/
+void person_init(struct person* self,
+                 const char* name,
+                 const unsigned int age,
+                 const char* address,
+                 const char* occupation,
+                 const enum gender gender)
+{
+   person_init_with(self, 0, name, age, address, occupation, gender);
+   return;
+}
+
+/********************************************************************************
+* person_init_with: Lagrar angiven persondata i ett person-objekt, där minnet
+*                   för persondatan allokeras via angiven allokator. Minnet
+*                   frigörs via samma allokator vid anrop av person_clear.
+*
+*                   - self      : Pekare till objektet som ska lagra uppgifterna.
+*                   - allocator : Allokatorn som ska användas (null = malloc).
+*                   - name      : Personens namn.
+*                   - age       : Personens ålder.
+*                   - address   : Personens hemadress.
+*                   - occupation: Personens yrke.
+*                   - gender    : Personens kön.
+********************************************************************************/
+void person_init_with(struct person* self,
+                      const struct person_allocator* allocator,
+                      const char* name,
+                      const unsigned int age,
+                      const char* address,
+                      const char* occupation,
+                      const enum gender gender)
+{
+   if (!allocator) allocator = person_allocator_default();
+   self->mem = person_mem_new(allocator, name, age, address, occupation, gender);
+   self->vptr = person_vtable_ptr_new();
+   return;
+}
+
+/********************************************************************************
+* person_clear: Nollställer persondata lagrat av angivet person-objekt. Objekt
+*               utan person_mem (exempelvis person_inline och vyer)
+*               nollställs via sin egen clear-funktion i vtabellen.
+*
+*               - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_clear(struct person* self)
+{
+   if (!self->mem && self->vptr && self->vptr->clear && self->vptr->clear != &person_clear)
+   {
+      self->vptr->clear(self);
+      return;
+   }
+
+   person_mem_delete(&self->mem);
+   self->vptr = 0;
+   return;
+}
+
+/********************************************************************************
+* person_new: Allokerar minne och lagrar angiven persondata i ett person-objekt.
+*             En pekare till det dynamiskt allokerade objektet returneras.
+*             Om minnesallokeringen misslyckas så returneras null.
+*
+*             - name      : Personens namn.
+*             - age       : Personens ålder.
+*             - address   : Personens hemadress.
+*             - occupation: Personens yrke.
+*             - gender    : Personens kön.
+********************************************************************************/
+struct person* person_new(const char* name,
+                          const unsigned int age,
+                          const char* address,
+                          const char* occupation,
+                          const enum gender gender)
+{
+   return person_new_with(0, name, age, address, occupation, gender);
+}
+
+/********************************************************************************
+* person_new_with: Allokerar minne via angiven allokator och lagrar angiven
+*                  persondata i ett person-objekt. En pekare till objektet
+*                  returneras. Om minnesallokeringen misslyckas så returneras
+*                  null. Objektet raderas via person_delete_with med samma
+*                  allokator.
+*
+*                  - allocator : Allokatorn som ska användas (null = malloc).
+*                  - name      : Personens namn.
+*                  - age       : Personens ålder.
+*                  - address   : Personens hemadress.
+*                  - occupation: Personens yrke.
+*                  - gender    : Personens kön.
+********************************************************************************/
+struct person* person_new_with(const struct person_allocator* allocator,
+                               const char* name,
+                               const unsigned int age,
+                               const char* address,
+                               const char* occupation,
+                               const enum gender gender)
+{
+   PERSON_STATS_START(start);
+   if (!allocator) allocator = person_allocator_default();
+   struct person* self = (struct person*)allocator->alloc(allocator->context, sizeof(struct person));
+   if (!self) return 0;
+   PERSON_STATS_ALLOC(sizeof(struct person));
+   person_init_with(self, allocator, name, age, address, occupation, gender);
+
+   if (!self->mem)
+   {
+      allocator->free(allocator->context, self, sizeof(struct person));
+      PERSON_STATS_FREE(sizeof(struct person));
+      return 0;
+   }
+   PERSON_STATS_STOP(PERSON_STATS_NEW, start);
+   return self;
+}
+
+/********************************************************************************
+* person_delete: Raderar angivet person-objekt genom att frigöra dynamiskt
+*                allokerat minne för denna (inklusive lagrad persondata) och
+*                sätter motsvarande pekare till null. För att möjliggöra
+*                detta passeras adressen till den pekare som pekar på det
+*                dynamiskt allokerade minnet.
+*
+*                - self: Adressen till den pekare som pekar på objektet som
+*                        som ska raderas.
+********************************************************************************/
+void person_delete(struct person** self)
+{
+   person_delete_with(0, self);
+   return;
+}
+
+/********************************************************************************
+* person_delete_with: Raderar angivet person-objekt, som tidigare allokerats
+*                     via person_new_with, genom att frigöra dess minne via
+*                     angiven allokator och sätter motsvarande pekare till null.
+*
+*                     - allocator: Allokatorn som användes vid allokeringen
+*                                  (null = malloc).
+*                     - self     : Adressen till den pekare som pekar på
+*                                  objektet som ska raderas.
+********************************************************************************/
+void person_delete_with(const struct person_allocator* allocator,
+                        struct person** self)
+{
+   if (!*self) return;
+   PERSON_STATS_START(start);
+   if (!allocator) allocator = person_allocator_default();
+   person_clear(*self);
+   allocator->free(allocator->context, *self, sizeof(struct person));
+   PERSON_STATS_FREE(sizeof(struct person));
+   *self = 0;
+   PERSON_STATS_STOP(PERSON_STATS_DELETE, start);
+   return;
+}
+
+/********************************************************************************
+* person_block_size: Returnerar storleken på det största minnesblock som
+*                    allokeras per person-objekt via person_new_with, vilket
+*                    används som blockstorlek vid allokering via en person_slab.
+********************************************************************************/
+size_t person_block_size(void)
+{
+   return sizeof(struct person) > sizeof(struct person_mem) ?
+      sizeof(struct person) : sizeof(struct person_mem);
+}
+
+/********************************************************************************
+* person_print: Skriver ut lagrad persondata via angiven utström, där
+*               standardutenheten stdout används som default för utskrift
+*               i terminalen. Persondatan läses via objektets vtable, vilket
+*               gör att funktionen kan användas för samtliga person-varianter
+*               (exempelvis vyer i en person_store).
+*
+*               - self   : Pekare till objektet som lagrar persondatan.
+*               - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+void person_print(const struct person* self,
+                  FILE* ostream)
+{
+   PERSON_STATS_START(start);
+   int written = 0;
+   if (!ostream) ostream = stdout;
+   written += fprintf(ostream, "--------------------------------------------------------------------------------\n");
+   written += fprintf(ostream, "Name: %s\n", self->vptr->name(self));
+   written += fprintf(ostream, "Age: %u\n", self->vptr->age(self));
+   written += fprintf(ostream, "Address: %s\n", self->vptr->address(self));
+   written += fprintf(ostream, "Occupation: %s\n", self->vptr->occupation(self));
+   written += fprintf(ostream, "Gender: %s\n", self->vptr->gender_str(self));
+   written += fprintf(ostream, "--------------------------------------------------------------------------------\n\n");
+   PERSON_STATS_WRITE(written > 0 ? (uint64_t)written : 0);
+   PERSON_STATS_STOP(PERSON_STATS_PRINT, start);
+   return;
+}
+
+/********************************************************************************
+* gender_str: Returnerar angivet kön på textform.
+*
+*             - gender: Könet som ska omvandlas till text.
+********************************************************************************/
+const char* gender_str(const enum gender gender)
+{
+   if (gender == GENDER_MALE) return "Male";
+   else if (gender == GENDER_FEMALE) return "Female";
+   else if (gender == GENDER_OTHER) return "Other";
+   else return "Unspecified";
+}
+
+/********************************************************************************
+* gender_from_str: Returnerar det kön som motsvarar angiven text, dvs. den text
+*                  som returneras av gender_str. Okänd text ger GENDER_NONE.
+*
+*                  - s: Texten som ska omvandlas.
+********************************************************************************/
+enum gender gender_from_str(const char* s)
+{
+   if (!strcmp(s, "Male")) return GENDER_MALE;
+   else if (!strcmp(s, "Female")) return GENDER_FEMALE;
+   else if (!strcmp(s, "Other")) return GENDER_OTHER;
+   else return GENDER_NONE;
+}
+
+/********************************************************************************
+* person_gender_str: Returnerar personens kön på textform.
+*
+*                    - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_gender_str(const struct person* self)
+{ 
+   return gender_str(self->mem->gender);
+}
+
+/********************************************************************************
+* person_name: Returnerar personens namn.
+*
+*              - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_name(const struct person* self)
+{
+   return self->mem->name;
+}
+
+/********************************************************************************
+* person_age: Returnerar personens ålder.
+*
+*             - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+unsigned int person_age(const struct person* self)
+{
+   return self->mem->age;
+}
+
+/********************************************************************************
+* person_address: Returnerar personens hemadress.
+*
+*                 - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_address(const struct person* self)
+{
+   return self->mem->address;
+}
+
+/********************************************************************************
+* person_occupation: Returnerar personens yrke.
+*
+*                    - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_occupation(const struct person* self)
+{
+   return self->mem->occupation;
+}
+
+/********************************************************************************
+* person_gender: Returnerar personens kön som en enumerator av enumeration
+*                gender, alltså GENDER_MALE, GENDER_FEMALE, GENDER_OTHER eller
+*                GENDER_NONE.
+*
+*                - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+enum gender person_gender(const struct person* self)
+{
+   return self->mem->gender;
+}
+
+/********************************************************************************
+* person_set_name: Ändrar personens namn och markerar objektet som ändrat.
+*                  Strängen kopieras inte, på samma sätt som vid person_init.
+*                  Enbart objekt med egen persondata, dvs. objekt som
+*                  initierats via person_init eller person_new, kan
+*                  ändras. För övriga objekt, exempelvis vyer och
+*                  person_inline-objekt, returneras 1 och objektet
+*                  lämnas oförändrat. Vid lyckad ändring returneras 0.
+*
+*                  - self: Pekare till objektet som lagrar persondatan.
+*                  - name: Personens nya namn.
+********************************************************************************/
+int person_set_name(struct person* self,
+                    const char* name)
+{
+   if (!self->mem) return 1;
+   self->mem->name = name;
+   person_changed(self);
+   return 0;
+}
+
+/********************************************************************************
+* person_set_age: Ändrar personens ålder och markerar objektet som ändrat.
+*                 Vid lyckad ändring returneras 0, annars returneras 1
+*                 (se person_set_name).
+*
+*                 - self: Pekare till objektet som lagrar persondatan.
+*                 - age : Personens nya ålder.
+********************************************************************************/
+int person_set_age(struct person* self,
+                   const unsigned int age)
+{
+   if (!self->mem) return 1;
+   self->mem->age = age;
+   person_changed(self);
+   return 0;
+}
+
+/********************************************************************************
+* person_set_address: Ändrar personens hemadress och markerar objektet som
+*                     ändrat. Strängen kopieras inte. Vid lyckad ändring
+*                     returneras 0, annars returneras 1 (se person_set_name).
+*
+*                     - self   : Pekare till objektet som lagrar persondatan.
+*                     - address: Personens nya hemadress.
+********************************************************************************/
+int person_set_address(struct person* self,
+                       const char* address)
+{
+   if (!self->mem) return 1;
+   self->mem->address = address;
+   person_changed(self);
+   return 0;
+}
+
+/********************************************************************************
+* person_set_occupation: Ändrar personens yrke och markerar objektet som
+*                        ändrat. Strängen kopieras inte. Vid lyckad ändring
+*                        returneras 0, annars returneras 1 (se
+*                        person_set_name).
+*
+*                        - self      : Pekare till objektet som lagrar persondatan.
+*                        - occupation: Personens nya yrke.
+********************************************************************************/
+int person_set_occupation(struct person* self,
+                          const char* occupation)
+{
+   if (!self->mem) return 1;
+   self->mem->occupation = occupation;
+   person_changed(self);
+   return 0;
+}
+
+/********************************************************************************
+* person_set_gender: Ändrar personens kön och markerar objektet som ändrat.
+*                    Vid lyckad ändring returneras 0, annars returneras 1
+*                    (se person_set_name).
+*
+*                    - self  : Pekare till objektet som lagrar persondatan.
+*                    - gender: Personens nya kön.
+********************************************************************************/
+int person_set_gender(struct person* self,
+                      const enum gender gender)
+{
+   if (!self->mem) return 1;
+   self->mem->gender = gender;
+   person_changed(self);
+   return 0;
+}
+
+/********************************************************************************
+* person_generation: Returnerar generationen för objektets senaste ändring.
+*                    Objekt utan egen persondata (exempelvis vyer) betraktas
+*                    alltid som ändrade, varvid UINT64_MAX returneras.
+*
+*                    - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+uint64_t person_generation(const struct person* self)
+{
+   return self->mem ? self->mem->generation : UINT64_MAX;
+}
+
+/********************************************************************************
+* person_generation_current: Returnerar den globala generationen och räknar
+*                            upp den, så att objekt som ändras efter anropet
+*                            får en högre generation än det returnerade
+*                            värdet.
+********************************************************************************/
+uint64_t person_generation_current(void)
+{
+   return atomic_fetch_add_explicit(&person_generation_counter, 1, memory_order_acq_rel);
+}
+
+/********************************************************************************
+* person_vtable_ptr_new: Returnerar en pekare till ett vtable innehållande
+*                        funktionspekare till associerade funktioner för
+*                        strukten person. Tabellen deklareras statiskt så att
+*                        minnet för den kvarstår hela programmet. Pekarna sätts
+*                        till att peka på motsvarande funktioner vid start.
+*                        Vid anrop av denna funktion returneras sedan en pekare
+*                        till denna tabell.
+********************************************************************************/
+static struct person_vtable* person_vtable_ptr_new(void)
+{
+   static struct person_vtable self = 
+   {
+      .print = &person_print,
+      .gender_str = &person_gender_str,
+      .name = &person_name,
+      .age = &person_age,
+      .address = &person_address,
+      .occupation = &person_occupation,
+      .gender = &person_gender,
+      .clear = &person_clear
+   };
+
+   return &self;
+}
+
+/********************************************************************************
+* person_mem_new: Allokerar minne för lagring av ny persondata och returnerar
+*                 en pekare till det objekt som lagrar persondatan. Ifall
+*                 minnesallokeringen misslyckas så returneras en nullpekare.
+* 
+*                 - allocator : Allokatorn som minnet ska allokeras via.
+*                 - name      : Personens namn.
+*                 - age       : Personens ålder.
+*                 - address   : Personens hemadress.
+*                 - occupation: Personens yrke.
+*                 - gender    : Personens kön.
+********************************************************************************/
+static struct person_mem* person_mem_new(const struct person_allocator* allocator,
+                                         const char* name,
+                                         const unsigned age,
+                                         const char* address,
+                                         const char* occupation,
+                                         const enum gender gender)
+{
+   PERSON_STATS_START(start);
+   struct person_mem* self = (struct person_mem*)allocator->alloc(allocator->context,
+                                                                  sizeof(struct person_mem));
+   if (!self) return 0;
+   PERSON_STATS_ALLOC(sizeof(struct person_mem));
+   self->name = name;
+   self->age = age;
+   self->address = address;
+   self->occupation = occupation;
+   self->gender = gender;
+   self->allocator = allocator;
+   self->generation = atomic_load_explicit(&person_generation_counter, memory_order_relaxed);
+   self->delta = 0;
+   self->dirty_index = 0;
+   atomic_init(&self->dirty, 0);
+   PERSON_STATS_STOP(PERSON_STATS_MEM_NEW, start);
+   return self;
+}
+
+/********************************************************************************
+* person_mem_delete: Frigör minne allokerat för lagring av persondata och
+*                    sätter motsvarande pekare till null. För att möjliggöra
+*                    detta så passeras adressen till den pekare som pekar på
+*                    personuppgifterna (annars hade en kopia av denna pekare
+*                    kommit fram och vi hade då inte kunnat sätta ordinarie
+*                    pekaren till null, bara kopian). Minnet frigörs via den
+*                    allokator som användes vid allokeringen.
+*
+*                    - self: Adressen till den pekare som pekar på 
+*                            personuppgifterna.
+********************************************************************************/
+static void person_mem_delete(struct person_mem** self)
+{
+   if (!*self) return;
+   PERSON_STATS_START(start);
+   if ((*self)->delta) person_delta_forget((*self)->delta, *self);
+   (*self)->allocator->free((*self)->allocator->context, *self, sizeof(struct person_mem));
+   PERSON_STATS_FREE(sizeof(struct person_mem));
+   *self = 0;
+   PERSON_STATS_STOP(PERSON_STATS_MEM_DELETE, start);
+   return;
+}
+
+/********************************************************************************
+* person_changed: Stämplar angivet objekt med aktuell generation. Stämpeln
+*                 läser enbart den globala generationen, vilket gör att
+*                 samtidiga ändringar i olika trådar inte konkurrerar om
+*                 räknaren. Om objektet spåras av en person_delta läggs det
+*                 dessutom till i deltans lista vid första ändringen sedan
+*                 senaste export.
+*
+*                 - self: Pekare till det ändrade objektet.
+********************************************************************************/
+static void person_changed(struct person* self)
+{
+   struct person_mem* mem = self->mem;
+   mem->generation = atomic_load_explicit(&person_generation_counter, memory_order_relaxed);
+
+   if (mem->delta && !atomic_exchange_explicit(&mem->dirty, 1, memory_order_acq_rel))
+   {
+      person_delta_mark(mem->delta, self);
+   }
+   return;
+}
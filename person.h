@@ -1,205 +1,374 @@
-/********************************************************************************
-* person.h: Innehller funktionalitet fr lagring samt utskrift av persondata
-*           via strukten person samt associerade funktioner.
-********************************************************************************/
-#ifndef PERSON_H_
-#define PERSON_H_
-
-/* Inkluderingsdirektiv: */
-#include <stdio.h>  /* Innehller funktionalitet fr utskrift och inmatning. */
-#include <stdlib.h> /* Innehller funktionalitet fr dynamisk minnesallokering. */
-
-/********************************************************************************
-* gender: Enumeration fr val av kn.
-********************************************************************************/
-typedef enum gender
-{
-   GENDER_MALE,   /* Man. */
-   GENDER_FEMALE, /* Kvinna. */
-   GENDER_OTHER,  /* vrigt. */
-   GENDER_NONE    /* Ospecificerat. */
-} gender_t;
-
-/********************************************************************************
-* person: Strukt fr lagring samt utskrift av persondata.
-********************************************************************************/
-typedef struct person
-{
-   struct person_mem* mem;           /* Pekare till variabler innehllande persondata. */
-   const struct person_vtable* vptr; /* Pekare till vtable innehllande funktionspekare. */
-} person_t, *person_ptr_t;
-
-/********************************************************************************
-* person_vtable: Strukt fr vtable (virtuell tabell) innehllande adresser till 
-*                associerade funktioner fr strukten person.
-********************************************************************************/
-typedef struct person_vtable
-{
-   /********************************************************************************
-   * print: Skriver ut lagrad persondata via angiven utstrm, dr standardutenheten
-   *        stdout anvnds som default fr utskrift i terminalen.
-   *
-   *        - self   : Pekare till objektet som lagrar persondatan.
-   *        - ostream: Pekare till angiven utstrm (default = stdout).
-   ********************************************************************************/
-   void (*print)(const struct person* self,
-                 FILE* ostream);
-
-   /********************************************************************************
-   * gender_str: Returnerar personens kn p textform.
-   *
-   *             - self: Pekare till objektet som lagrar persondatan.
-   ********************************************************************************/
-   const char* (*gender_str)(const struct person* self);
-
-   /********************************************************************************
-   * name: Returnerar personens namn.
-   *
-   *       - self: Pekare till objektet som lagrar persondatan.
-   ********************************************************************************/
-   const char* (*name)(const struct person* self);
-
-   /********************************************************************************
-   * age: Returnerar personens lder.
-   *
-   *      - self: Pekare till objektet som lagrar persondatan.
-   ********************************************************************************/
-   unsigned int (*age)(const struct person* self);
-
-   /********************************************************************************
-   * address: Returnerar personens hemadress.
-   *
-   *          - self: Pekare till objektet som lagrar persondatan.
-   ********************************************************************************/
-   const char* (*address)(const struct person* self);
-
-   /********************************************************************************
-   * occupation: Returnerar personens yrke.
-   *
-   *             - self: Pekare till objektet som lagrar persondatan.
-   ********************************************************************************/
-   const char* (*occupation)(const struct person* self);
-
-   /********************************************************************************
-   * gender: Returnerar personens kn som en enumerator av enumerationen gender.
-   *
-   *         - self: Pekare till objektet som lagrar persondatan.
-   ********************************************************************************/
-   enum gender (*gender)(const struct person* self);
-
-   /********************************************************************************
-   * clear: Nollstller persondata lagrat av angivet person-objekt.
-   *
-   *        - self: Pekare till objektet som ska nollstllas.
-   ********************************************************************************/
-   void (*clear)(struct person* self);
-} person_vtable_t, *person_vtable_ptr_t;
-
-/********************************************************************************
-* person_init: Lagrar angiven persondata i ett person-objekt.
-* 
-*              - self      : Pekare till objektet som ska lagra uppgifterna.
-*              - name      : Personens namn.
-*              - age       : Personens lder.
-*              - address   : Personens hemadress.
-*              - occupation: Personens yrke.
-*              - gender    : Personens kn.
-********************************************************************************/
-void person_init(struct person* self, 
-                 const char* name,
-                 const unsigned int age,
-                 const char* address,
-                 const char* occupation,
-                 const enum gender gender);
-
-/********************************************************************************
-* person_clear: Nollstller persondata lagrat av angivet person-objekt.
-* 
-*               - self: Pekare till objektet som ska nollstllas.
-********************************************************************************/
-void person_clear(struct person* self);
-
-/********************************************************************************
-* person_new: Allokerar minne och lagrar angiven persondata i ett person-objekt.
-*             En pekare till det dynamiskt allokerade objektet returneras.
-*             Om minnesallokeringen misslyckas s returneras null.
-*
-*             - name      : Personens namn.
-*             - age       : Personens lder.
-*             - address   : Personens hemadress.
-*             - occupation: Personens yrke.
-*             - gender    : Personens kn.
-********************************************************************************/
-struct person* person_new(const char* name,
-                          const unsigned int age,
-                          const char* address,
-                          const char* occupation,
-                          const enum gender gender);
-
-/********************************************************************************
-* person_delete: Raderar angivet person-objekt genom att frigra dynamiskt 
-*                allokerat minne fr denna och stter motsvarande pekare till null. 
-*                Fr att mjliggra detta passeras adressen till den pekare som 
-*                pekar p det dynamiskt allokerade minnet.
-*
-*                - self: Adressen till den pekare som pekar p objektet som
-*                        som ska raderas.
-********************************************************************************/
-void person_delete(struct person** self);
-
-/********************************************************************************
-* person_print: Skriver ut lagrad persondata via angiven utstrm, dr 
-*               standardutenheten stdout anvnds som default fr utskrift
-*               i terminalen.
-*
-*               - self   : Pekare till objektet som lagrar persondatan.
-*               - ostream: Pekare till angiven utstrm (default = stdout).
-********************************************************************************/
-void person_print(const struct person* self,
-                  FILE* ostream);
-
-/********************************************************************************
-* person_gender_str: Returnerar personens kn p textform.
-*
-*                    - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-const char* person_gender_str(const struct person* self);
-
-/********************************************************************************
-* person_name: Returnerar personens namn.
-*
-*              - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-const char* person_name(const struct person* self);
-
-/********************************************************************************
-* person_age: Returnerar personens lder.
-*
-*             - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-unsigned int person_age(const struct person* self);
-
-/********************************************************************************
-* person_address: Returnerar personens hemadress.
-*
-*                 - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-const char* person_address(const struct person* self);
-
-/********************************************************************************
-* person_occupation: Returnerar personens yrke.
-*
-*                    - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-const char* person_occupation(const struct person* self);
-
-/********************************************************************************
-* person_gender: Returnerar personens kn som en enumerator av enumeration 
-*                gender, allts GENDER_MALE, GENDER_FEMALE, GENDER_OTHER eller
-*                GENDER_NONE.
-*
-*                - self: Pekare till objektet som lagrar persondatan.
-********************************************************************************/
-enum gender person_gender(const struct person* self);
-
+/********************************************************************************
+* person.h: Innehåller funktionalitet för lagring samt utskrift av persondata
+*           via strukten person samt associerade funktioner.
+********************************************************************************/
+#ifndef PERSON_H_
+#define PERSON_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdio.h>  /* Innehåller funktionalitet för utskrift och inmatning. */
+#include <stdlib.h> /* Innehåller funktionalitet för dynamisk minnesallokering. */
+#include <stdint.h> /* Innehåller heltalstyper med fast storlek. */
+
+/* Deklaration av allokatorgränssnittet, se person_alloc.h: */
+struct person_allocator;
+
+/********************************************************************************
+* gender: Enumeration för val av kön.
+********************************************************************************/
+typedef enum gender
+{
+   GENDER_MALE,   /* Man. */
+   GENDER_FEMALE, /* Kvinna. */
+   GENDER_OTHER,  /* Övrigt. */
+   GENDER_NONE    /* Ospecificerat. */
+} gender_t;
+
+/********************************************************************************
+* gender_str: Returnerar angivet kön på textform.
+*
+*             - gender: Könet som ska omvandlas till text.
+********************************************************************************/
+const char* gender_str(const enum gender gender);
+
+/********************************************************************************
+* gender_from_str: Returnerar det kön som motsvarar angiven text, dvs. den text
+*                  som returneras av gender_str. Okänd text ger GENDER_NONE.
+*
+*                  - s: Texten som ska omvandlas.
+********************************************************************************/
+enum gender gender_from_str(const char* s);
+
+/********************************************************************************
+* person: Strukt för lagring samt utskrift av persondata.
+********************************************************************************/
+typedef struct person
+{
+   struct person_mem* mem;           /* Pekare till variabler innehållande persondata. */
+   const struct person_vtable* vptr; /* Pekare till vtable innehållande funktionspekare. */
+} person_t, *person_ptr_t;
+
+/********************************************************************************
+* person_vtable: Strukt för vtable (virtuell tabell) innehållande adresser till 
+*                associerade funktioner för strukten person.
+********************************************************************************/
+typedef struct person_vtable
+{
+   /********************************************************************************
+   * print: Skriver ut lagrad persondata via angiven utström, där standardutenheten
+   *        stdout används som default för utskrift i terminalen.
+   *
+   *        - self   : Pekare till objektet som lagrar persondatan.
+   *        - ostream: Pekare till angiven utström (default = stdout).
+   ********************************************************************************/
+   void (*print)(const struct person* self,
+                 FILE* ostream);
+
+   /********************************************************************************
+   * gender_str: Returnerar personens kön på textform.
+   *
+   *             - self: Pekare till objektet som lagrar persondatan.
+   ********************************************************************************/
+   const char* (*gender_str)(const struct person* self);
+
+   /********************************************************************************
+   * name: Returnerar personens namn.
+   *
+   *       - self: Pekare till objektet som lagrar persondatan.
+   ********************************************************************************/
+   const char* (*name)(const struct person* self);
+
+   /********************************************************************************
+   * age: Returnerar personens ålder.
+   *
+   *      - self: Pekare till objektet som lagrar persondatan.
+   ********************************************************************************/
+   unsigned int (*age)(const struct person* self);
+
+   /********************************************************************************
+   * address: Returnerar personens hemadress.
+   *
+   *          - self: Pekare till objektet som lagrar persondatan.
+   ********************************************************************************/
+   const char* (*address)(const struct person* self);
+
+   /********************************************************************************
+   * occupation: Returnerar personens yrke.
+   *
+   *             - self: Pekare till objektet som lagrar persondatan.
+   ********************************************************************************/
+   const char* (*occupation)(const struct person* self);
+
+   /********************************************************************************
+   * gender: Returnerar personens kön som en enumerator av enumerationen gender.
+   *
+   *         - self: Pekare till objektet som lagrar persondatan.
+   ********************************************************************************/
+   enum gender (*gender)(const struct person* self);
+
+   /********************************************************************************
+   * clear: Nollställer persondata lagrat av angivet person-objekt.
+   *
+   *        - self: Pekare till objektet som ska nollställas.
+   ********************************************************************************/
+   void (*clear)(struct person* self);
+} person_vtable_t, *person_vtable_ptr_t;
+
+/********************************************************************************
+* person_init: Lagrar angiven persondata i ett person-objekt.
+* 
+*              - self      : Pekare till objektet som ska lagra uppgifterna.
+*              - name      : Personens namn.
+*              - age       : Personens ålder.
+*              - address   : Personens hemadress.
+*              - occupation: Personens yrke.
+*              - gender    : Personens kön.
+********************************************************************************/
+void person_init(struct person* self, 
+                 const char* name,
+                 const unsigned int age,
+                 const char* address,
+                 const char* occupation,
+                 const enum gender gender);
+
+/********************************************************************************
+* person_init_with: Lagrar angiven persondata i ett person-objekt, där minnet
+*                   för persondatan allokeras via angiven allokator. Minnet
+*                   frigörs via samma allokator vid anrop av person_clear.
+*
+*                   - self      : Pekare till objektet som ska lagra uppgifterna.
+*                   - allocator : Allokatorn som ska användas (null = malloc).
+*                   - name      : Personens namn.
+*                   - age       : Personens ålder.
+*                   - address   : Personens hemadress.
+*                   - occupation: Personens yrke.
+*                   - gender    : Personens kön.
+********************************************************************************/
+void person_init_with(struct person* self,
+                      const struct person_allocator* allocator,
+                      const char* name,
+                      const unsigned int age,
+                      const char* address,
+                      const char* occupation,
+                      const enum gender gender);
+
+/********************************************************************************
+* person_clear: Nollställer persondata lagrat av angivet person-objekt. Objekt
+*               utan person_mem (exempelvis person_inline och vyer)
+*               nollställs via sin egen clear-funktion i vtabellen, så att
+*               exempelvis heapallokerade strängar i person_inline frigörs.
+* 
+*               - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_clear(struct person* self);
+
+/********************************************************************************
+* person_new: Allokerar minne och lagrar angiven persondata i ett person-objekt.
+*             En pekare till det dynamiskt allokerade objektet returneras.
+*             Om minnesallokeringen misslyckas så returneras null.
+*
+*             - name      : Personens namn.
+*             - age       : Personens ålder.
+*             - address   : Personens hemadress.
+*             - occupation: Personens yrke.
+*             - gender    : Personens kön.
+********************************************************************************/
+struct person* person_new(const char* name,
+                          const unsigned int age,
+                          const char* address,
+                          const char* occupation,
+                          const enum gender gender);
+
+/********************************************************************************
+* person_new_with: Allokerar minne via angiven allokator och lagrar angiven
+*                  persondata i ett person-objekt. En pekare till objektet
+*                  returneras. Om minnesallokeringen misslyckas så returneras
+*                  null. Objektet raderas via person_delete_with med samma
+*                  allokator.
+*
+*                  - allocator : Allokatorn som ska användas (null = malloc).
+*                  - name      : Personens namn.
+*                  - age       : Personens ålder.
+*                  - address   : Personens hemadress.
+*                  - occupation: Personens yrke.
+*                  - gender    : Personens kön.
+********************************************************************************/
+struct person* person_new_with(const struct person_allocator* allocator,
+                               const char* name,
+                               const unsigned int age,
+                               const char* address,
+                               const char* occupation,
+                               const enum gender gender);
+
+/********************************************************************************
+* person_delete: Raderar angivet person-objekt genom att frigöra dynamiskt 
+*                allokerat minne för denna (inklusive lagrad persondata) och
+*                sätter motsvarande pekare till null. 
+*                För att möjliggöra detta passeras adressen till den pekare som 
+*                pekar på det dynamiskt allokerade minnet.
+*
+*                - self: Adressen till den pekare som pekar på objektet som
+*                        som ska raderas.
+********************************************************************************/
+void person_delete(struct person** self);
+
+/********************************************************************************
+* person_delete_with: Raderar angivet person-objekt, som tidigare allokerats
+*                     via person_new_with, genom att frigöra dess minne via
+*                     angiven allokator och sätter motsvarande pekare till null.
+*
+*                     - allocator: Allokatorn som användes vid allokeringen
+*                                  (null = malloc).
+*                     - self     : Adressen till den pekare som pekar på
+*                                  objektet som ska raderas.
+********************************************************************************/
+void person_delete_with(const struct person_allocator* allocator,
+                        struct person** self);
+
+/********************************************************************************
+* person_block_size: Returnerar storleken på det största minnesblock som
+*                    allokeras per person-objekt via person_new_with, vilket
+*                    används som blockstorlek vid allokering via en person_slab.
+********************************************************************************/
+size_t person_block_size(void);
+
+/********************************************************************************
+* person_print: Skriver ut lagrad persondata via angiven utström, där 
+*               standardutenheten stdout används som default för utskrift
+*               i terminalen.
+*
+*               - self   : Pekare till objektet som lagrar persondatan.
+*               - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+void person_print(const struct person* self,
+                  FILE* ostream);
+
+/********************************************************************************
+* person_gender_str: Returnerar personens kön på textform.
+*
+*                    - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_gender_str(const struct person* self);
+
+/********************************************************************************
+* person_name: Returnerar personens namn.
+*
+*              - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_name(const struct person* self);
+
+/********************************************************************************
+* person_age: Returnerar personens ålder.
+*
+*             - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+unsigned int person_age(const struct person* self);
+
+/********************************************************************************
+* person_address: Returnerar personens hemadress.
+*
+*                 - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_address(const struct person* self);
+
+/********************************************************************************
+* person_occupation: Returnerar personens yrke.
+*
+*                    - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_occupation(const struct person* self);
+
+/********************************************************************************
+* person_gender: Returnerar personens kön som en enumerator av enumeration 
+*                gender, alltså GENDER_MALE, GENDER_FEMALE, GENDER_OTHER eller
+*                GENDER_NONE.
+*
+*                - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+enum gender person_gender(const struct person* self);
+
+/********************************************************************************
+* person_set_name: Ändrar personens namn och markerar objektet som ändrat.
+*                  Strängen kopieras inte, på samma sätt som vid person_init.
+*                  Enbart objekt med egen persondata, dvs. objekt som
+*                  initierats via person_init eller person_new, kan
+*                  ändras. För övriga objekt, exempelvis vyer och
+*                  person_inline-objekt, returneras 1 och objektet
+*                  lämnas oförändrat. Vid lyckad ändring returneras 0.
+*
+*                  - self: Pekare till objektet som lagrar persondatan.
+*                  - name: Personens nya namn.
+********************************************************************************/
+int person_set_name(struct person* self,
+                    const char* name);
+
+/********************************************************************************
+* person_set_age: Ändrar personens ålder och markerar objektet som ändrat.
+*                 Vid lyckad ändring returneras 0, annars returneras 1
+*                 (se person_set_name).
+*
+*                 - self: Pekare till objektet som lagrar persondatan.
+*                 - age : Personens nya ålder.
+********************************************************************************/
+int person_set_age(struct person* self,
+                   const unsigned int age);
+
+/********************************************************************************
+* person_set_address: Ändrar personens hemadress och markerar objektet som
+*                     ändrat. Strängen kopieras inte. Vid lyckad ändring
+*                     returneras 0, annars returneras 1 (se person_set_name).
+*
+*                     - self   : Pekare till objektet som lagrar persondatan.
+*                     - address: Personens nya hemadress.
+********************************************************************************/
+int person_set_address(struct person* self,
+                       const char* address);
+
+/********************************************************************************
+* person_set_occupation: Ändrar personens yrke och markerar objektet som
+*                        ändrat. Strängen kopieras inte. Vid lyckad ändring
+*                        returneras 0, annars returneras 1 (se
+*                        person_set_name).
+*
+*                        - self      : Pekare till objektet som lagrar persondatan.
+*                        - occupation: Personens nya yrke.
+********************************************************************************/
+int person_set_occupation(struct person* self,
+                          const char* occupation);
+
+/********************************************************************************
+* person_set_gender: Ändrar personens kön och markerar objektet som ändrat.
+*                    Vid lyckad ändring returneras 0, annars returneras 1
+*                    (se person_set_name).
+*
+*                    - self  : Pekare till objektet som lagrar persondatan.
+*                    - gender: Personens nya kön.
+********************************************************************************/
+int person_set_gender(struct person* self,
+                      const enum gender gender);
+
+/********************************************************************************
+* person_generation: Returnerar generationen för objektets senaste ändring,
+*                    dvs. den globala generationen när objektet
+*                    initierades via person_init eller senast
+*                    ändrades via någon av person_set-funktionerna. Objekt
+*                    utan egen persondata (exempelvis vyer och
+*                    person_inline-objekt) saknar spårning och betraktas
+*                    alltid som ändrade, varvid UINT64_MAX returneras.
+*
+*                    - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+uint64_t person_generation(const struct person* self);
+
+/********************************************************************************
+* person_generation_current: Returnerar den globala generationen och påbörjar
+*                            en ny. Objekt som initieras eller ändras stämplas
+*                            med aktuell generation utan att räknaren ändras,
+*                            medan räknaren enbart räknas upp via denna
+*                            funktion, exempelvis vid varje export. Samtliga
+*                            objekt som ändras efter anropet får därmed en
+*                            högre generation än det returnerade värdet.
+********************************************************************************/
+uint64_t person_generation_current(void);
+
 #endif /* PERSON_H_ */
\ No newline at end of file
@@ -0,0 +1,425 @@
+/********************************************************************************
+* person_alloc.c: Innehåller definitioner av standardallokatorn samt av
+*                 associerade funktioner tillhörande strukterna person_arena
+*                 och person_slab.
+********************************************************************************/
+#include "person_alloc.h"
+#include <stdlib.h>
+
+/* Justering som samtliga returnerade minnesblock uppfyller. */
+#define PERSON_ALLOC_ALIGNMENT _Alignof(max_align_t)
+
+/********************************************************************************
+* person_arena_block: Minnesblock tillhörande en arena. Datan lagras direkt
+*                     efter blockets huvud.
+********************************************************************************/
+struct person_arena_block
+{
+   struct person_arena_block* next; /* Pekare till nästa block. */
+   size_t size;                     /* Antal använda bytes i blocket. */
+   size_t capacity;                 /* Blockets kapacitet i bytes. */
+   max_align_t data[];              /* Blockets data. */
+};
+
+/********************************************************************************
+* person_slab_page: Slab tillhörande en slab-pool. Blocken lagras direkt
+*                   efter slabens huvud.
+********************************************************************************/
+struct person_slab_page
+{
+   struct person_slab_page* next; /* Pekare till nästa slab. */
+   max_align_t data[];            /* Slabens block. */
+};
+
+/* Statiska funktioner: */
+static size_t person_alloc_align(const size_t size);
+static struct person_arena_block* person_arena_block_new(const size_t capacity);
+static void person_slab_page_link(struct person_slab* self,
+                                  struct person_slab_page* page);
+static void* person_default_alloc(void* context, const size_t size);
+static void person_default_free(void* context, void* block, const size_t size);
+static void* person_arena_alloc_callback(void* context, const size_t size);
+static void person_arena_free_callback(void* context, void* block, const size_t size);
+static void* person_slab_alloc_callback(void* context, const size_t size);
+static void person_slab_free_callback(void* context, void* block, const size_t size);
+
+/********************************************************************************
+* person_allocator_default: Returnerar en pekare till standardallokatorn,
+*                           som använder malloc samt free.
+********************************************************************************/
+const struct person_allocator* person_allocator_default(void)
+{
+   static const struct person_allocator self =
+   {
+      .alloc = &person_default_alloc,
+      .free = &person_default_free,
+      .context = 0
+   };
+
+   return &self;
+}
+
+/********************************************************************************
+* person_arena_init: Initierar en ny tom arena.
+*
+*                    - self      : Pekare till arenan som ska initieras.
+*                    - block_size: Storlek på varje minnesblock i bytes
+*                                  (0 = standardstorlek på 64 kB).
+********************************************************************************/
+void person_arena_init(struct person_arena* self,
+                       const size_t block_size)
+{
+   self->first = 0;
+   self->current = 0;
+   self->block_size = block_size ? person_alloc_align(block_size) : 64 * 1024;
+   self->allocator.alloc = &person_arena_alloc_callback;
+   self->allocator.free = &person_arena_free_callback;
+   self->allocator.context = self;
+   return;
+}
+
+/********************************************************************************
+* person_arena_clear: Frigör samtliga minnesblock allokerade av arenan.
+*
+*                     - self: Pekare till arenan som ska nollställas.
+********************************************************************************/
+void person_arena_clear(struct person_arena* self)
+{
+   struct person_arena_block* block = self->first;
+
+   while (block)
+   {
+      struct person_arena_block* next = block->next;
+      free(block);
+      block = next;
+   }
+
+   self->first = 0;
+   self->current = 0;
+   return;
+}
+
+/********************************************************************************
+* person_arena_alloc: Allokerar ett minnesblock av angiven storlek från arenan
+*                     och returnerar en pekare till detta. Om allokeringen
+*                     misslyckas så returneras null.
+*
+*                     - self: Pekare till aktuell arena.
+*                     - size: Minnesblockets storlek i bytes.
+********************************************************************************/
+void* person_arena_alloc(struct person_arena* self,
+                         const size_t size)
+{
+   const size_t aligned_size = person_alloc_align(size ? size : 1);
+   struct person_arena_block* block = self->current;
+
+   while (block && block->size + aligned_size > block->capacity)
+   {
+      block = block->next;
+   }
+
+   if (!block)
+   {
+      const size_t capacity = aligned_size > self->block_size ? aligned_size : self->block_size;
+      block = person_arena_block_new(capacity);
+      if (!block) return 0;
+
+      if (self->current)
+      {
+         block->next = self->current->next;
+         self->current->next = block;
+      }
+      else
+      {
+         self->first = block;
+      }
+   }
+
+   if (aligned_size <= self->block_size) self->current = block;
+   void* data = (char*)block->data + block->size;
+   block->size += aligned_size;
+   return data;
+}
+
+/********************************************************************************
+* person_arena_reset: Frigör samtliga objekt allokerade från arenan på en gång.
+*                     Minnesblocken behålls och återanvänds vid kommande
+*                     allokeringar. Objekt allokerade från arenan får inte
+*                     användas efter anropet.
+*
+*                     - self: Pekare till aktuell arena.
+********************************************************************************/
+void person_arena_reset(struct person_arena* self)
+{
+   for (struct person_arena_block* block = self->first; block; block = block->next)
+   {
+      block->size = 0;
+   }
+
+   self->current = self->first;
+   return;
+}
+
+/********************************************************************************
+* person_arena_allocator: Returnerar en pekare till arenans allokatorgränssnitt.
+*
+*                         - self: Pekare till aktuell arena.
+********************************************************************************/
+const struct person_allocator* person_arena_allocator(struct person_arena* self)
+{
+   return &self->allocator;
+}
+
+/********************************************************************************
+* person_slab_init: Initierar en ny tom slab-pool.
+*
+*                   - self            : Pekare till poolen som ska initieras.
+*                   - object_size     : Storlek på varje block i bytes, exempelvis
+*                                       person_block_size() för person-objekt.
+*                   - objects_per_page: Antal block per slab (0 = 1024).
+********************************************************************************/
+void person_slab_init(struct person_slab* self,
+                      const size_t object_size,
+                      const size_t objects_per_page)
+{
+   self->pages = 0;
+   self->free_list = 0;
+   self->object_size = person_alloc_align(object_size > sizeof(void*) ? object_size : sizeof(void*));
+   self->objects_per_page = objects_per_page ? objects_per_page : 1024;
+   self->allocator.alloc = &person_slab_alloc_callback;
+   self->allocator.free = &person_slab_free_callback;
+   self->allocator.context = self;
+   return;
+}
+
+/********************************************************************************
+* person_slab_clear: Frigör samtliga slabs allokerade av poolen.
+*
+*                    - self: Pekare till poolen som ska nollställas.
+********************************************************************************/
+void person_slab_clear(struct person_slab* self)
+{
+   struct person_slab_page* page = self->pages;
+
+   while (page)
+   {
+      struct person_slab_page* next = page->next;
+      free(page);
+      page = next;
+   }
+
+   self->pages = 0;
+   self->free_list = 0;
+   return;
+}
+
+/********************************************************************************
+* person_slab_alloc: Hämtar ett ledigt block från poolen och returnerar en
+*                    pekare till detta. Om en ny slab behövs men inte kan
+*                    allokeras så returneras null.
+*
+*                    - self: Pekare till aktuell pool.
+********************************************************************************/
+void* person_slab_alloc(struct person_slab* self)
+{
+   if (!self->free_list)
+   {
+      struct person_slab_page* page = (struct person_slab_page*)malloc(
+         sizeof(struct person_slab_page) + self->object_size * self->objects_per_page);
+      if (!page) return 0;
+      page->next = self->pages;
+      self->pages = page;
+      person_slab_page_link(self, page);
+   }
+
+   void* block = self->free_list;
+   self->free_list = *(void**)block;
+   return block;
+}
+
+/********************************************************************************
+* person_slab_free: Lämnar tillbaka angivet block till poolen.
+*
+*                   - self : Pekare till aktuell pool.
+*                   - block: Pekare till blocket som ska lämnas tillbaka.
+********************************************************************************/
+void person_slab_free(struct person_slab* self,
+                      void* block)
+{
+   if (!block) return;
+   *(void**)block = self->free_list;
+   self->free_list = block;
+   return;
+}
+
+/********************************************************************************
+* person_slab_reset: Lämnar tillbaka samtliga block till poolen på en gång.
+*                    Objekt allokerade från poolen får inte användas efter
+*                    anropet.
+*
+*                    - self: Pekare till aktuell pool.
+********************************************************************************/
+void person_slab_reset(struct person_slab* self)
+{
+   self->free_list = 0;
+
+   for (struct person_slab_page* page = self->pages; page; page = page->next)
+   {
+      person_slab_page_link(self, page);
+   }
+   return;
+}
+
+/********************************************************************************
+* person_slab_allocator: Returnerar en pekare till poolens allokatorgränssnitt.
+*                        Allokeringar större än poolens blockstorlek misslyckas.
+*
+*                        - self: Pekare till aktuell pool.
+********************************************************************************/
+const struct person_allocator* person_slab_allocator(struct person_slab* self)
+{
+   return &self->allocator;
+}
+
+/********************************************************************************
+* person_alloc_align: Avrundar angiven storlek uppåt till närmaste multipel av
+*                     PERSON_ALLOC_ALIGNMENT.
+*
+*                     - size: Storleken som ska avrundas.
+********************************************************************************/
+static size_t person_alloc_align(const size_t size)
+{
+   return (size + PERSON_ALLOC_ALIGNMENT - 1) & ~(size_t)(PERSON_ALLOC_ALIGNMENT - 1);
+}
+
+/********************************************************************************
+* person_arena_block_new: Allokerar ett nytt tomt minnesblock med angiven
+*                         kapacitet. Om allokeringen misslyckas returneras null.
+*
+*                         - capacity: Blockets kapacitet i bytes.
+********************************************************************************/
+static struct person_arena_block* person_arena_block_new(const size_t capacity)
+{
+   struct person_arena_block* self = (struct person_arena_block*)malloc(
+      sizeof(struct person_arena_block) + capacity);
+   if (!self) return 0;
+   self->next = 0;
+   self->size = 0;
+   self->capacity = capacity;
+   return self;
+}
+
+/********************************************************************************
+* person_slab_page_link: Lägger till samtliga block i angiven slab i poolens
+*                        fri-lista.
+*
+*                        - self: Pekare till aktuell pool.
+*                        - page: Pekare till slaben vars block ska läggas till.
+********************************************************************************/
+static void person_slab_page_link(struct person_slab* self,
+                                  struct person_slab_page* page)
+{
+   char* data = (char*)page->data;
+
+   for (size_t i = self->objects_per_page; i > 0; --i)
+   {
+      void* block = data + (i - 1) * self->object_size;
+      *(void**)block = self->free_list;
+      self->free_list = block;
+   }
+   return;
+}
+
+/********************************************************************************
+* person_default_alloc: Allokerar minne via malloc.
+*
+*                       - context: Används ej.
+*                       - size   : Minnesblockets storlek i bytes.
+********************************************************************************/
+static void* person_default_alloc(void* context,
+                                  const size_t size)
+{
+   (void)context;
+   return malloc(size);
+}
+
+/********************************************************************************
+* person_default_free: Frigör minne via free.
+*
+*                      - context: Används ej.
+*                      - block  : Pekare till minnesblocket som ska frigöras.
+*                      - size   : Används ej.
+********************************************************************************/
+static void person_default_free(void* context,
+                                void* block,
+                                const size_t size)
+{
+   (void)context;
+   (void)size;
+   free(block);
+   return;
+}
+
+/********************************************************************************
+* person_arena_alloc_callback: Allokerar minne från arenan som passeras som
+*                              kontext.
+*
+*                              - context: Pekare till aktuell arena.
+*                              - size   : Minnesblockets storlek i bytes.
+********************************************************************************/
+static void* person_arena_alloc_callback(void* context,
+                                         const size_t size)
+{
+   return person_arena_alloc((struct person_arena*)context, size);
+}
+
+/********************************************************************************
+* person_arena_free_callback: Enskilda objekt frigörs inte i en arena, utan
+*                             minnet återanvänds via person_arena_reset.
+*
+*                             - context: Används ej.
+*                             - block  : Används ej.
+*                             - size   : Används ej.
+********************************************************************************/
+static void person_arena_free_callback(void* context,
+                                       void* block,
+                                       const size_t size)
+{
+   (void)context;
+   (void)block;
+   (void)size;
+   return;
+}
+
+/********************************************************************************
+* person_slab_alloc_callback: Hämtar ett block från poolen som passeras som
+*                             kontext. Om angiven storlek överstiger poolens
+*                             blockstorlek så returneras null.
+*
+*                             - context: Pekare till aktuell pool.
+*                             - size   : Minnesblockets storlek i bytes.
+********************************************************************************/
+static void* person_slab_alloc_callback(void* context,
+                                        const size_t size)
+{
+   struct person_slab* self = (struct person_slab*)context;
+   if (size > self->object_size) return 0;
+   return person_slab_alloc(self);
+}
+
+/********************************************************************************
+* person_slab_free_callback: Lämnar tillbaka ett block till poolen som passeras
+*                            som kontext.
+*
+*                            - context: Pekare till aktuell pool.
+*                            - block  : Pekare till blocket som ska lämnas tillbaka.
+*                            - size   : Används ej.
+********************************************************************************/
+static void person_slab_free_callback(void* context,
+                                      void* block,
+                                      const size_t size)
+{
+   (void)size;
+   person_slab_free((struct person_slab*)context, block);
+   return;
+}
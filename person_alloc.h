@@ -0,0 +1,177 @@
+/********************************************************************************
+* person_alloc.h: Innehåller ett utbytbart allokeringsgränssnitt för person-
+*                 objekt via strukten person_allocator, samt två färdiga
+*                 allokatorer: en bump-arena (person_arena), där samtliga
+*                 objekt frigörs på en gång via person_arena_reset, samt en
+*                 slab-pool (person_slab) för block av fast storlek.
+********************************************************************************/
+#ifndef PERSON_ALLOC_H_
+#define PERSON_ALLOC_H_
+
+/* Inkluderingsdirektiv: */
+#include <stddef.h> /* Innehåller typen size_t. */
+
+/********************************************************************************
+* person_allocator: Strukt innehållande funktionspekare för allokering samt
+*                   frigörande av minne, samt en kontextpekare som passeras
+*                   vid varje anrop (exempelvis en pekare till en arena).
+********************************************************************************/
+typedef struct person_allocator
+{
+   /********************************************************************************
+   * alloc: Allokerar ett minnesblock av angiven storlek och returnerar en pekare
+   *        till detta. Om allokeringen misslyckas så returneras null.
+   *
+   *        - context: Allokatorns kontext.
+   *        - size   : Minnesblockets storlek i bytes.
+   ********************************************************************************/
+   void* (*alloc)(void* context,
+                  const size_t size);
+
+   /********************************************************************************
+   * free: Frigör ett minnesblock som tidigare allokerats via alloc.
+   *
+   *       - context: Allokatorns kontext.
+   *       - block  : Pekare till minnesblocket som ska frigöras.
+   *       - size   : Minnesblockets storlek i bytes.
+   ********************************************************************************/
+   void (*free)(void* context,
+                void* block,
+                const size_t size);
+
+   void* context; /* Kontext som passeras vid varje anrop. */
+} person_allocator_t, *person_allocator_ptr_t;
+
+/********************************************************************************
+* person_arena: Bump-allokator där minne hämtas från stora block genom att
+*               en offset räknas upp. Enskilda objekt frigörs aldrig, utan
+*               allt minne återanvänds på en gång via person_arena_reset.
+********************************************************************************/
+typedef struct person_arena
+{
+   struct person_arena_block* first;   /* Pekare till första minnesblocket. */
+   struct person_arena_block* current; /* Pekare till aktuellt minnesblock. */
+   size_t block_size;                  /* Standardstorlek för nya block. */
+   struct person_allocator allocator;  /* Allokatorgränssnitt för arenan. */
+} person_arena_t, *person_arena_ptr_t;
+
+/********************************************************************************
+* person_slab: Pool för minnesblock av fast storlek. Blocken hämtas från
+*              större slabs och frigjorda block återanvänds via en fri-lista,
+*              vilket gör både allokering och frigörande till O(1).
+********************************************************************************/
+typedef struct person_slab
+{
+   struct person_slab_page* pages;    /* Pekare till allokerade slabs. */
+   void* free_list;                   /* Pekare till första lediga block. */
+   size_t object_size;                /* Storlek på varje block i bytes. */
+   size_t objects_per_page;           /* Antal block per slab. */
+   struct person_allocator allocator; /* Allokatorgränssnitt för poolen. */
+} person_slab_t, *person_slab_ptr_t;
+
+/********************************************************************************
+* person_allocator_default: Returnerar en pekare till standardallokatorn,
+*                           som använder malloc samt free.
+********************************************************************************/
+const struct person_allocator* person_allocator_default(void);
+
+/********************************************************************************
+* person_arena_init: Initierar en ny tom arena.
+*
+*                    - self      : Pekare till arenan som ska initieras.
+*                    - block_size: Storlek på varje minnesblock i bytes
+*                                  (0 = standardstorlek på 64 kB).
+********************************************************************************/
+void person_arena_init(struct person_arena* self,
+                       const size_t block_size);
+
+/********************************************************************************
+* person_arena_clear: Frigör samtliga minnesblock allokerade av arenan.
+*
+*                     - self: Pekare till arenan som ska nollställas.
+********************************************************************************/
+void person_arena_clear(struct person_arena* self);
+
+/********************************************************************************
+* person_arena_alloc: Allokerar ett minnesblock av angiven storlek från arenan
+*                     och returnerar en pekare till detta. Om allokeringen
+*                     misslyckas så returneras null.
+*
+*                     - self: Pekare till aktuell arena.
+*                     - size: Minnesblockets storlek i bytes.
+********************************************************************************/
+void* person_arena_alloc(struct person_arena* self,
+                         const size_t size);
+
+/********************************************************************************
+* person_arena_reset: Frigör samtliga objekt allokerade från arenan på en gång.
+*                     Minnesblocken behålls och återanvänds vid kommande
+*                     allokeringar. Objekt allokerade från arenan får inte
+*                     användas efter anropet.
+*
+*                     - self: Pekare till aktuell arena.
+********************************************************************************/
+void person_arena_reset(struct person_arena* self);
+
+/********************************************************************************
+* person_arena_allocator: Returnerar en pekare till arenans allokatorgränssnitt.
+*
+*                         - self: Pekare till aktuell arena.
+********************************************************************************/
+const struct person_allocator* person_arena_allocator(struct person_arena* self);
+
+/********************************************************************************
+* person_slab_init: Initierar en ny tom slab-pool.
+*
+*                   - self            : Pekare till poolen som ska initieras.
+*                   - object_size     : Storlek på varje block i bytes, exempelvis
+*                                       person_block_size() för person-objekt.
+*                   - objects_per_page: Antal block per slab (0 = 1024).
+********************************************************************************/
+void person_slab_init(struct person_slab* self,
+                      const size_t object_size,
+                      const size_t objects_per_page);
+
+/********************************************************************************
+* person_slab_clear: Frigör samtliga slabs allokerade av poolen.
+*
+*                    - self: Pekare till poolen som ska nollställas.
+********************************************************************************/
+void person_slab_clear(struct person_slab* self);
+
+/********************************************************************************
+* person_slab_alloc: Hämtar ett ledigt block från poolen och returnerar en
+*                    pekare till detta. Om en ny slab behövs men inte kan
+*                    allokeras så returneras null.
+*
+*                    - self: Pekare till aktuell pool.
+********************************************************************************/
+void* person_slab_alloc(struct person_slab* self);
+
+/********************************************************************************
+* person_slab_free: Lämnar tillbaka angivet block till poolen.
+*
+*                   - self : Pekare till aktuell pool.
+*                   - block: Pekare till blocket som ska lämnas tillbaka.
+********************************************************************************/
+void person_slab_free(struct person_slab* self,
+                      void* block);
+
+/********************************************************************************
+* person_slab_reset: Lämnar tillbaka samtliga block till poolen på en gång.
+*                    Objekt allokerade från poolen får inte användas efter
+*                    anropet.
+*
+*                    - self: Pekare till aktuell pool.
+********************************************************************************/
+void person_slab_reset(struct person_slab* self);
+
+/********************************************************************************
+* person_slab_allocator: Returnerar en pekare till poolens allokatorgränssnitt.
+*                        Allokeringar större än poolens blockstorlek misslyckas.
+*
+*                        - self: Pekare till aktuell pool.
+********************************************************************************/
+const struct person_allocator* person_slab_allocator(struct person_slab* self);
+
+#endif /* PERSON_ALLOC_H_ */
@@ -0,0 +1,533 @@
+/********************************************************************************
+* person_async.c: Innehåller definitioner av associerade funktioner
+*                 tillhörande strukten person_async, som används för asynkron
+*                 utskrift av persondata via en bakgrundstråd.
+*
+*                 Kön är en begränsad ringbuffert där varje plats har ett
+*                 sekvensnummer. Skrivande trådar reserverar en position via
+*                 compare-and-swap och publicerar posten genom att räkna upp
+*                 platsens sekvensnummer, medan bakgrundstråden ensam läser
+*                 posterna och lämnar tillbaka platserna i samma ordning.
+********************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "person_async.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Antal bytes per plats som rymmer postens strängar utan allokering. */
+#define PERSON_ASYNC_INLINE 208
+
+/* Högsta antal poster som skrivs mellan varje fflush. */
+#define PERSON_ASYNC_BATCH 1024
+
+/********************************************************************************
+* person_async_slot: Plats i kön innehållande en kopia av ett person-objekt.
+*                    Strängarna lagras i platsen om de ryms, annars i ett
+*                    dynamiskt allokerat block som frigörs av bakgrundstråden.
+********************************************************************************/
+struct person_async_slot
+{
+   atomic_size_t sequence;            /* Platsens sekvensnummer. */
+   unsigned int age;                  /* Personens ålder. */
+   enum gender gender;                /* Personens kön. */
+   const char* name;                  /* Personens namn. */
+   const char* address;               /* Personens hemadress. */
+   const char* occupation;            /* Personens yrke. */
+   char* heap;                        /* Dynamiskt allokerade strängar (eller null). */
+   char strings[PERSON_ASYNC_INLINE]; /* Strängar som ryms i platsen. */
+};
+
+/********************************************************************************
+* person_async_view: Vy över en plats i kön, som kan användas som ett
+*                    person-objekt vid formatering.
+********************************************************************************/
+struct person_async_view
+{
+   struct person base;                   /* Basobjekt, måste ligga först. */
+   const struct person_async_slot* slot; /* Pekare till platsen. */
+};
+
+/* Statiska funktioner: */
+static int person_async_push(struct person_async* self,
+                             const struct person* person,
+                             const int blocking);
+static int person_async_full(struct person_async* self);
+static void person_async_wake(struct person_async* self);
+static void* person_async_main(void* arg);
+static size_t person_async_drain(struct person_async* self);
+static const struct person_vtable* person_async_vtable_ptr_new(void);
+static const char* person_async_view_name(const struct person* self);
+static unsigned int person_async_view_age(const struct person* self);
+static const char* person_async_view_address(const struct person* self);
+static const char* person_async_view_occupation(const struct person* self);
+static enum gender person_async_view_gender(const struct person* self);
+static const char* person_async_view_gender_str(const struct person* self);
+static void person_async_view_clear(struct person* self);
+
+/********************************************************************************
+* person_async_init: Initierar en ny person_async och startar bakgrundstråden.
+*                    Vid lyckad initiering returneras 0, annars returneras 1,
+*                    exempelvis om angiven kapacitet är för stor.
+*
+*                    - self    : Pekare till objektet som ska initieras.
+*                    - ostream : Utström som posterna skrivs till (default = stdout).
+*                    - capacity: Köns kapacitet i antal poster (0 = 4096).
+********************************************************************************/
+int person_async_init(struct person_async* self,
+                      FILE* ostream,
+                      const size_t capacity)
+{
+   size_t slot_count = 2;
+   if (capacity > SIZE_MAX / 2 / sizeof(struct person_async_slot)) return 1;
+   while (slot_count < (capacity ? capacity : 4096)) slot_count *= 2;
+
+   self->slots = (struct person_async_slot*)malloc(slot_count * sizeof(struct person_async_slot));
+   if (!self->slots) return 1;
+
+   if (person_writer_init(&self->writer, ostream, 0))
+   {
+      free(self->slots);
+      return 1;
+   }
+
+   for (size_t i = 0; i < slot_count; ++i)
+   {
+      atomic_init(&self->slots[i].sequence, i);
+      self->slots[i].heap = 0;
+   }
+
+   self->mask = slot_count - 1;
+   self->head = 0;
+   atomic_init(&self->tail, 0);
+   atomic_init(&self->written, 0);
+   atomic_init(&self->dropped, 0);
+   atomic_init(&self->sleeping, 0);
+   atomic_init(&self->stop, 0);
+   atomic_init(&self->error, 0);
+
+   if (pthread_mutex_init(&self->mutex, 0))
+   {
+      person_writer_clear(&self->writer);
+      free(self->slots);
+      return 1;
+   }
+
+   if (pthread_cond_init(&self->wake, 0))
+   {
+      pthread_mutex_destroy(&self->mutex);
+      person_writer_clear(&self->writer);
+      free(self->slots);
+      return 1;
+   }
+
+   if (pthread_cond_init(&self->progress, 0))
+   {
+      pthread_cond_destroy(&self->wake);
+      pthread_mutex_destroy(&self->mutex);
+      person_writer_clear(&self->writer);
+      free(self->slots);
+      return 1;
+   }
+
+   if (pthread_create(&self->thread, 0, &person_async_main, self))
+   {
+      pthread_cond_destroy(&self->progress);
+      pthread_cond_destroy(&self->wake);
+      pthread_mutex_destroy(&self->mutex);
+      person_writer_clear(&self->writer);
+      free(self->slots);
+      return 1;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_async_clear: Skriver samtliga köade poster, avslutar bakgrundstråden
+*                     och frigör allokerat minne. Utströmmen stängs inte. Inga
+*                     poster får köas under eller efter anropet.
+*
+*                     - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_async_clear(struct person_async* self)
+{
+   pthread_mutex_lock(&self->mutex);
+   atomic_store(&self->stop, 1);
+   pthread_cond_signal(&self->wake);
+   pthread_mutex_unlock(&self->mutex);
+   pthread_join(self->thread, 0);
+
+   pthread_cond_destroy(&self->progress);
+   pthread_cond_destroy(&self->wake);
+   pthread_mutex_destroy(&self->mutex);
+   person_writer_clear(&self->writer);
+   free(self->slots);
+   self->slots = 0;
+   self->mask = 0;
+   return;
+}
+
+/********************************************************************************
+* person_async_put: Köar en kopia av angivet person-objekt för utskrift. Om
+*                   kön är full väntar anropet tills plats finns. Objektet
+*                   kan ändras eller raderas direkt efter anropet. Vid lyckad
+*                   köning returneras 0, annars returneras 1.
+*
+*                   - self  : Pekare till aktuell person_async.
+*                   - person: Pekare till objektet som ska skrivas ut.
+********************************************************************************/
+int person_async_put(struct person_async* self,
+                     const struct person* person)
+{
+   return person_async_push(self, person, 1);
+}
+
+/********************************************************************************
+* person_async_try_put: Köar en kopia av angivet person-objekt för utskrift
+*                       utan att vänta. Om kön är full returneras 1 och posten
+*                       räknas som bortkastad, annars returneras 0.
+*
+*                       - self  : Pekare till aktuell person_async.
+*                       - person: Pekare till objektet som ska skrivas ut.
+********************************************************************************/
+int person_async_try_put(struct person_async* self,
+                         const struct person* person)
+{
+   return person_async_push(self, person, 0);
+}
+
+/********************************************************************************
+* person_async_flush: Väntar tills samtliga poster som köats före anropet har
+*                     skrivits och utströmmen har tömts via fflush. Om någon
+*                     skrivning har misslyckats returneras 1, annars 0.
+*
+*                     - self: Pekare till aktuell person_async.
+********************************************************************************/
+int person_async_flush(struct person_async* self)
+{
+   const size_t target = atomic_load(&self->tail);
+   pthread_mutex_lock(&self->mutex);
+
+   while (atomic_load(&self->written) < target)
+   {
+      pthread_cond_signal(&self->wake);
+      pthread_cond_wait(&self->progress, &self->mutex);
+   }
+
+   pthread_mutex_unlock(&self->mutex);
+   return atomic_load(&self->error);
+}
+
+/********************************************************************************
+* person_async_pending: Returnerar antalet köade poster som ännu inte har
+*                       skrivits till utströmmen.
+*
+*                       - self: Pekare till aktuell person_async.
+********************************************************************************/
+size_t person_async_pending(const struct person_async* self)
+{
+   const size_t written = atomic_load(&self->written);
+   return atomic_load(&self->tail) - written;
+}
+
+/********************************************************************************
+* person_async_dropped: Returnerar antalet poster som kastats av
+*                       person_async_try_put på grund av full kö.
+*
+*                       - self: Pekare till aktuell person_async.
+********************************************************************************/
+size_t person_async_dropped(const struct person_async* self)
+{
+   return atomic_load(&self->dropped);
+}
+
+/********************************************************************************
+* person_async_push: Kopierar angivet person-objekt till nästa lediga plats i
+*                    kön. Strängar som inte ryms i platsen kopieras till ett
+*                    dynamiskt allokerat block innan en position reserveras.
+*                    Vid lyckad köning returneras 0, annars returneras 1.
+*
+*                    - self    : Pekare till aktuell person_async.
+*                    - person  : Pekare till objektet som ska köas.
+*                    - blocking: Indikerar att anropet ska vänta om kön är full.
+********************************************************************************/
+static int person_async_push(struct person_async* self,
+                             const struct person* person,
+                             const int blocking)
+{
+   const char* name = person->vptr->name(person);
+   const char* address = person->vptr->address(person);
+   const char* occupation = person->vptr->occupation(person);
+   const size_t name_size = strlen(name) + 1;
+   const size_t address_size = strlen(address) + 1;
+   const size_t occupation_size = strlen(occupation) + 1;
+   const size_t size = name_size + address_size + occupation_size;
+   char* heap = 0;
+
+   if (size > PERSON_ASYNC_INLINE)
+   {
+      heap = (char*)malloc(size);
+      if (!heap) return 1;
+   }
+
+   struct person_async_slot* slot;
+   size_t position = atomic_load_explicit(&self->tail, memory_order_relaxed);
+
+   for (;;)
+   {
+      slot = self->slots + (position & self->mask);
+      const size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+      if (sequence == position)
+      {
+         if (atomic_compare_exchange_weak_explicit(&self->tail, &position, position + 1,
+                                                   memory_order_relaxed, memory_order_relaxed)) break;
+      }
+      else if ((ptrdiff_t)(sequence - position) < 0)
+      {
+         if (!blocking)
+         {
+            atomic_fetch_add(&self->dropped, 1);
+            free(heap);
+            return 1;
+         }
+
+         /* Mottryck: vänta tills bakgrundstråden har skrivit en omgång poster. */
+         pthread_mutex_lock(&self->mutex);
+         if (person_async_full(self))
+         {
+            pthread_cond_signal(&self->wake);
+            pthread_cond_wait(&self->progress, &self->mutex);
+         }
+         pthread_mutex_unlock(&self->mutex);
+         position = atomic_load_explicit(&self->tail, memory_order_relaxed);
+      }
+      else
+      {
+         position = atomic_load_explicit(&self->tail, memory_order_relaxed);
+      }
+   }
+
+   char* s = heap ? heap : slot->strings;
+   memcpy(s, name, name_size);
+   memcpy(s + name_size, address, address_size);
+   memcpy(s + name_size + address_size, occupation, occupation_size);
+
+   slot->age = person->vptr->age(person);
+   slot->gender = person->vptr->gender(person);
+   slot->name = s;
+   slot->address = s + name_size;
+   slot->occupation = s + name_size + address_size;
+   slot->heap = heap;
+
+   atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+   person_async_wake(self);
+   return 0;
+}
+
+/********************************************************************************
+* person_async_full: Returnerar 1 om kön är full, annars 0.
+*
+*                    - self: Pekare till aktuell person_async.
+********************************************************************************/
+static int person_async_full(struct person_async* self)
+{
+   const size_t position = atomic_load(&self->tail);
+   const struct person_async_slot* slot = self->slots + (position & self->mask);
+   return (ptrdiff_t)(atomic_load(&slot->sequence) - position) < 0;
+}
+
+/********************************************************************************
+* person_async_wake: Väcker bakgrundstråden om den väntar på poster. Mutexen
+*                    tas enbart när tråden faktiskt väntar, så att köning i
+*                    normalfallet sker utan lås.
+*
+*                    - self: Pekare till aktuell person_async.
+********************************************************************************/
+static void person_async_wake(struct person_async* self)
+{
+   atomic_thread_fence(memory_order_seq_cst);
+   if (!atomic_load_explicit(&self->sleeping, memory_order_relaxed)) return;
+
+   pthread_mutex_lock(&self->mutex);
+   pthread_cond_signal(&self->wake);
+   pthread_mutex_unlock(&self->mutex);
+   return;
+}
+
+/********************************************************************************
+* person_async_main: Bakgrundstrådens huvudloop. Köade poster skrivs i omgångar
+*                    om högst PERSON_ASYNC_BATCH poster, varefter utströmmen
+*                    töms och väntande trådar signaleras. När kön är tom
+*                    väntar tråden tills nya poster köas. Vid avslut skrivs
+*                    samtliga kvarvarande poster innan tråden avslutas.
+*
+*                    - arg: Pekare till aktuell person_async.
+********************************************************************************/
+static void* person_async_main(void* arg)
+{
+   struct person_async* self = (struct person_async*)arg;
+
+   for (;;)
+   {
+      if (person_async_drain(self)) continue;
+
+      pthread_mutex_lock(&self->mutex);
+      atomic_store(&self->sleeping, 1);
+      atomic_thread_fence(memory_order_seq_cst);
+
+      const struct person_async_slot* slot = self->slots + (self->head & self->mask);
+      const int empty = atomic_load_explicit(&slot->sequence, memory_order_acquire) != self->head + 1;
+
+      if (empty && atomic_load(&self->stop))
+      {
+         pthread_mutex_unlock(&self->mutex);
+         break;
+      }
+
+      if (empty) pthread_cond_wait(&self->wake, &self->mutex);
+      atomic_store(&self->sleeping, 0);
+      pthread_mutex_unlock(&self->mutex);
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_async_drain: Skriver upp till PERSON_ASYNC_BATCH köade poster via
+*                     bakgrundstrådens buffert, tömmer utströmmen och
+*                     signalerar väntande trådar. Antalet skrivna poster
+*                     returneras.
+*
+*                     - self: Pekare till aktuell person_async.
+********************************************************************************/
+static size_t person_async_drain(struct person_async* self)
+{
+   struct person_async_view view;
+   size_t count = 0;
+
+   view.base.mem = 0;
+   view.base.vptr = person_async_vtable_ptr_new();
+
+   while (count < PERSON_ASYNC_BATCH)
+   {
+      struct person_async_slot* slot = self->slots + (self->head & self->mask);
+      if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != self->head + 1) break;
+
+      view.slot = slot;
+      if (person_writer_put(&self->writer, &view.base)) atomic_store(&self->error, 1);
+      free(slot->heap);
+      slot->heap = 0;
+
+      atomic_store_explicit(&slot->sequence, self->head + self->mask + 1, memory_order_release);
+      self->head++;
+      count++;
+   }
+
+   if (!count) return 0;
+   if (person_writer_flush(&self->writer) || fflush(self->writer.ostream))
+   {
+      atomic_store(&self->error, 1);
+   }
+
+   pthread_mutex_lock(&self->mutex);
+   atomic_store(&self->written, self->head);
+   pthread_cond_broadcast(&self->progress);
+   pthread_mutex_unlock(&self->mutex);
+   return count;
+}
+
+/********************************************************************************
+* person_async_vtable_ptr_new: Returnerar en pekare till ett statiskt vtable
+*                              för vyer över platser i kön.
+********************************************************************************/
+static const struct person_vtable* person_async_vtable_ptr_new(void)
+{
+   static const struct person_vtable self =
+   {
+      .print = &person_print,
+      .gender_str = &person_async_view_gender_str,
+      .name = &person_async_view_name,
+      .age = &person_async_view_age,
+      .address = &person_async_view_address,
+      .occupation = &person_async_view_occupation,
+      .gender = &person_async_view_gender,
+      .clear = &person_async_view_clear
+   };
+
+   return &self;
+}
+
+/********************************************************************************
+* person_async_view_name: Returnerar namnet lagrat i vyns plats.
+*
+*                         - self: Pekare till vyns basobjekt.
+********************************************************************************/
+static const char* person_async_view_name(const struct person* self)
+{
+   return ((const struct person_async_view*)self)->slot->name;
+}
+
+/********************************************************************************
+* person_async_view_age: Returnerar åldern lagrad i vyns plats.
+*
+*                        - self: Pekare till vyns basobjekt.
+********************************************************************************/
+static unsigned int person_async_view_age(const struct person* self)
+{
+   return ((const struct person_async_view*)self)->slot->age;
+}
+
+/********************************************************************************
+* person_async_view_address: Returnerar hemadressen lagrad i vyns plats.
+*
+*                            - self: Pekare till vyns basobjekt.
+********************************************************************************/
+static const char* person_async_view_address(const struct person* self)
+{
+   return ((const struct person_async_view*)self)->slot->address;
+}
+
+/********************************************************************************
+* person_async_view_occupation: Returnerar yrket lagrat i vyns plats.
+*
+*                               - self: Pekare till vyns basobjekt.
+********************************************************************************/
+static const char* person_async_view_occupation(const struct person* self)
+{
+   return ((const struct person_async_view*)self)->slot->occupation;
+}
+
+/********************************************************************************
+* person_async_view_gender: Returnerar könet lagrat i vyns plats.
+*
+*                           - self: Pekare till vyns basobjekt.
+********************************************************************************/
+static enum gender person_async_view_gender(const struct person* self)
+{
+   return ((const struct person_async_view*)self)->slot->gender;
+}
+
+/********************************************************************************
+* person_async_view_gender_str: Returnerar könet lagrat i vyns plats på
+*                               textform.
+*
+*                               - self: Pekare till vyns basobjekt.
+********************************************************************************/
+static const char* person_async_view_gender_str(const struct person* self)
+{
+   return gender_str(person_async_view_gender(self));
+}
+
+/********************************************************************************
+* person_async_view_clear: Nollställer vyn. Platsen påverkas inte.
+*
+*                          - self: Pekare till vyns basobjekt.
+********************************************************************************/
+static void person_async_view_clear(struct person* self)
+{
+   struct person_async_view* view = (struct person_async_view*)self;
+   view->base.vptr = 0;
+   view->slot = 0;
+   return;
+}
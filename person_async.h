@@ -0,0 +1,117 @@
+/********************************************************************************
+* person_async.h: Innehåller asynkron utskrift av persondata via strukten
+*                 person_async. Anroparen lägger en kopia av varje
+*                 person-objekt i en begränsad kö utan lås, varefter en
+*                 bakgrundstråd formaterar posterna i omgångar och skriver
+*                 dem via stora buffrade skrivningar. Därmed ingår ingen
+*                 disk-I/O i anroparens latens.
+*
+*                 När kön är full väntar person_async_put tills plats finns
+*                 (mottryck), medan person_async_try_put returnerar direkt
+*                 och räknar posten som bortkastad. Via person_async_flush
+*                 väntar anroparen tills samtliga tidigare köade poster har
+*                 skrivits till utströmmen.
+********************************************************************************/
+#ifndef PERSON_ASYNC_H_
+#define PERSON_ASYNC_H_
+
+/* Inkluderingsdirektiv: */
+#include "person_writer.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* Intern strukt som definieras i person_async.c. */
+struct person_async_slot;
+
+/********************************************************************************
+* person_async: Strukt för asynkron utskrift av persondata via en
+*               bakgrundstråd. Köns kapacitet är en tvåpotens.
+********************************************************************************/
+typedef struct person_async
+{
+   struct person_async_slot* slots; /* Köns platser. */
+   size_t mask;                     /* Köns kapacitet minus ett. */
+   _Alignas(64) atomic_size_t tail; /* Position för nästa köade post. */
+   _Alignas(64) size_t head;        /* Position för nästa post att skriva (bakgrundstråden). */
+   atomic_size_t written;           /* Antal poster som har skrivits till utströmmen. */
+   atomic_size_t dropped;           /* Antal poster som kastats av person_async_try_put. */
+   atomic_int sleeping;             /* Indikerar att bakgrundstråden väntar på poster. */
+   atomic_int stop;                 /* Indikerar att bakgrundstråden ska avslutas. */
+   atomic_int error;                /* Indikerar att en skrivning har misslyckats. */
+   struct person_writer writer;     /* Buffert för bakgrundstrådens skrivningar. */
+   pthread_t thread;                /* Bakgrundstråden. */
+   pthread_mutex_t mutex;           /* Mutex som skyddar väntan på villkoren nedan. */
+   pthread_cond_t wake;             /* Signaleras när bakgrundstråden ska vakna. */
+   pthread_cond_t progress;         /* Signaleras när bakgrundstråden har skrivit poster. */
+} person_async_t, *person_async_ptr_t;
+
+/********************************************************************************
+* person_async_init: Initierar en ny person_async och startar bakgrundstråden.
+*                    Vid lyckad initiering returneras 0, annars returneras 1.
+*
+*                    - self    : Pekare till objektet som ska initieras.
+*                    - ostream : Utström som posterna skrivs till (default = stdout).
+*                    - capacity: Köns kapacitet i antal poster (0 = 4096).
+********************************************************************************/
+int person_async_init(struct person_async* self,
+                      FILE* ostream,
+                      const size_t capacity);
+
+/********************************************************************************
+* person_async_clear: Skriver samtliga köade poster, avslutar bakgrundstråden
+*                     och frigör allokerat minne. Utströmmen stängs inte. Inga
+*                     poster får köas under eller efter anropet.
+*
+*                     - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_async_clear(struct person_async* self);
+
+/********************************************************************************
+* person_async_put: Köar en kopia av angivet person-objekt för utskrift. Om
+*                   kön är full väntar anropet tills plats finns. Objektet
+*                   kan ändras eller raderas direkt efter anropet. Vid lyckad
+*                   köning returneras 0, annars returneras 1.
+*
+*                   - self  : Pekare till aktuell person_async.
+*                   - person: Pekare till objektet som ska skrivas ut.
+********************************************************************************/
+int person_async_put(struct person_async* self,
+                     const struct person* person);
+
+/********************************************************************************
+* person_async_try_put: Köar en kopia av angivet person-objekt för utskrift
+*                       utan att vänta. Om kön är full returneras 1 och posten
+*                       räknas som bortkastad, annars returneras 0.
+*
+*                       - self  : Pekare till aktuell person_async.
+*                       - person: Pekare till objektet som ska skrivas ut.
+********************************************************************************/
+int person_async_try_put(struct person_async* self,
+                         const struct person* person);
+
+/********************************************************************************
+* person_async_flush: Väntar tills samtliga poster som köats före anropet har
+*                     skrivits och utströmmen har tömts via fflush. Om någon
+*                     skrivning har misslyckats returneras 1, annars 0.
+*
+*                     - self: Pekare till aktuell person_async.
+********************************************************************************/
+int person_async_flush(struct person_async* self);
+
+/********************************************************************************
+* person_async_pending: Returnerar antalet köade poster som ännu inte har
+*                       skrivits till utströmmen.
+*
+*                       - self: Pekare till aktuell person_async.
+********************************************************************************/
+size_t person_async_pending(const struct person_async* self);
+
+/********************************************************************************
+* person_async_dropped: Returnerar antalet poster som kastats av
+*                       person_async_try_put på grund av full kö.
+*
+*                       - self: Pekare till aktuell person_async.
+********************************************************************************/
+size_t person_async_dropped(const struct person_async* self);
+
+#endif /* PERSON_ASYNC_H_ */
@@ -0,0 +1,1047 @@
+/********************************************************************************
+* person_bench.c: Prestandamätning av person-biblioteket. Varje mätning körs
+*                 för datamängder om 1000, 100 000 samt 1 000 000 personer och
+*                 resultatet skrivs ut i JSON-format via stdout (antal
+*                 operationer, nanosekunder per operation samt operationer
+*                 per sekund), så att prestandaförsämringar kan upptäckas
+*                 automatiskt. Byggs via målet person_bench i CMakeLists.txt.
+*
+*                 Användning: person_bench [max_count]
+********************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "person.h"
+#include "person_async.h"
+#include "person_delta.h"
+#include "person_fast.h"
+#include "person_file.h"
+#include "person_filter.h"
+#include "person_index.h"
+#include "person_inline.h"
+#include "person_query.h"
+#include "person_registry.h"
+#include "person_schema.h"
+#include "person_snapshot.h"
+#include "person_sort.h"
+#include "person_stats.h"
+#include "person_store.h"
+#include "person_writer.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/* Yrken som tilldelas personerna i testdatan. */
+static const char* bench_occupations[] = { "Teacher", "Engineer", "Nurse", "Carpenter" };
+
+/* Temporära filer som skrivs under mätningarna. */
+#define BENCH_TEXT_FILE "person_bench.txt"
+#define BENCH_BINARY_FILE "person_bench.bin"
+
+/* Kompakt postvariant med enbart id, namn, ålder och kön. */
+#define BENCH_COMPACT_FIELDS(X)          \
+   X(id, U64, NONE, "Id")                \
+   X(name, STRING, NAME, "Name")         \
+   X(age, U32, AGE, "Age")               \
+   X(gender, GENDER, GENDER, "Gender")
+
+/* Postvarianter som genereras via person_schema.h. */
+PERSON_SCHEMA(bench_full, PERSON_SCHEMA_DEFAULT_FIELDS)
+PERSON_SCHEMA(bench_compact, BENCH_COMPACT_FIELDS)
+
+/* Antal utskrivna resultat, används för att separera JSON-objekten. */
+static size_t bench_results = 0;
+
+/* Förhindrar att kompilatorn optimerar bort uppmätta beräkningar. */
+static volatile size_t bench_sink = 0;
+
+/********************************************************************************
+* bench_data: Testdata som delas av samtliga mätningar.
+********************************************************************************/
+struct bench_data
+{
+   char (*names)[32];       /* Personernas namn. */
+   struct person** persons; /* Dynamiskt allokerade person-objekt. */
+};
+
+/********************************************************************************
+* bench_registry_task: Kontext för parallella uppslagningar i en
+*                      person_registry.
+********************************************************************************/
+struct bench_registry_task
+{
+   struct person_registry* registry; /* Pekare till registret. */
+   size_t count;                     /* Antal uppslagningar per tråd. */
+   atomic_size_t sum;                /* Summan av funna åldrar. */
+};
+
+/********************************************************************************
+* bench_now: Returnerar aktuell tid i nanosekunder från en monoton klocka.
+********************************************************************************/
+static double bench_now(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/********************************************************************************
+* bench_report: Skriver ut resultatet av en mätning som ett JSON-objekt.
+*
+*               - name   : Mätningens namn.
+*               - size   : Datamängdens storlek.
+*               - ops    : Antal uppmätta operationer.
+*               - elapsed: Uppmätt tid i nanosekunder.
+********************************************************************************/
+static void bench_report(const char* name,
+                         const size_t size,
+                         const size_t ops,
+                         const double elapsed)
+{
+   const double ns_per_op = ops ? elapsed / ops : 0.0;
+   const double ops_per_sec = elapsed > 0.0 ? ops * 1e9 / elapsed : 0.0;
+
+   printf("%s\n    {\"name\": \"%s\", \"size\": %zu, \"ops\": %zu, "
+          "\"ns_per_op\": %.3f, \"ops_per_sec\": %.1f}",
+          bench_results++ ? "," : "", name, size, ops, ns_per_op, ops_per_sec);
+   return;
+}
+
+/********************************************************************************
+* bench_compare: Jämför två uppmätta latenser vid sortering via qsort.
+*
+*                - lhs: Pekare till första latensen.
+*                - rhs: Pekare till andra latensen.
+********************************************************************************/
+static int bench_compare(const void* lhs,
+                         const void* rhs)
+{
+   const double a = *(const double*)lhs;
+   const double b = *(const double*)rhs;
+   return (a > b) - (a < b);
+}
+
+/********************************************************************************
+* bench_report_latency: Skriver ut resultatet av en mätning där varje operation
+*                       har tidtagits separat, inklusive median samt 99:e
+*                       percentilen. Angivna latenser sorteras.
+*
+*                       - name     : Mätningens namn.
+*                       - size     : Datamängdens storlek.
+*                       - latencies: Uppmätt tid per operation i nanosekunder.
+*                       - ops      : Antal uppmätta operationer.
+********************************************************************************/
+static void bench_report_latency(const char* name,
+                                 const size_t size,
+                                 double* latencies,
+                                 const size_t ops)
+{
+   double elapsed = 0.0;
+   for (size_t i = 0; i < ops; ++i)
+   {
+      elapsed += latencies[i];
+   }
+
+   qsort(latencies, ops, sizeof(double), &bench_compare);
+   printf("%s\n    {\"name\": \"%s\", \"size\": %zu, \"ops\": %zu, "
+          "\"ns_per_op\": %.3f, \"ops_per_sec\": %.1f, \"p50_ns\": %.1f, \"p99_ns\": %.1f}",
+          bench_results++ ? "," : "", name, size, ops, ops ? elapsed / ops : 0.0,
+          elapsed > 0.0 ? ops * 1e9 / elapsed : 0.0,
+          ops ? latencies[ops / 2] : 0.0, ops ? latencies[ops * 99 / 100] : 0.0);
+   return;
+}
+
+/********************************************************************************
+* bench_report_bytes: Skriver ut storleken på en datamängd i serialiserad form
+*                     som ett JSON-objekt.
+*
+*                     - name : Mätningens namn.
+*                     - size : Datamängdens storlek.
+*                     - bytes: Uppmätt storlek i bytes.
+********************************************************************************/
+static void bench_report_bytes(const char* name,
+                               const size_t size,
+                               const size_t bytes)
+{
+   printf("%s\n    {\"name\": \"%s\", \"size\": %zu, \"bytes\": %zu, "
+          "\"bytes_per_record\": %.3f}",
+          bench_results++ ? "," : "", name, size, bytes, size ? (double)bytes / size : 0.0);
+   return;
+}
+
+/********************************************************************************
+* bench_new_delete: Mäter person_new samt person_delete.
+*
+*                   - data : Pekare till testdatan.
+*                   - count: Antal personer att mäta.
+********************************************************************************/
+static void bench_new_delete(const struct bench_data* data,
+                             const size_t count)
+{
+   struct person** persons = (struct person**)malloc(count * sizeof(struct person*));
+   if (!persons) return;
+
+   double start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      persons[i] = person_new(data->names[i], (unsigned int)(i % 100), "Storgatan 1",
+                              bench_occupations[i % 4], (enum gender)(i % 4));
+   }
+   bench_report("person_new", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_delete(&persons[i]);
+   }
+   bench_report("person_delete", count, count, bench_now() - start);
+
+   free(persons);
+   return;
+}
+
+/********************************************************************************
+* bench_init_clear: Mäter person_init samt person_clear.
+*
+*                   - data : Pekare till testdatan.
+*                   - count: Antal personer att mäta.
+********************************************************************************/
+static void bench_init_clear(const struct bench_data* data,
+                             const size_t count)
+{
+   struct person* persons = (struct person*)malloc(count * sizeof(struct person));
+   if (!persons) return;
+
+   double start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_init(persons + i, data->names[i], (unsigned int)(i % 100), "Storgatan 1",
+                  bench_occupations[i % 4], (enum gender)(i % 4));
+   }
+   bench_report("person_init", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_clear(persons + i);
+   }
+   bench_report("person_clear", count, count, bench_now() - start);
+
+   free(persons);
+   return;
+}
+
+/********************************************************************************
+* bench_accessors: Mäter läsning av ålder samt namn via vtable, via direkta
+*                  funktionsanrop samt via inline-definierade accessorer.
+*
+*                  - data : Pekare till testdatan.
+*                  - count: Antal personer att mäta.
+********************************************************************************/
+static void bench_accessors(const struct bench_data* data,
+                            const size_t count)
+{
+   const struct person* const* persons = (const struct person* const*)data->persons;
+   size_t sum = 0;
+
+   double start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      sum += persons[i]->vptr->age(persons[i]) + (size_t)persons[i]->vptr->name(persons[i]);
+   }
+   bench_report("accessor_vtable", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      sum += person_age(persons[i]) + (size_t)person_name(persons[i]);
+   }
+   bench_report("accessor_direct", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      sum += person_fast_age(persons[i]) + (size_t)person_fast_name(persons[i]);
+   }
+   bench_report("accessor_inline", count, count, bench_now() - start);
+
+   bench_sink += sum;
+   return;
+}
+
+/********************************************************************************
+* bench_inline: Mäter skapande av en sammanhängande array av person_inline
+*               samt läsning av ålder och namnets första tecken via vtable,
+*               dels för heapallokerade person-objekt, dels för
+*               person_inline, där persondatan ligger direkt i objektet.
+*
+*               - data : Pekare till testdatan.
+*               - count: Antal personer att mäta.
+********************************************************************************/
+static void bench_inline(const struct bench_data* data,
+                         const size_t count)
+{
+   const struct person* const* persons = (const struct person* const*)data->persons;
+   struct person_inline* array = person_inline_array_new(count);
+   size_t sum = 0;
+   if (!array) return;
+
+   double start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_inline_init_from(&array[i], persons[i]);
+   }
+   bench_report("inline_init", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      sum += persons[i]->vptr->age(persons[i]) + (size_t)persons[i]->vptr->name(persons[i])[0];
+   }
+   bench_report("accessor_heap_touch", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      const struct person* person = &array[i].base;
+      sum += person->vptr->age(person) + (size_t)person->vptr->name(person)[0];
+   }
+   bench_report("accessor_inline_touch", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      sum += person_inline_age(&array[i]) + (size_t)person_inline_name(&array[i])[0];
+   }
+   bench_report("accessor_inline_direct", count, count, bench_now() - start);
+
+   start = bench_now();
+   person_inline_array_delete(&array, count);
+   bench_report("inline_delete", count, count, bench_now() - start);
+
+   bench_sink += sum;
+   return;
+}
+
+/********************************************************************************
+* bench_print: Mäter utskrift via person_print samt via person_print_many
+*              till angiven fil.
+*
+*              - data : Pekare till testdatan.
+*              - count: Antal personer att mäta.
+*              - path : Sökväg till filen som ska skrivas till.
+*              - label: Filens benämning i resultatet.
+********************************************************************************/
+static void bench_print(const struct bench_data* data,
+                        const size_t count,
+                        const char* path,
+                        const char* label)
+{
+   const struct person* const* persons = (const struct person* const*)data->persons;
+   char name[64];
+   FILE* ostream = fopen(path, "w");
+   if (!ostream) return;
+
+   double start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_print(persons[i], ostream);
+   }
+   fflush(ostream);
+   snprintf(name, sizeof(name), "person_print_%s", label);
+   bench_report(name, count, count, bench_now() - start);
+
+   rewind(ostream);
+   start = bench_now();
+   person_print_many(persons, count, ostream);
+   fflush(ostream);
+   snprintf(name, sizeof(name), "person_print_many_%s", label);
+   bench_report(name, count, count, bench_now() - start);
+
+   fclose(ostream);
+   return;
+}
+
+/********************************************************************************
+* bench_latency: Mäter latensen per utskriven post till fil, dels synkront via
+*                person_print, dels via köning i en person_async, där
+*                skrivningen sker av en bakgrundstråd. Tiden för att vänta in
+*                bakgrundstråden via person_async_flush mäts separat.
+*
+*                - data : Pekare till testdatan.
+*                - count: Antal personer att mäta.
+********************************************************************************/
+static void bench_latency(const struct bench_data* data,
+                          const size_t count)
+{
+   double* latencies = (double*)malloc(count * sizeof(double));
+   FILE* ostream = fopen(BENCH_TEXT_FILE, "w");
+   struct person_async async;
+
+   if (!latencies || !ostream)
+   {
+      if (ostream) fclose(ostream);
+      free(latencies);
+      return;
+   }
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      const double start = bench_now();
+      person_print(data->persons[i], ostream);
+      latencies[i] = bench_now() - start;
+   }
+   fflush(ostream);
+   bench_report_latency("latency_person_print", count, latencies, count);
+
+   rewind(ostream);
+   if (!person_async_init(&async, ostream, 0))
+   {
+      for (size_t i = 0; i < count; ++i)
+      {
+         const double start = bench_now();
+         person_async_put(&async, data->persons[i]);
+         latencies[i] = bench_now() - start;
+      }
+      bench_report_latency("latency_person_async_put", count, latencies, count);
+
+      const double start = bench_now();
+      person_async_flush(&async);
+      bench_report("person_async_flush", count, 1, bench_now() - start);
+      person_async_clear(&async);
+   }
+
+   fclose(ostream);
+   free(latencies);
+   return;
+}
+
+/********************************************************************************
+* bench_schema: Mäter formatering via person_writer_format jämfört med
+*               postvarianter genererade via person_schema.h, samt binär
+*               kodning och avkodning av den fullständiga och den kompakta
+*               varianten.
+*
+*               - data : Pekare till testdatan.
+*               - count: Antal personer att mäta.
+********************************************************************************/
+static void bench_schema(const struct bench_data* data,
+                         const size_t count)
+{
+   struct bench_full* full = (struct bench_full*)malloc(count * sizeof(struct bench_full));
+   struct bench_compact* compact = (struct bench_compact*)malloc(count * sizeof(struct bench_compact));
+   unsigned char* buffer = (unsigned char*)malloc(count * 128);
+   char text[512];
+   size_t sum = 0, offset = 0;
+
+   if (!full || !compact || !buffer)
+   {
+      free(buffer);
+      free(compact);
+      free(full);
+      return;
+   }
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      bench_full_from_person(&full[i], data->persons[i]);
+      bench_compact_from_person(&compact[i], data->persons[i]);
+      compact[i].id = i;
+   }
+
+   double start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      sum += person_writer_format(data->persons[i], text, sizeof(text));
+   }
+   bench_report("format_person_writer", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      sum += bench_full_format(&full[i], text, sizeof(text));
+   }
+   bench_report("format_schema_full", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      sum += bench_compact_format(&compact[i], text, sizeof(text));
+   }
+   bench_report("format_schema_compact", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      offset += bench_full_encode(&full[i], buffer + offset, count * 128 - offset);
+   }
+   bench_report("encode_schema_full", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0, position = 0; i < count; ++i)
+   {
+      position += bench_full_decode(&full[i], buffer + position, offset - position);
+      sum += full[i].age;
+   }
+   bench_report("decode_schema_full", count, count, bench_now() - start);
+
+   offset = 0;
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      offset += bench_compact_encode(&compact[i], buffer + offset, count * 128 - offset);
+   }
+   bench_report("encode_schema_compact", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0, position = 0; i < count; ++i)
+   {
+      position += bench_compact_decode(&compact[i], buffer + position, offset - position);
+      sum += compact[i].age;
+   }
+   bench_report("decode_schema_compact", count, count, bench_now() - start);
+
+   bench_sink += sum;
+   free(buffer);
+   free(compact);
+   free(full);
+   return;
+}
+
+/********************************************************************************
+* bench_delta: Mäter periodisk export av samtliga personer via
+*              person_print_many jämfört med inkrementell export via
+*              person_delta, där 1 % av personerna har ändrats sedan
+*              föregående export, i både text- och binärformat samt via
+*              listan över ändrade objekt för spårade personer.
+*
+*              - data : Pekare till testdatan.
+*              - count: Antal personer att mäta.
+********************************************************************************/
+static void bench_delta(const struct bench_data* data,
+                        const size_t count)
+{
+   const struct person* const* persons = (const struct person* const*)data->persons;
+   const size_t step = count < 100 ? 1 : 100;
+   struct person_delta delta;
+   FILE* ostream = fopen("/dev/null", "w");
+   if (!ostream) return;
+
+   double start = bench_now();
+   person_print_many(persons, count, ostream);
+   fflush(ostream);
+   bench_report("export_full_text", count, count, bench_now() - start);
+
+   if (person_delta_init_from(&delta, person_generation_current()))
+   {
+      fclose(ostream);
+      return;
+   }
+
+   for (size_t i = 0; i < count; i += step)
+   {
+      person_set_age(data->persons[i], person_age(data->persons[i]));
+   }
+   start = bench_now();
+   person_delta_print(&delta, persons, count, ostream);
+   fflush(ostream);
+   bench_report("export_delta_text", count, count, bench_now() - start);
+   bench_sink += delta.exported;
+
+   for (size_t i = 0; i < count; i += step)
+   {
+      person_set_age(data->persons[i], person_age(data->persons[i]));
+   }
+   start = bench_now();
+   person_delta_write_stream(&delta, persons, count, ostream);
+   fflush(ostream);
+   bench_report("export_delta_binary", count, count, bench_now() - start);
+   bench_sink += delta.exported;
+
+   int error = 0;
+   for (size_t i = 0; i < count && !error; ++i)
+   {
+      error = person_delta_track(&delta, data->persons[i]);
+   }
+   if (!error && !person_delta_print_tracked(&delta, ostream))
+   {
+      for (size_t i = 0; i < count; i += step)
+      {
+         person_set_age(data->persons[i], person_age(data->persons[i]));
+      }
+      start = bench_now();
+      person_delta_print_tracked(&delta, ostream);
+      fflush(ostream);
+      bench_report("export_tracked_text", count, count, bench_now() - start);
+      bench_sink += delta.exported;
+   }
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_delta_untrack(&delta, data->persons[i]);
+   }
+   person_delta_clear(&delta);
+   fclose(ostream);
+   return;
+}
+
+/********************************************************************************
+* bench_compare_age: Jämför två person-objekt på ålder via vtable, används
+*                    som referens vid sortering via qsort.
+*
+*                    - lhs: Pekare till pekaren till första objektet.
+*                    - rhs: Pekare till pekaren till andra objektet.
+********************************************************************************/
+static int bench_compare_age(const void* lhs,
+                             const void* rhs)
+{
+   const struct person* a = *(const struct person* const*)lhs;
+   const struct person* b = *(const struct person* const*)rhs;
+   const unsigned int x = a->vptr->age(a), y = b->vptr->age(b);
+   return x < y ? -1 : x > y;
+}
+
+/********************************************************************************
+* bench_compare_name: Jämför två person-objekt på namn via vtable, används
+*                     som referens vid sortering via qsort.
+*
+*                     - lhs: Pekare till pekaren till första objektet.
+*                     - rhs: Pekare till pekaren till andra objektet.
+********************************************************************************/
+static int bench_compare_name(const void* lhs,
+                              const void* rhs)
+{
+   const struct person* a = *(const struct person* const*)lhs;
+   const struct person* b = *(const struct person* const*)rhs;
+   return strcmp(a->vptr->name(a), b->vptr->name(b));
+}
+
+/********************************************************************************
+* bench_sort: Mäter sortering på ålder och namn via qsort med jämförelser via
+*             vtable jämfört med person_sort, samt urval av de 100 äldsta
+*             respektive första personerna via person_sort_top.
+*
+*             - data   : Pekare till testdatan.
+*             - count  : Antal personer att mäta.
+*             - workers: Pekare till trådpoolen.
+********************************************************************************/
+static void bench_sort(const struct bench_data* data,
+                       const size_t count,
+                       struct person_workers* workers)
+{
+   const struct person** persons = (const struct person**)malloc(count * sizeof(struct person*));
+   const struct person* top[100];
+   if (!persons) return;
+
+   memcpy(persons, data->persons, count * sizeof(struct person*));
+   double start = bench_now();
+   qsort(persons, count, sizeof(struct person*), &bench_compare_age);
+   bench_report("qsort_age", count, count, bench_now() - start);
+
+   memcpy(persons, data->persons, count * sizeof(struct person*));
+   start = bench_now();
+   person_sort(persons, count, workers, PERSON_SORT_AGE);
+   bench_report("sort_age_radix", count, count, bench_now() - start);
+
+   memcpy(persons, data->persons, count * sizeof(struct person*));
+   start = bench_now();
+   qsort(persons, count, sizeof(struct person*), &bench_compare_name);
+   bench_report("qsort_name", count, count, bench_now() - start);
+
+   memcpy(persons, data->persons, count * sizeof(struct person*));
+   start = bench_now();
+   person_sort(persons, count, workers, PERSON_SORT_NAME);
+   bench_report("sort_name_prefix", count, count, bench_now() - start);
+
+   start = bench_now();
+   person_sort_top((const struct person* const*)data->persons, count, 100,
+                   PERSON_SORT_AGE_DESCENDING, top);
+   bench_report("top100_age", count, count, bench_now() - start);
+
+   start = bench_now();
+   person_sort_top((const struct person* const*)data->persons, count, 100,
+                   PERSON_SORT_NAME, top);
+   bench_report("top100_name", count, count, bench_now() - start);
+
+   bench_sink += (size_t)top[0] + (size_t)persons[0];
+   free(persons);
+   return;
+}
+
+/********************************************************************************
+* bench_store: Mäter operationer över en person_store: tilläggning,
+*              filtrering, parallella aggregeringar, indexering samt
+*              skrivning och inläsning i binärt format.
+*
+*              - data   : Pekare till testdatan.
+*              - count  : Antal personer att mäta.
+*              - workers: Pekare till trådpoolen.
+********************************************************************************/
+static void bench_store(const struct bench_data* data,
+                        const size_t count,
+                        struct person_workers* workers)
+{
+   const struct person_filter filter = { 30, 40, PERSON_FILTER_GENDER(GENDER_FEMALE) };
+   struct person_occupation_count* occupations;
+   struct person_age_stats stats;
+   size_t histogram[GENDER_NONE + 1];
+   struct person_store store;
+   struct person_index index;
+   struct person_file file;
+   size_t* indices = (size_t*)malloc(count * sizeof(size_t));
+   if (!indices) return;
+
+   person_store_init(&store);
+   double start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_store_push(&store, data->names[i], (unsigned int)(i % 100), "Storgatan 1",
+                        bench_occupations[i % 4], (enum gender)(i % 4));
+   }
+   bench_report("store_push", count, count, bench_now() - start);
+
+   start = bench_now();
+   bench_sink += person_store_filter_age(&store, 30, 40, indices);
+   bench_report("store_filter_age", count, count, bench_now() - start);
+
+   start = bench_now();
+   bench_sink += person_filter_indices(&filter, &store, indices);
+   bench_report("filter_age_gender", count, count, bench_now() - start);
+
+   start = bench_now();
+   person_query_gender_histogram(&store, workers, histogram);
+   bench_report("query_gender_histogram", count, count, bench_now() - start);
+   bench_sink += histogram[GENDER_MALE];
+
+   start = bench_now();
+   person_query_age_stats(&store, workers, &stats);
+   bench_report("query_age_stats", count, count, bench_now() - start);
+   bench_sink += stats.count;
+
+   start = bench_now();
+   bench_sink += person_query_occupation_counts(&store, workers, &occupations);
+   bench_report("query_occupation_counts", count, count, bench_now() - start);
+   free(occupations);
+
+   person_index_init(&index);
+   start = bench_now();
+   person_index_build(&index, &store);
+   bench_report("index_build", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < 1000; ++i)
+   {
+      bench_sink += person_index_find_name(&index, &store, data->names[i * 7919 % count],
+                                           indices, 1);
+   }
+   bench_report("index_find_name", count, 1000, bench_now() - start);
+
+   start = bench_now();
+   bench_sink += person_index_find_age_occupation(&index, &store, 30, 40, "Teacher",
+                                                  indices, count);
+   bench_report("index_find_age_occupation", count, 1, bench_now() - start);
+   person_index_clear(&index);
+
+   start = bench_now();
+   person_file_write(&store, BENCH_BINARY_FILE);
+   bench_report("file_write", count, count, bench_now() - start);
+
+   start = bench_now();
+   if (!person_file_open(&file, BENCH_BINARY_FILE))
+   {
+      bench_report("file_open", count, 1, bench_now() - start);
+      size_t sum = 0;
+
+      start = bench_now();
+      for (size_t i = 0; i < person_file_size(&file); ++i)
+      {
+         sum += person_file_age(&file, i) + (size_t)person_file_name(&file, i)[0];
+      }
+      bench_report("file_scan", count, count, bench_now() - start);
+      bench_sink += sum;
+      person_file_close(&file);
+   }
+
+   remove(BENCH_BINARY_FILE);
+   person_store_clear(&store);
+   free(indices);
+   return;
+}
+
+/********************************************************************************
+* bench_snapshot: Mäter skapande av en komprimerad snapshot, dess storlek
+*                 jämfört med det binära filformatet samt filtrering och
+*                 räkning direkt på den komprimerade datan.
+*
+*                 - data : Pekare till testdatan.
+*                 - count: Antal personer att mäta.
+********************************************************************************/
+static void bench_snapshot(const struct bench_data* data,
+                           const size_t count)
+{
+   struct person_snapshot snapshot;
+   struct person_store store;
+   struct person_file file;
+   uint32_t code;
+   size_t* indices = (size_t*)malloc(count * sizeof(size_t));
+   unsigned int* ages = (unsigned int*)malloc(count * sizeof(unsigned int));
+
+   person_store_init(&store);
+   for (size_t i = 0; i < count && indices && ages; ++i)
+   {
+      person_store_push(&store, data->names[i], (unsigned int)(i % 100), "Storgatan 1",
+                        bench_occupations[i % 4], (enum gender)(i % 4));
+   }
+
+   double start = bench_now();
+   if (indices && ages && !person_snapshot_build(&snapshot, &store))
+   {
+      bench_report("snapshot_build", count, count, bench_now() - start);
+      bench_report_bytes("snapshot_bytes", count, person_snapshot_bytes(&snapshot));
+
+      if (!person_file_write(&store, BENCH_BINARY_FILE) && !person_file_open(&file, BENCH_BINARY_FILE))
+      {
+         bench_report_bytes("file_bytes", count, file.size);
+         person_file_close(&file);
+      }
+      remove(BENCH_BINARY_FILE);
+
+      start = bench_now();
+      bench_sink += person_snapshot_filter_age(&snapshot, 30, 40, indices);
+      bench_report("snapshot_filter_age", count, count, bench_now() - start);
+
+      start = bench_now();
+      bench_sink += person_snapshot_count_gender(&snapshot, GENDER_FEMALE);
+      bench_report("snapshot_count_gender", count, count, bench_now() - start);
+
+      start = bench_now();
+      if (!person_snapshot_code(&snapshot, PERSON_SNAPSHOT_OCCUPATIONS, "Teacher", &code))
+      {
+         bench_sink += person_snapshot_count_code(&snapshot, PERSON_SNAPSHOT_OCCUPATIONS, code);
+      }
+      bench_report("snapshot_count_occupation", count, count, bench_now() - start);
+
+      start = bench_now();
+      bench_sink += person_snapshot_decode_ages(&snapshot, 0, count, ages);
+      bench_report("snapshot_decode_ages", count, count, bench_now() - start);
+      person_snapshot_close(&snapshot);
+   }
+
+   person_store_clear(&store);
+   free(ages);
+   free(indices);
+   return;
+}
+
+/********************************************************************************
+* bench_registry_job: Slår upp objekt i registret i lässektioner om 64
+*                     uppslagningar åt gången. Körs av samtliga trådar.
+*
+*                     - context: Pekare till en bench_registry_task.
+*                     - worker : Trådens nummer.
+*                     - count  : Antal trådar.
+********************************************************************************/
+static void bench_registry_job(void* context,
+                               const size_t worker,
+                               const size_t count)
+{
+   struct bench_registry_task* task = (struct bench_registry_task*)context;
+   struct person_registry_reader* reader = person_registry_reader_new(task->registry);
+   size_t sum = 0;
+   if (!reader) return;
+
+   for (size_t i = 0; i < task->count; i += 64)
+   {
+      person_registry_read_begin(reader);
+
+      for (size_t j = i; j < i + 64 && j < task->count; ++j)
+      {
+         const struct person* p = person_registry_find(task->registry, (j * count + worker) % task->count);
+         if (p) sum += p->vptr->age(p);
+      }
+
+      person_registry_read_end(reader);
+   }
+
+   person_registry_reader_delete(task->registry, &reader);
+   atomic_fetch_add(&task->sum, sum);
+   return;
+}
+
+/********************************************************************************
+* bench_registry: Mäter tilläggning, parallella uppslagningar via samtliga
+*                 trådar, uppdatering samt borttagning i en person_registry.
+*
+*                 - data   : Pekare till testdatan.
+*                 - count  : Antal personer att mäta.
+*                 - workers: Pekare till trådpoolen.
+********************************************************************************/
+static void bench_registry(const struct bench_data* data,
+                           const size_t count,
+                           struct person_workers* workers)
+{
+   struct person_registry registry;
+   struct bench_registry_task task;
+   if (person_registry_init(&registry, 0)) return;
+
+   task.registry = &registry;
+   task.count = count;
+   atomic_init(&task.sum, 0);
+
+   double start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_registry_put(&registry, i, data->names[i], (unsigned int)(i % 100), "Storgatan 1",
+                          bench_occupations[i % 4], (enum gender)(i % 4));
+   }
+   bench_report("registry_put", count, count, bench_now() - start);
+
+   start = bench_now();
+   person_workers_run(workers, &bench_registry_job, &task);
+   bench_report("registry_find_parallel", count, count * person_workers_count(workers),
+                bench_now() - start);
+   bench_sink += atomic_load(&task.sum);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_registry_put(&registry, i, data->names[i], (unsigned int)(i % 100 + 1), "Storgatan 2",
+                          bench_occupations[i % 4], (enum gender)(i % 4));
+   }
+   bench_report("registry_update", count, count, bench_now() - start);
+
+   start = bench_now();
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_registry_remove(&registry, i);
+   }
+   bench_report("registry_remove", count, count, bench_now() - start);
+
+   person_registry_clear(&registry);
+   return;
+}
+
+/********************************************************************************
+* bench_parse_count: Tolkar angivet argument som maximalt antal personer. Vid
+*                    ett positivt heltal som ryms i minnet lagras värdet och
+*                    0 returneras, annars returneras 1.
+*
+*                    - arg  : Argumentet som ska tolkas.
+*                    - count: Adress där det tolkade värdet lagras.
+********************************************************************************/
+static int bench_parse_count(const char* arg,
+                             size_t* count)
+{
+   char* end = 0;
+   if (*arg < '0' || *arg > '9') return 1;
+
+   errno = 0;
+   const unsigned long long value = strtoull(arg, &end, 10);
+   if (errno || *end || !value || value > SIZE_MAX / sizeof(char[32])) return 1;
+
+   *count = (size_t)value;
+   return 0;
+}
+
+/********************************************************************************
+* bench_data_clear: Frigör testdatan, där samtliga pekare till person-objekt
+*                   antas vara antingen giltiga eller null.
+*
+*                   - data : Pekare till testdatan.
+*                   - count: Antal personer i testdatan.
+********************************************************************************/
+static void bench_data_clear(struct bench_data* data,
+                             const size_t count)
+{
+   for (size_t i = 0; data->persons && i < count; ++i)
+   {
+      person_delete(&data->persons[i]);
+   }
+
+   free(data->persons);
+   free(data->names);
+   data->persons = 0;
+   data->names = 0;
+   return;
+}
+
+/********************************************************************************
+* main: Skapar testdata och kör samtliga mätningar för varje datamängd som inte
+*       överstiger max_count (default = 1 000 000), som kan anges som första
+*       argument. Om max_count understiger någon av datamängderna körs en
+*       sista omgång med max_count personer. Resultatet skrivs ut i
+*       JSON-format via stdout. Om instrumenteringen i person_stats.h är
+*       aktiverad skrivs även räknarna ut via stderr.
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   const size_t sizes[] = { 1000, 100000, 1000000 };
+   size_t max_count = 1000000;
+   struct person_workers workers;
+   struct bench_data data;
+
+   if (argc > 2 || (argc > 1 && bench_parse_count(argv[1], &max_count)))
+   {
+      fprintf(stderr, "usage: %s [max_count], where max_count is a positive integer\n",
+              argv[0]);
+      return 1;
+   }
+
+   data.names = (char (*)[32])malloc(max_count * sizeof(*data.names));
+   data.persons = (struct person**)calloc(max_count, sizeof(struct person*));
+
+   if (!data.names || !data.persons || person_workers_init(&workers, 0))
+   {
+      bench_data_clear(&data, max_count);
+      return 1;
+   }
+
+   for (size_t i = 0; i < max_count; ++i)
+   {
+      snprintf(data.names[i], sizeof(data.names[i]), "Person %zu", i);
+      data.persons[i] = person_new(data.names[i], (unsigned int)(i % 100), "Storgatan 1",
+                                   bench_occupations[i % 4], (enum gender)(i % 4));
+      if (!data.persons[i])
+      {
+         person_workers_clear(&workers);
+         bench_data_clear(&data, max_count);
+         return 1;
+      }
+   }
+
+   printf("{\n  \"threads\": %zu,\n  \"filter_kernel\": \"%s\",\n  \"results\": [",
+          person_workers_count(&workers), person_filter_kernel_name());
+
+   for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+   {
+      const size_t size = sizes[i] < max_count ? sizes[i] : max_count;
+      bench_new_delete(&data, size);
+      bench_init_clear(&data, size);
+      bench_accessors(&data, size);
+      bench_inline(&data, size);
+      bench_print(&data, size, "/dev/null", "devnull");
+      bench_print(&data, size, BENCH_TEXT_FILE, "file");
+      bench_latency(&data, size);
+      bench_schema(&data, size);
+      bench_delta(&data, size);
+      bench_store(&data, size, &workers);
+      bench_snapshot(&data, size);
+      bench_registry(&data, size, &workers);
+      bench_sort(&data, size, &workers);
+      if (size == max_count) break;
+   }
+
+   printf("\n  ]\n}\n");
+   remove(BENCH_TEXT_FILE);
+
+   if (person_stats_enabled())
+   {
+      struct person_stats stats;
+      person_stats_snapshot(&stats);
+      person_stats_dump(&stats, stderr);
+   }
+
+   person_workers_clear(&workers);
+   bench_data_clear(&data, max_count);
+   return 0;
+}
@@ -0,0 +1,387 @@
+/********************************************************************************
+* person_check.c: Korrekthetskontroller av de trådsäkra delarna av
+*                 person-biblioteket. Varje kontroll körs av flera trådar
+*                 samtidigt och jämför resultatet mot det förväntade.
+*                 Programmet returnerar 0 om samtliga valda kontroller
+*                 lyckas, annars 1. Byggs via målet person_check i
+*                 CMakeLists.txt och körs via ctest.
+*
+*                 Användning: person_check [registry] [async]
+********************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "person_async.h"
+#include "person_registry.h"
+#include "person_workers.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Antal trådar som används vid kontrollerna. */
+#define CHECK_THREADS 4
+
+/* Antal id per tråd vid kontrollen av person_registry. */
+#define CHECK_REGISTRY_IDS 2000
+
+/* Antal omgångar med tilläggning och borttagning per tråd. */
+#define CHECK_REGISTRY_ROUNDS 8
+
+/* Antal poster per tråd och omgång vid kontrollen av person_async. */
+#define CHECK_ASYNC_RECORDS 2500
+
+/* Köns kapacitet vid kontrollen av person_async, liten för att ge mottryck. */
+#define CHECK_ASYNC_CAPACITY 64
+
+/* Antal försök att köa poster via person_async_try_put. */
+#define CHECK_ASYNC_TRY_PUTS 10000
+
+/********************************************************************************
+* check_registry_task: Kontext för kontrollen av person_registry.
+********************************************************************************/
+struct check_registry_task
+{
+   struct person_registry* registry; /* Pekare till registret. */
+   atomic_size_t errors;             /* Antal upptäckta fel. */
+};
+
+/********************************************************************************
+* check_async_task: Kontext för kontrollen av person_async.
+********************************************************************************/
+struct check_async_task
+{
+   struct person_async* async; /* Pekare till kön. */
+   size_t round;               /* Aktuell omgång. */
+   atomic_size_t errors;       /* Antal upptäckta fel. */
+};
+
+/********************************************************************************
+* check_registry_name: Lagrar det förväntade namnet för angivet id och
+*                      angiven omgång i angiven buffert.
+*
+*                      - name : Buffert där namnet lagras.
+*                      - size : Buffertens storlek.
+*                      - id   : Objektets id.
+*                      - round: Omgången då objektet lagrades.
+********************************************************************************/
+static void check_registry_name(char* name,
+                                const size_t size,
+                                const uint64_t id,
+                                const size_t round)
+{
+   snprintf(name, size, "Person %" PRIu64 " (%zu)", id, round);
+   return;
+}
+
+/********************************************************************************
+* check_registry_valid: Indikerar ifall angivet objekt är ett helt objekt som
+*                       lagrats under angivet id, dvs. att namn och ålder
+*                       hör ihop. Omgången avläses ur åldern.
+*
+*                       - person: Pekare till objektet som ska kontrolleras.
+*                       - id    : Objektets id.
+********************************************************************************/
+static int check_registry_valid(const struct person* person,
+                                const uint64_t id)
+{
+   char name[64];
+   check_registry_name(name, sizeof(name), id, person->vptr->age(person));
+   return !strcmp(person->vptr->name(person), name) &&
+          !strcmp(person->vptr->occupation(person), "Tester");
+}
+
+/********************************************************************************
+* check_registry_job: Lägger till, uppdaterar och tar bort trådens egna id i
+*                     registret i flera omgångar. Efter varje ändring
+*                     kontrolleras trådens egna id, medan övriga trådars id
+*                     slås upp inom lässektioner för att kontrollera att
+*                     objekt aldrig observeras delvis ersatta eller frigjorda.
+*
+*                     - context: Pekare till en check_registry_task.
+*                     - worker : Trådens nummer.
+*                     - count  : Antal trådar.
+********************************************************************************/
+static void check_registry_job(void* context,
+                               const size_t worker,
+                               const size_t count)
+{
+   struct check_registry_task* task = (struct check_registry_task*)context;
+   struct person_registry_reader* reader = person_registry_reader_new(task->registry);
+   const uint64_t ids = (uint64_t)CHECK_REGISTRY_IDS * count;
+   size_t errors = 0;
+   char name[64];
+
+   if (!reader)
+   {
+      atomic_fetch_add(&task->errors, 1);
+      return;
+   }
+
+   for (size_t round = 0; round < CHECK_REGISTRY_ROUNDS; ++round)
+   {
+      for (uint64_t id = worker; id < ids; id += count)
+      {
+         check_registry_name(name, sizeof(name), id, round);
+         errors += person_registry_put(task->registry, id, name, (unsigned int)round,
+                                       "Testgatan 1", "Tester", GENDER_OTHER) != 0;
+
+         if (id % 64 == worker)
+         {
+            person_registry_read_begin(reader);
+
+            for (uint64_t other = 0; other < ids; other += 7)
+            {
+               const struct person* p = person_registry_find(task->registry, other);
+               if (p && !check_registry_valid(p, other)) errors++;
+            }
+            person_registry_read_end(reader);
+         }
+      }
+
+      person_registry_read_begin(reader);
+
+      for (uint64_t id = worker; id < ids; id += count)
+      {
+         const struct person* p = person_registry_find(task->registry, id);
+         if (!p || p->vptr->age(p) != round || !check_registry_valid(p, id)) errors++;
+      }
+      person_registry_read_end(reader);
+
+      for (uint64_t id = worker; id < ids; id += 2 * count)
+      {
+         errors += person_registry_remove(task->registry, id) != 0;
+         errors += person_registry_remove(task->registry, id) == 0;
+      }
+
+      person_registry_read_begin(reader);
+
+      for (uint64_t id = worker; id < ids; id += count)
+      {
+         const int removed = (id - worker) % (2 * count) == 0;
+         errors += (person_registry_find(task->registry, id) != 0) == removed;
+      }
+      person_registry_read_end(reader);
+   }
+
+   person_registry_reader_delete(task->registry, &reader);
+   atomic_fetch_add(&task->errors, errors);
+   return;
+}
+
+/********************************************************************************
+* check_registry: Kontrollerar person_registry då samtliga trådar samtidigt
+*                 lägger till, slår upp och tar bort objekt. Efteråt ska
+*                 registret innehålla exakt de id som inte togs bort i sista
+*                 omgången, med data från sista omgången. Returnerar antalet
+*                 upptäckta fel.
+*
+*                 - workers: Pekare till trådpoolen.
+********************************************************************************/
+static size_t check_registry(struct person_workers* workers)
+{
+   struct person_registry registry;
+   struct check_registry_task task;
+   const size_t count = person_workers_count(workers);
+   const uint64_t ids = (uint64_t)CHECK_REGISTRY_IDS * count;
+   size_t errors = 0;
+
+   if (person_registry_init(&registry, 16)) return 1;
+   task.registry = &registry;
+   atomic_init(&task.errors, 0);
+   person_workers_run(workers, &check_registry_job, &task);
+   errors = atomic_load(&task.errors);
+
+   if (person_registry_size(&registry) != ids / 2) errors++;
+
+   for (uint64_t id = 0; id < ids; ++id)
+   {
+      const struct person* p = person_registry_find(&registry, id);
+      const int removed = (id % count) == (id % (2 * count));
+
+      if (removed ? p != 0 : !p || p->vptr->age(p) != CHECK_REGISTRY_ROUNDS - 1 ||
+          !check_registry_valid(p, id))
+      {
+         errors++;
+      }
+   }
+
+   person_registry_clear(&registry);
+   printf("registry: %zu threads, %" PRIu64 " ids, %zu errors\n", count, ids, errors);
+   return errors;
+}
+
+/********************************************************************************
+* check_async_job: Köar trådens poster i ordning via person_async_put. Varje
+*                  post namnges efter tråden och postens löpnummer, så att
+*                  ordningen kan kontrolleras i utströmmen.
+*
+*                  - context: Pekare till en check_async_task.
+*                  - worker : Trådens nummer.
+*                  - count  : Antal trådar.
+********************************************************************************/
+static void check_async_job(void* context,
+                            const size_t worker,
+                            const size_t count)
+{
+   struct check_async_task* task = (struct check_async_task*)context;
+   size_t errors = 0;
+   char name[64];
+   (void)count;
+
+   for (size_t i = 0; i < CHECK_ASYNC_RECORDS; ++i)
+   {
+      const size_t sequence = task->round * CHECK_ASYNC_RECORDS + i;
+      snprintf(name, sizeof(name), "P%zu-%zu", worker, sequence);
+      struct person* p = person_new(name, (unsigned int)(sequence % 100), "Testgatan 1",
+                                    "Tester", GENDER_OTHER);
+      errors += !p || person_async_put(task->async, p) != 0;
+      person_delete(&p);
+   }
+
+   atomic_fetch_add(&task->errors, errors);
+   return;
+}
+
+/********************************************************************************
+* check_async_read: Läser samtliga poster i angiven fil och kontrollerar att
+*                   varje tråds poster förekommer exakt en gång och i den
+*                   ordning de köades. Returnerar antalet upptäckta fel och
+*                   lagrar antalet lästa poster på angiven adress.
+*
+*                   - path   : Sökväg till filen som ska läsas.
+*                   - threads: Antal trådar som har köat poster.
+*                   - records: Adress där antalet lästa poster lagras.
+********************************************************************************/
+static size_t check_async_read(const char* path,
+                               const size_t threads,
+                               size_t* records)
+{
+   size_t next[CHECK_THREADS + 1] = { 0 };
+   size_t errors = 0, worker, sequence;
+   char line[128];
+   FILE* istream = fopen(path, "r");
+
+   *records = 0;
+   if (!istream) return 1;
+
+   while (fgets(line, sizeof(line), istream))
+   {
+      if (strncmp(line, "Name: ", 6)) continue;
+      (*records)++;
+
+      if (sscanf(line, "Name: P%zu-%zu", &worker, &sequence) == 2)
+      {
+         if (worker >= threads || sequence != next[worker]++) errors++;
+      }
+      else
+      {
+         worker = threads;
+         next[worker]++;
+      }
+   }
+
+   fclose(istream);
+   return errors;
+}
+
+/********************************************************************************
+* check_async: Kontrollerar person_async då samtliga trådar samtidigt köar
+*              poster i en liten kö. Efter varje omgång töms kön via
+*              person_async_flush, varefter utströmmen ska innehålla exakt
+*              de köade posterna i köordning per tråd. Därefter kontrolleras
+*              att person_async_try_put räknar bortkastade poster korrekt.
+*              Returnerar antalet upptäckta fel.
+*
+*              - workers: Pekare till trådpoolen.
+********************************************************************************/
+static size_t check_async(struct person_workers* workers)
+{
+   struct person_async async;
+   struct check_async_task task;
+   const size_t count = person_workers_count(workers);
+   char path[] = "/tmp/person_check_XXXXXX";
+   size_t errors = 0, records = 0, queued = 0;
+
+   const int fd = mkstemp(path);
+   if (fd < 0) return 1;
+   FILE* ostream = fdopen(fd, "w");
+
+   if (!ostream || person_async_init(&async, ostream, CHECK_ASYNC_CAPACITY))
+   {
+      if (ostream) fclose(ostream);
+      else close(fd);
+      remove(path);
+      return 1;
+   }
+
+   task.async = &async;
+   atomic_init(&task.errors, 0);
+
+   for (task.round = 0; task.round < 2; ++task.round)
+   {
+      person_workers_run(workers, &check_async_job, &task);
+      errors += person_async_flush(&async) != 0;
+      errors += person_async_pending(&async) != 0;
+      errors += check_async_read(path, count, &records);
+      errors += records != (task.round + 1) * count * CHECK_ASYNC_RECORDS;
+   }
+
+   struct person* p = person_new("Try", 1, "Testgatan 1", "Tester", GENDER_OTHER);
+   if (!p) errors++;
+
+   for (size_t i = 0; i < CHECK_ASYNC_TRY_PUTS && p; ++i)
+   {
+      queued += person_async_try_put(&async, p) == 0;
+   }
+
+   person_delete(&p);
+   errors += person_async_flush(&async) != 0;
+   errors += queued + person_async_dropped(&async) != CHECK_ASYNC_TRY_PUTS;
+   errors += check_async_read(path, count, &records);
+   errors += records != 2 * count * CHECK_ASYNC_RECORDS + queued;
+   errors += atomic_load(&task.errors);
+
+   person_async_clear(&async);
+   fclose(ostream);
+   remove(path);
+   printf("async: %zu threads, %zu records, %zu dropped, %zu errors\n",
+          count, records, CHECK_ASYNC_TRY_PUTS - queued, errors);
+   return errors;
+}
+
+/********************************************************************************
+* check_selected: Indikerar ifall angiven kontroll ska köras, vilket gäller
+*                 om inga kontroller anges eller om kontrollen anges bland
+*                 programmets argument.
+*
+*                 - name: Kontrollens namn.
+*                 - argc: Antal argument.
+*                 - argv: Programmets argument.
+********************************************************************************/
+static int check_selected(const char* name,
+                          const int argc,
+                          char** argv)
+{
+   if (argc < 2) return 1;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      if (!strcmp(argv[i], name)) return 1;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* main: Kör valda kontroller. Returnerar 0 om samtliga lyckas, annars 1.
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   struct person_workers workers;
+   size_t errors = 0;
+   if (person_workers_init(&workers, CHECK_THREADS)) return 1;
+
+   if (check_selected("registry", argc, argv)) errors += check_registry(&workers);
+   if (check_selected("async", argc, argv)) errors += check_async(&workers);
+
+   person_workers_clear(&workers);
+   return errors != 0;
+}
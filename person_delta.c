@@ -0,0 +1,414 @@
+/********************************************************************************
+* person_delta.c: Innehåller definitioner av associerade funktioner tillhörande
+*                 strukten person_delta, som används för inkrementell export
+*                 av ändrad persondata.
+********************************************************************************/
+#include "person_delta.h"
+#include "person_file.h"
+#include "person_mem.h"
+#include "person_store.h"
+#include "person_writer.h"
+#include <string.h>
+
+/* Statiska funktioner: */
+static int person_delta_print_persons(const struct person* const* persons,
+                                      const size_t count,
+                                      const uint64_t since,
+                                      FILE* ostream,
+                                      size_t* exported);
+static int person_delta_write_persons(const struct person* const* persons,
+                                      const size_t count,
+                                      const uint64_t since,
+                                      FILE* ostream,
+                                      size_t* exported);
+static void person_delta_drain(struct person_delta* self);
+
+/********************************************************************************
+* person_delta_init: Initierar en ny person_delta, där första exporten
+*                    omfattar samtliga objekt. Vid lyckad initiering
+*                    returneras 0, annars returneras 1.
+*
+*                    - self: Pekare till objektet som ska initieras.
+********************************************************************************/
+int person_delta_init(struct person_delta* self)
+{
+   return person_delta_init_from(self, 0);
+}
+
+/********************************************************************************
+* person_delta_init_from: Initierar en ny person_delta, där första exporten
+*                         omfattar objekt som ändrats efter angiven generation.
+*                         Vid lyckad initiering returneras 0, annars 1.
+*
+*                         - self : Pekare till objektet som ska initieras.
+*                         - since: Senast exporterade generation.
+********************************************************************************/
+int person_delta_init_from(struct person_delta* self,
+                           const uint64_t since)
+{
+   memset(self, 0, sizeof(*self));
+   self->since = since;
+   return pthread_mutex_init(&self->mutex, 0) != 0;
+}
+
+/********************************************************************************
+* person_delta_clear: Frigör minne allokerat av angiven person_delta. Samtliga
+*                     spårade objekt måste ha nollställts eller avregistrerats
+*                     via person_delta_untrack innan anropet.
+*
+*                     - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_delta_clear(struct person_delta* self)
+{
+   free(self->dirty);
+   pthread_mutex_destroy(&self->mutex);
+   memset(self, 0, sizeof(*self));
+   return;
+}
+
+/********************************************************************************
+* person_delta_track: Registrerar angivet objekt för spårning, så att det
+*                     exporteras via person_delta_print_tracked samt
+*                     person_delta_write_tracked_stream när det har ändrats.
+*                     Objektet räknas som ändrat direkt efter registreringen.
+*                     Plats i listan över ändrade objekt reserveras här, så
+*                     att en ändring aldrig behöver allokera minne. Vid lyckad
+*                     registrering returneras 0, annars returneras 1.
+*
+*                     - self  : Pekare till aktuell person_delta.
+*                     - person: Pekare till objektet som ska spåras.
+********************************************************************************/
+int person_delta_track(struct person_delta* self,
+                       struct person* person)
+{
+   struct person_mem* mem = person->mem;
+   if (!mem || (mem->delta && mem->delta != self)) return 1;
+   if (mem->delta == self) return 0;
+
+   pthread_mutex_lock(&self->mutex);
+
+   if (self->tracked == self->capacity)
+   {
+      const size_t capacity = self->capacity ? self->capacity * 2 : 64;
+      struct person** dirty = (struct person**)realloc(self->dirty, capacity * sizeof(struct person*));
+
+      if (!dirty)
+      {
+         pthread_mutex_unlock(&self->mutex);
+         return 1;
+      }
+
+      self->dirty = dirty;
+      self->capacity = capacity;
+   }
+
+   self->tracked++;
+   mem->delta = self;
+   atomic_store_explicit(&mem->dirty, 1, memory_order_relaxed);
+   mem->dirty_index = self->size;
+   self->dirty[self->size++] = person;
+   pthread_mutex_unlock(&self->mutex);
+   return 0;
+}
+
+/********************************************************************************
+* person_delta_untrack: Avregistrerar angivet objekt från spårning. Objektet
+*                       avregistreras även automatiskt när det nollställs.
+*
+*                       - self  : Pekare till aktuell person_delta.
+*                       - person: Pekare till objektet som inte längre ska spåras.
+********************************************************************************/
+void person_delta_untrack(struct person_delta* self,
+                          struct person* person)
+{
+   if (person->mem && person->mem->delta == self) person_delta_forget(self, person->mem);
+   return;
+}
+
+/********************************************************************************
+* person_delta_mark: Lägger till angivet spårat objekt i listan över ändrade
+*                    objekt. Platsen reserverades vid registreringen, varför
+*                    ingen minnesallokering sker.
+*
+*                    - self  : Pekare till deltan som spårar objektet.
+*                    - person: Pekare till det ändrade objektet.
+********************************************************************************/
+void person_delta_mark(struct person_delta* self,
+                       struct person* person)
+{
+   pthread_mutex_lock(&self->mutex);
+   person->mem->dirty_index = self->size;
+   self->dirty[self->size++] = person;
+   pthread_mutex_unlock(&self->mutex);
+   return;
+}
+
+/********************************************************************************
+* person_delta_forget: Slutar spåra objektet som lagrar angiven persondata och
+*                      tar bort det ur listan över ändrade objekt genom att
+*                      flytta listans sista objekt till dess plats.
+*
+*                      - self: Pekare till deltan som spårar objektet.
+*                      - mem : Pekare till objektets persondata.
+********************************************************************************/
+void person_delta_forget(struct person_delta* self,
+                         struct person_mem* mem)
+{
+   pthread_mutex_lock(&self->mutex);
+
+   if (atomic_load_explicit(&mem->dirty, memory_order_acquire) && mem->dirty_index < self->size &&
+       self->dirty[mem->dirty_index]->mem == mem)
+   {
+      struct person* last = self->dirty[--self->size];
+      self->dirty[mem->dirty_index] = last;
+      last->mem->dirty_index = mem->dirty_index;
+   }
+
+   atomic_store_explicit(&mem->dirty, 0, memory_order_release);
+   mem->delta = 0;
+   self->tracked--;
+   pthread_mutex_unlock(&self->mutex);
+   return;
+}
+
+/********************************************************************************
+* person_delta_pending: Returnerar antalet spårade objekt som har ändrats
+*                       sedan senaste export.
+*
+*                       - self: Pekare till aktuell person_delta.
+********************************************************************************/
+size_t person_delta_pending(struct person_delta* self)
+{
+   pthread_mutex_lock(&self->mutex);
+   const size_t size = self->size;
+   pthread_mutex_unlock(&self->mutex);
+   return size;
+}
+
+/********************************************************************************
+* person_delta_print: Skriver ändrade objekt i angiven array via angiven
+*                     utström i samma format som person_print. Generationen
+*                     läses innan genomsökningen, så att objekt som ändras
+*                     under exporten även ingår i nästa export.
+*
+*                     - self   : Pekare till aktuell person_delta.
+*                     - persons: Array innehållande pekare till objekten.
+*                     - count  : Antal objekt i arrayen.
+*                     - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+int person_delta_print(struct person_delta* self,
+                       const struct person* const* persons,
+                       const size_t count,
+                       FILE* ostream)
+{
+   const uint64_t generation = person_generation_current();
+   size_t exported = 0;
+   if (person_delta_print_persons(persons, count, self->since, ostream, &exported)) return 1;
+
+   self->since = generation;
+   self->exported = exported;
+   return 0;
+}
+
+/********************************************************************************
+* person_delta_write_stream: Skriver ändrade objekt i angiven array till
+*                            angiven utström i det binära formatet i
+*                            person_file.h. Objekten samlas först i en
+*                            temporär person_store, som sedan skrivs via
+*                            person_file_write_stream.
+*
+*                            - self   : Pekare till aktuell person_delta.
+*                            - persons: Array innehållande pekare till objekten.
+*                            - count  : Antal objekt i arrayen.
+*                            - ostream: Pekare till utströmmen.
+********************************************************************************/
+int person_delta_write_stream(struct person_delta* self,
+                              const struct person* const* persons,
+                              const size_t count,
+                              FILE* ostream)
+{
+   const uint64_t generation = person_generation_current();
+   size_t exported = 0;
+   if (person_delta_write_persons(persons, count, self->since, ostream, &exported)) return 1;
+
+   self->since = generation;
+   self->exported = exported;
+   return 0;
+}
+
+/********************************************************************************
+* person_delta_print_tracked: Skriver samtliga spårade objekt som har ändrats
+*                             sedan senaste export via angiven utström i
+*                             samma format som person_print. Enbart listan
+*                             över ändrade objekt gås igenom, varför kostnaden
+*                             skalar med antalet ändringar. Vid lyckad export
+*                             töms listan, annars lämnas den oförändrad.
+*                             Spårade objekt får inte ändras under exporten.
+*
+*                             - self   : Pekare till aktuell person_delta.
+*                             - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+int person_delta_print_tracked(struct person_delta* self,
+                               FILE* ostream)
+{
+   size_t exported = 0;
+   pthread_mutex_lock(&self->mutex);
+   const int error = person_delta_print_persons((const struct person* const*)self->dirty,
+                                                self->size, 0, ostream, &exported);
+   if (!error) person_delta_drain(self);
+   pthread_mutex_unlock(&self->mutex);
+
+   if (!error) self->exported = exported;
+   return error;
+}
+
+/********************************************************************************
+* person_delta_write_tracked_stream: Skriver samtliga spårade objekt som har
+*                                    ändrats sedan senaste export till angiven
+*                                    utström i det binära formatet i
+*                                    person_file.h. Vid lyckad export töms
+*                                    listan över ändrade objekt, annars lämnas
+*                                    den oförändrad.
+*
+*                                    - self   : Pekare till aktuell person_delta.
+*                                    - ostream: Pekare till utströmmen.
+********************************************************************************/
+int person_delta_write_tracked_stream(struct person_delta* self,
+                                      FILE* ostream)
+{
+   size_t exported = 0;
+   pthread_mutex_lock(&self->mutex);
+   const int error = person_delta_write_persons((const struct person* const*)self->dirty,
+                                                self->size, 0, ostream, &exported);
+   if (!error) person_delta_drain(self);
+   pthread_mutex_unlock(&self->mutex);
+
+   if (!error) self->exported = exported;
+   return error;
+}
+
+/********************************************************************************
+* person_delta_write: Skriver ändrade objekt i angiven array till en fil på
+*                     angiven sökväg i det binära formatet i person_file.h.
+*
+*                     - self   : Pekare till aktuell person_delta.
+*                     - persons: Array innehållande pekare till objekten.
+*                     - count  : Antal objekt i arrayen.
+*                     - path   : Sökväg till filen som ska skrivas.
+********************************************************************************/
+int person_delta_write(struct person_delta* self,
+                       const struct person* const* persons,
+                       const size_t count,
+                       const char* path)
+{
+   const uint64_t since = self->since;
+   const size_t exported = self->exported;
+   FILE* ostream = fopen(path, "wb");
+   if (!ostream) return 1;
+   const int error = person_delta_write_stream(self, persons, count, ostream);
+
+   if (fclose(ostream) || error)
+   {
+      self->since = since;
+      self->exported = exported;
+      return 1;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_delta_print_persons: Skriver objekt i angiven array vars generation
+*                             är högre än angiven generation via angiven
+*                             utström och lagrar antalet skrivna objekt.
+*                             Vid lyckad skrivning returneras 0, annars 1.
+*
+*                             - persons : Array innehållande pekare till objekten.
+*                             - count   : Antal objekt i arrayen.
+*                             - since   : Senast exporterade generation (0 = samtliga).
+*                             - ostream : Pekare till angiven utström.
+*                             - exported: Adress där antalet skrivna objekt lagras.
+********************************************************************************/
+static int person_delta_print_persons(const struct person* const* persons,
+                                      const size_t count,
+                                      const uint64_t since,
+                                      FILE* ostream,
+                                      size_t* exported)
+{
+   struct person_writer writer;
+   int error = 0;
+   *exported = 0;
+
+   if (person_writer_init(&writer, ostream, 0)) return 1;
+
+   for (size_t i = 0; i < count && !error; ++i)
+   {
+      if (person_generation(persons[i]) > since)
+      {
+         error = person_writer_put(&writer, persons[i]);
+         (*exported)++;
+      }
+   }
+
+   error = error || person_writer_flush(&writer);
+   person_writer_clear(&writer);
+   return error;
+}
+
+/********************************************************************************
+* person_delta_write_persons: Skriver objekt i angiven array vars generation
+*                             är högre än angiven generation till angiven
+*                             utström i det binära formatet i person_file.h
+*                             och lagrar antalet skrivna objekt. Objekten
+*                             samlas först i en temporär person_store, som
+*                             sedan skrivs via person_file_write_stream. Vid
+*                             lyckad skrivning returneras 0, annars 1.
+*
+*                             - persons : Array innehållande pekare till objekten.
+*                             - count   : Antal objekt i arrayen.
+*                             - since   : Senast exporterade generation (0 = samtliga).
+*                             - ostream : Pekare till utströmmen.
+*                             - exported: Adress där antalet skrivna objekt lagras.
+********************************************************************************/
+static int person_delta_write_persons(const struct person* const* persons,
+                                      const size_t count,
+                                      const uint64_t since,
+                                      FILE* ostream,
+                                      size_t* exported)
+{
+   struct person_store store;
+   int error = 0;
+
+   person_store_init(&store);
+
+   for (size_t i = 0; i < count && !error; ++i)
+   {
+      if (person_generation(persons[i]) > since)
+      {
+         const struct person* person = persons[i];
+         error = person_store_push(&store, person->vptr->name(person), person->vptr->age(person),
+                                   person->vptr->address(person), person->vptr->occupation(person),
+                                   person->vptr->gender(person));
+      }
+   }
+
+   error = error || person_file_write_stream(&store, ostream);
+   *exported = store.size;
+   person_store_clear(&store);
+   return error;
+}
+
+/********************************************************************************
+* person_delta_drain: Tömmer listan över ändrade objekt efter en lyckad export.
+*                     Anropas med deltans mutex låst.
+*
+*                     - self: Pekare till aktuell person_delta.
+********************************************************************************/
+static void person_delta_drain(struct person_delta* self)
+{
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      atomic_store_explicit(&self->dirty[i]->mem->dirty, 0, memory_order_release);
+   }
+   self->size = 0;
+   return;
+}
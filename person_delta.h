@@ -0,0 +1,198 @@
+/********************************************************************************
+* person_delta.h: Innehåller inkrementell export av persondata via strukten
+*                 person_delta. Varje export skriver enbart de person-objekt
+*                 som har ändrats sedan föregående lyckade export, vilket
+*                 avgörs via objektens generation (se person_generation).
+*                 Därmed skalar kostnaden för formatering och skrivning med
+*                 antalet ändrade objekt istället för med datamängdens
+*                 storlek; kvar blir enbart en jämförelse per objekt.
+*
+*                 Exporten sker antingen i textformat (samma som
+*                 person_print) eller i det binära formatet i person_file.h,
+*                 så att en binär delta kan läsas in via person_file_open.
+*                 Borttagna objekt ingår inte i exporten, medan objekt utan
+*                 generationsspårning (exempelvis vyer och person_inline)
+*                 ingår i varje export.
+*
+*                 Ovanstående export jämför generationen för varje objekt i
+*                 arrayen. Vid stora datamängder med få ändringar kan objekt
+*                 istället registreras via person_delta_track, varpå varje
+*                 ändring lägger objektet i en lista över ändrade objekt.
+*                 Denna lista töms via person_delta_print_tracked samt
+*                 person_delta_write_tracked_stream, vars kostnad därmed
+*                 skalar med antalet ändringar. Spårade objekt får inte
+*                 flyttas i minnet medan de spåras.
+*
+*                 Exempel:
+*
+*                 struct person_delta delta;
+*                 if (person_delta_init(&delta)) return 1;
+*                 person_delta_print(&delta, persons, count, ostream); // Samtliga.
+*                 person_set_age(persons[42], 43);
+*                 person_delta_print(&delta, persons, count, ostream); // Enbart persons[42].
+*                 ...
+*                 person_delta_clear(&delta);
+********************************************************************************/
+#ifndef PERSON_DELTA_H_
+#define PERSON_DELTA_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+#include <pthread.h>
+#include <stdint.h>
+
+/********************************************************************************
+* person_delta: Strukt som håller reda på senast exporterade generation samt
+*               på vilka spårade objekt som har ändrats sedan senaste export.
+********************************************************************************/
+typedef struct person_delta
+{
+   uint64_t since;        /* Objekt med högre generation exporteras vid nästa export. */
+   size_t exported;       /* Antal objekt som skrevs vid senaste lyckade export. */
+   struct person** dirty; /* Spårade objekt som har ändrats sedan senaste export. */
+   size_t size;           /* Antal objekt i listan över ändrade objekt. */
+   size_t capacity;       /* Reserverad plats i listan över ändrade objekt. */
+   size_t tracked;        /* Antal spårade objekt. */
+   pthread_mutex_t mutex; /* Skyddar listan över ändrade objekt. */
+} person_delta_t, *person_delta_ptr_t;
+
+/********************************************************************************
+* person_delta_init: Initierar en ny person_delta, där första exporten
+*                    omfattar samtliga objekt. Vid lyckad initiering
+*                    returneras 0, annars returneras 1.
+*
+*                    - self: Pekare till objektet som ska initieras.
+********************************************************************************/
+int person_delta_init(struct person_delta* self);
+
+/********************************************************************************
+* person_delta_init_from: Initierar en ny person_delta, där första exporten
+*                         omfattar objekt som ändrats efter angiven
+*                         generation, exempelvis ett tidigare värde från
+*                         person_generation_current. Vid lyckad initiering
+*                         returneras 0, annars returneras 1.
+*
+*                         - self : Pekare till objektet som ska initieras.
+*                         - since: Senast exporterade generation.
+********************************************************************************/
+int person_delta_init_from(struct person_delta* self,
+                           const uint64_t since);
+
+/********************************************************************************
+* person_delta_clear: Frigör minne allokerat av angiven person_delta. Samtliga
+*                     spårade objekt måste ha nollställts eller avregistrerats
+*                     via person_delta_untrack innan anropet.
+*
+*                     - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_delta_clear(struct person_delta* self);
+
+/********************************************************************************
+* person_delta_track: Registrerar angivet objekt för spårning, så att det
+*                     exporteras via person_delta_print_tracked samt
+*                     person_delta_write_tracked_stream när det har ändrats.
+*                     Objektet räknas som ändrat direkt efter registreringen.
+*                     Enbart objekt med generationsspårning kan registreras,
+*                     och ett objekt kan enbart spåras av en person_delta åt
+*                     gången. Vid lyckad registrering returneras 0, annars 1.
+*
+*                     - self  : Pekare till aktuell person_delta.
+*                     - person: Pekare till objektet som ska spåras.
+********************************************************************************/
+int person_delta_track(struct person_delta* self,
+                       struct person* person);
+
+/********************************************************************************
+* person_delta_untrack: Avregistrerar angivet objekt från spårning. Objektet
+*                       avregistreras även automatiskt när det nollställs.
+*
+*                       - self  : Pekare till aktuell person_delta.
+*                       - person: Pekare till objektet som inte längre ska spåras.
+********************************************************************************/
+void person_delta_untrack(struct person_delta* self,
+                          struct person* person);
+
+/********************************************************************************
+* person_delta_pending: Returnerar antalet spårade objekt som har ändrats
+*                       sedan senaste export.
+*
+*                       - self: Pekare till aktuell person_delta.
+********************************************************************************/
+size_t person_delta_pending(struct person_delta* self);
+
+/********************************************************************************
+* person_delta_print: Skriver ändrade objekt i angiven array via angiven
+*                     utström i samma format som person_print. Vid lyckad
+*                     export returneras 0 och nästa export omfattar enbart
+*                     objekt som ändras därefter, annars returneras 1.
+*
+*                     - self   : Pekare till aktuell person_delta.
+*                     - persons: Array innehållande pekare till objekten.
+*                     - count  : Antal objekt i arrayen.
+*                     - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+int person_delta_print(struct person_delta* self,
+                       const struct person* const* persons,
+                       const size_t count,
+                       FILE* ostream);
+
+/********************************************************************************
+* person_delta_write_stream: Skriver ändrade objekt i angiven array till
+*                            angiven utström i det binära formatet i
+*                            person_file.h. Vid lyckad export returneras 0
+*                            och nästa export omfattar enbart objekt som
+*                            ändras därefter, annars returneras 1.
+*
+*                            - self   : Pekare till aktuell person_delta.
+*                            - persons: Array innehållande pekare till objekten.
+*                            - count  : Antal objekt i arrayen.
+*                            - ostream: Pekare till utströmmen.
+********************************************************************************/
+int person_delta_write_stream(struct person_delta* self,
+                              const struct person* const* persons,
+                              const size_t count,
+                              FILE* ostream);
+
+/********************************************************************************
+* person_delta_write: Skriver ändrade objekt i angiven array till en fil på
+*                     angiven sökväg i det binära formatet i person_file.h.
+*                     Vid lyckad export returneras 0, annars returneras 1.
+*
+*                     - self   : Pekare till aktuell person_delta.
+*                     - persons: Array innehållande pekare till objekten.
+*                     - count  : Antal objekt i arrayen.
+*                     - path   : Sökväg till filen som ska skrivas.
+********************************************************************************/
+int person_delta_write(struct person_delta* self,
+                       const struct person* const* persons,
+                       const size_t count,
+                       const char* path);
+
+/********************************************************************************
+* person_delta_print_tracked: Skriver samtliga spårade objekt som har ändrats
+*                             sedan senaste export via angiven utström i
+*                             samma format som person_print. Vid lyckad export
+*                             returneras 0 och listan över ändrade objekt
+*                             töms, annars returneras 1.
+*
+*                             - self   : Pekare till aktuell person_delta.
+*                             - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+int person_delta_print_tracked(struct person_delta* self,
+                               FILE* ostream);
+
+/********************************************************************************
+* person_delta_write_tracked_stream: Skriver samtliga spårade objekt som har
+*                                    ändrats sedan senaste export till angiven
+*                                    utström i det binära formatet i
+*                                    person_file.h. Vid lyckad export
+*                                    returneras 0 och listan över ändrade
+*                                    objekt töms, annars returneras 1.
+*
+*                                    - self   : Pekare till aktuell person_delta.
+*                                    - ostream: Pekare till utströmmen.
+********************************************************************************/
+int person_delta_write_tracked_stream(struct person_delta* self,
+                                      FILE* ostream);
+
+#endif /* PERSON_DELTA_H_ */
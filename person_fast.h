@@ -0,0 +1,103 @@
+/********************************************************************************
+* person_fast.h: Innehåller inline-definierade accessorer för person-objekt
+*                initierade via person_init (eller person_init_with,
+*                person_new med flera). Accessorerna läser persondatan direkt
+*                via objektets mem-pekare istället för via ett indirekt anrop
+*                via person_vtable, vilket gör att kompilatorn kan inline-
+*                expandera dem i tidskritiska loopar. De får endast användas
+*                när objektets konkreta typ är känd, dvs. inte för vyer som
+*                exempelvis person_store_view.
+*
+*                Makrona PERSON_NAME, PERSON_AGE med flera anropar accessorerna
+*                via objektets vtable som default. Om makrot PERSON_DEVIRTUALIZE
+*                är definierat innan denna fil inkluderas så anropas istället
+*                de inline-definierade accessorerna, vilket gör det möjligt
+*                att växla mellan polymorf och direkt åtkomst vid kompilering.
+********************************************************************************/
+#ifndef PERSON_FAST_H_
+#define PERSON_FAST_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+#include "person_mem.h"
+
+/********************************************************************************
+* person_fast_name: Returnerar personens namn utan anrop via vtable.
+*
+*                   - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+static inline const char* person_fast_name(const struct person* self)
+{
+   return self->mem->name;
+}
+
+/********************************************************************************
+* person_fast_age: Returnerar personens ålder utan anrop via vtable.
+*
+*                  - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+static inline unsigned int person_fast_age(const struct person* self)
+{
+   return self->mem->age;
+}
+
+/********************************************************************************
+* person_fast_address: Returnerar personens hemadress utan anrop via vtable.
+*
+*                      - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+static inline const char* person_fast_address(const struct person* self)
+{
+   return self->mem->address;
+}
+
+/********************************************************************************
+* person_fast_occupation: Returnerar personens yrke utan anrop via vtable.
+*
+*                         - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+static inline const char* person_fast_occupation(const struct person* self)
+{
+   return self->mem->occupation;
+}
+
+/********************************************************************************
+* person_fast_gender: Returnerar personens kön utan anrop via vtable.
+*
+*                     - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+static inline enum gender person_fast_gender(const struct person* self)
+{
+   return self->mem->gender;
+}
+
+/********************************************************************************
+* person_fast_gender_str: Returnerar personens kön på textform utan anrop via
+*                         vtable.
+*
+*                         - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+static inline const char* person_fast_gender_str(const struct person* self)
+{
+   static const char* names[] = { "Male", "Female", "Other", "Unspecified" };
+   const enum gender gender = self->mem->gender;
+   return gender <= GENDER_NONE ? names[gender] : names[GENDER_NONE];
+}
+
+#ifdef PERSON_DEVIRTUALIZE
+#define PERSON_NAME(self)       person_fast_name(self)
+#define PERSON_AGE(self)        person_fast_age(self)
+#define PERSON_ADDRESS(self)    person_fast_address(self)
+#define PERSON_OCCUPATION(self) person_fast_occupation(self)
+#define PERSON_GENDER(self)     person_fast_gender(self)
+#define PERSON_GENDER_STR(self) person_fast_gender_str(self)
+#else
+#define PERSON_NAME(self)       ((self)->vptr->name(self))
+#define PERSON_AGE(self)        ((self)->vptr->age(self))
+#define PERSON_ADDRESS(self)    ((self)->vptr->address(self))
+#define PERSON_OCCUPATION(self) ((self)->vptr->occupation(self))
+#define PERSON_GENDER(self)     ((self)->vptr->gender(self))
+#define PERSON_GENDER_STR(self) ((self)->vptr->gender_str(self))
+#endif /* PERSON_DEVIRTUALIZE */
+
+#endif /* PERSON_FAST_H_ */
@@ -0,0 +1,450 @@
+/********************************************************************************
+* person_file.c: Innehåller definitioner av associerade funktioner tillhörande
+*                strukten person_file, som används för lagring samt
+*                minnesmappad inläsning av persondata i binärt format.
+********************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "person_file.h"
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Statiska funktioner: */
+static const struct person_vtable* person_file_vtable_ptr_new(void);
+static uint64_t person_file_align(const uint64_t offset);
+static int person_file_write_padding(FILE* ostream,
+                                     const uint64_t from,
+                                     const uint64_t to);
+static int person_file_write_offsets(FILE* ostream,
+                                     const size_t* offsets,
+                                     const size_t count);
+static int person_file_section_valid(const struct person_file* self,
+                                     const uint64_t offset,
+                                     const uint64_t size);
+static const char* person_file_string(const struct person_file* self,
+                                      const uint64_t offset);
+static const char* person_file_view_name(const struct person* self);
+static unsigned int person_file_view_age(const struct person* self);
+static const char* person_file_view_address(const struct person* self);
+static const char* person_file_view_occupation(const struct person* self);
+static enum gender person_file_view_gender(const struct person* self);
+static const char* person_file_view_gender_str(const struct person* self);
+static void person_file_view_clear(struct person* self);
+
+/********************************************************************************
+* person_file_write: Skriver samtliga poster i angiven person_store till en fil
+*                    på angiven sökväg. Vid lyckad skrivning returneras 0,
+*                    annars returneras 1.
+*
+*                    - store: Pekare till aktuell person_store.
+*                    - path : Sökväg till filen som ska skrivas.
+********************************************************************************/
+int person_file_write(const struct person_store* store,
+                      const char* path)
+{
+   FILE* ostream = fopen(path, "wb");
+   if (!ostream) return 1;
+   const int error = person_file_write_stream(store, ostream);
+   return fclose(ostream) || error;
+}
+
+/********************************************************************************
+* person_file_write_stream: Skriver samtliga poster i angiven person_store
+*                           till angiven utström. Vid lyckad skrivning
+*                           returneras 0, annars returneras 1.
+*
+*                           - store  : Pekare till aktuell person_store.
+*                           - ostream: Pekare till utströmmen.
+********************************************************************************/
+int person_file_write_stream(const struct person_store* store,
+                             FILE* ostream)
+{
+   const uint64_t count = store->size;
+   struct person_file_header header;
+
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, PERSON_FILE_MAGIC, sizeof(header.magic));
+   header.version = PERSON_FILE_VERSION;
+   header.count = count;
+   header.ages = sizeof(header);
+   header.genders = person_file_align(header.ages + count * sizeof(uint32_t));
+   header.names = person_file_align(header.genders + count * sizeof(uint8_t));
+   header.addresses = header.names + count * sizeof(uint64_t);
+   header.occupations = header.addresses + count * sizeof(uint64_t);
+   header.heap = header.occupations + count * sizeof(uint64_t);
+   header.heap_size = store->strings_size;
+
+   if (fwrite(&header, sizeof(header), 1, ostream) != 1) return 1;
+
+   for (size_t i = 0; i < store->size; i += 1024)
+   {
+      uint32_t ages[1024];
+      const size_t n = store->size - i < 1024 ? store->size - i : 1024;
+      for (size_t j = 0; j < n; ++j)
+      {
+         ages[j] = store->ages[i + j];
+      }
+      if (fwrite(ages, sizeof(uint32_t), n, ostream) != n) return 1;
+   }
+
+   if (person_file_write_padding(ostream, header.ages + count * sizeof(uint32_t), header.genders) ||
+       (store->size && fwrite(store->genders, 1, store->size, ostream) != store->size) ||
+       person_file_write_padding(ostream, header.genders + count, header.names) ||
+       person_file_write_offsets(ostream, store->names, store->size) ||
+       person_file_write_offsets(ostream, store->addresses, store->size) ||
+       person_file_write_offsets(ostream, store->occupations, store->size) ||
+       (store->strings_size &&
+        fwrite(store->strings, 1, store->strings_size, ostream) != store->strings_size))
+   {
+      return 1;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_file_open: Mappar filen på angiven sökväg till minnet och validerar
+*                   dess huvud. Vid lyckad inläsning returneras 0, annars 1.
+*
+*                   - self: Pekare till objektet som ska lagra filen.
+*                   - path: Sökväg till filen som ska läsas in.
+********************************************************************************/
+int person_file_open(struct person_file* self,
+                     const char* path)
+{
+   struct stat info;
+   memset(self, 0, sizeof(*self));
+
+   const int fd = open(path, O_RDONLY);
+   if (fd < 0) return 1;
+
+   if (fstat(fd, &info) || (size_t)info.st_size < sizeof(struct person_file_header))
+   {
+      close(fd);
+      return 1;
+   }
+
+   void* data = mmap(0, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (data == MAP_FAILED) return 1;
+
+   self->data = data;
+   self->size = (size_t)info.st_size;
+
+   const struct person_file_header* header = (const struct person_file_header*)data;
+   const uint64_t count = header->count;
+
+   if (memcmp(header->magic, PERSON_FILE_MAGIC, sizeof(header->magic)) ||
+       header->version != PERSON_FILE_VERSION ||
+       count > self->size ||
+       !person_file_section_valid(self, header->ages, count * sizeof(uint32_t)) ||
+       !person_file_section_valid(self, header->genders, count) ||
+       !person_file_section_valid(self, header->names, count * sizeof(uint64_t)) ||
+       !person_file_section_valid(self, header->addresses, count * sizeof(uint64_t)) ||
+       !person_file_section_valid(self, header->occupations, count * sizeof(uint64_t)) ||
+       !person_file_section_valid(self, header->heap, header->heap_size) ||
+       (header->heap_size && ((const char*)data)[header->heap + header->heap_size - 1] != '\0'))
+   {
+      person_file_close(self);
+      return 1;
+   }
+
+   const char* base = (const char*)data;
+   self->count = (size_t)count;
+   self->ages = (const uint32_t*)(base + header->ages);
+   self->genders = (const uint8_t*)(base + header->genders);
+   self->names = (const uint64_t*)(base + header->names);
+   self->addresses = (const uint64_t*)(base + header->addresses);
+   self->occupations = (const uint64_t*)(base + header->occupations);
+   self->heap = base + header->heap;
+   self->heap_size = (size_t)header->heap_size;
+   return 0;
+}
+
+/********************************************************************************
+* person_file_close: Avmappar angiven fil och nollställer objektet. Samtliga
+*                    vyer och strängar hämtade från filen blir ogiltiga.
+*
+*                    - self: Pekare till aktuell person_file.
+********************************************************************************/
+void person_file_close(struct person_file* self)
+{
+   if (self->data) munmap(self->data, self->size);
+   memset(self, 0, sizeof(*self));
+   return;
+}
+
+/********************************************************************************
+* person_file_size: Returnerar antalet poster i angiven fil.
+*
+*                   - self: Pekare till aktuell person_file.
+********************************************************************************/
+size_t person_file_size(const struct person_file* self)
+{
+   return self->count;
+}
+
+/********************************************************************************
+* person_file_name: Returnerar namnet för posten på angivet index.
+*
+*                   - self : Pekare till aktuell person_file.
+*                   - index: Postens index.
+********************************************************************************/
+const char* person_file_name(const struct person_file* self,
+                             const size_t index)
+{
+   return person_file_string(self, self->names[index]);
+}
+
+/********************************************************************************
+* person_file_age: Returnerar åldern för posten på angivet index.
+*
+*                  - self : Pekare till aktuell person_file.
+*                  - index: Postens index.
+********************************************************************************/
+unsigned int person_file_age(const struct person_file* self,
+                             const size_t index)
+{
+   return self->ages[index];
+}
+
+/********************************************************************************
+* person_file_address: Returnerar hemadressen för posten på angivet index.
+*
+*                      - self : Pekare till aktuell person_file.
+*                      - index: Postens index.
+********************************************************************************/
+const char* person_file_address(const struct person_file* self,
+                                const size_t index)
+{
+   return person_file_string(self, self->addresses[index]);
+}
+
+/********************************************************************************
+* person_file_occupation: Returnerar yrket för posten på angivet index.
+*
+*                         - self : Pekare till aktuell person_file.
+*                         - index: Postens index.
+********************************************************************************/
+const char* person_file_occupation(const struct person_file* self,
+                                   const size_t index)
+{
+   return person_file_string(self, self->occupations[index]);
+}
+
+/********************************************************************************
+* person_file_gender: Returnerar könet för posten på angivet index.
+*
+*                     - self : Pekare till aktuell person_file.
+*                     - index: Postens index.
+********************************************************************************/
+enum gender person_file_gender(const struct person_file* self,
+                               const size_t index)
+{
+   const uint8_t gender = self->genders[index];
+   return gender <= GENDER_NONE ? (enum gender)gender : GENDER_NONE;
+}
+
+/********************************************************************************
+* person_file_view: Initierar en vy över posten på angivet index och returnerar
+*                   en pekare till vyns person-objekt.
+*
+*                   - self : Pekare till aktuell person_file.
+*                   - index: Postens index.
+*                   - view : Pekare till vyn som ska initieras.
+********************************************************************************/
+struct person* person_file_view(const struct person_file* self,
+                                const size_t index,
+                                struct person_file_view* view)
+{
+   view->base.mem = 0;
+   view->base.vptr = person_file_vtable_ptr_new();
+   view->file = self;
+   view->index = index;
+   return &view->base;
+}
+
+/********************************************************************************
+* person_file_vtable_ptr_new: Returnerar en pekare till ett statiskt vtable
+*                             för vyer över poster i en person_file.
+********************************************************************************/
+static const struct person_vtable* person_file_vtable_ptr_new(void)
+{
+   static const struct person_vtable self =
+   {
+      .print = &person_print,
+      .gender_str = &person_file_view_gender_str,
+      .name = &person_file_view_name,
+      .age = &person_file_view_age,
+      .address = &person_file_view_address,
+      .occupation = &person_file_view_occupation,
+      .gender = &person_file_view_gender,
+      .clear = &person_file_view_clear
+   };
+
+   return &self;
+}
+
+/********************************************************************************
+* person_file_align: Avrundar angivet offset uppåt till närmaste multipel av 8.
+*
+*                    - offset: Offsetet som ska avrundas.
+********************************************************************************/
+static uint64_t person_file_align(const uint64_t offset)
+{
+   return (offset + 7) & ~(uint64_t)7;
+}
+
+/********************************************************************************
+* person_file_write_padding: Skriver nollor från offset from till offset to.
+*                            Vid lyckad skrivning returneras 0, annars 1.
+*
+*                            - ostream: Pekare till utströmmen.
+*                            - from   : Aktuellt offset.
+*                            - to     : Offset som ska nås.
+********************************************************************************/
+static int person_file_write_padding(FILE* ostream,
+                                     const uint64_t from,
+                                     const uint64_t to)
+{
+   static const char zeros[8] = { 0 };
+   const size_t length = (size_t)(to - from);
+   return fwrite(zeros, 1, length, ostream) != length;
+}
+
+/********************************************************************************
+* person_file_write_offsets: Skriver angivna strängoffset som uint64_t. Vid
+*                            lyckad skrivning returneras 0, annars 1.
+*
+*                            - ostream: Pekare till utströmmen.
+*                            - offsets: Array innehållande offseten.
+*                            - count  : Antal offset i arrayen.
+********************************************************************************/
+static int person_file_write_offsets(FILE* ostream,
+                                     const size_t* offsets,
+                                     const size_t count)
+{
+   uint64_t buffer[1024];
+
+   for (size_t i = 0; i < count; i += 1024)
+   {
+      const size_t n = count - i < 1024 ? count - i : 1024;
+      for (size_t j = 0; j < n; ++j)
+      {
+         buffer[j] = offsets[i + j];
+      }
+      if (fwrite(buffer, sizeof(uint64_t), n, ostream) != n) return 1;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_file_section_valid: Indikerar ifall en sektion med angivet offset och
+*                            storlek ryms i filen samt är korrekt justerad.
+*
+*                            - self  : Pekare till aktuell person_file.
+*                            - offset: Sektionens offset från filens början.
+*                            - size  : Sektionens storlek i bytes.
+********************************************************************************/
+static int person_file_section_valid(const struct person_file* self,
+                                     const uint64_t offset,
+                                     const uint64_t size)
+{
+   return offset % 8 == 0 && offset <= self->size && size <= self->size - offset;
+}
+
+/********************************************************************************
+* person_file_string: Returnerar en pekare till strängen på angivet offset i
+*                     strängheapen. Ett ogiltigt offset ger en tom sträng.
+*
+*                     - self  : Pekare till aktuell person_file.
+*                     - offset: Strängens offset i strängheapen.
+********************************************************************************/
+static const char* person_file_string(const struct person_file* self,
+                                      const uint64_t offset)
+{
+   return offset < self->heap_size ? self->heap + offset : "";
+}
+
+/********************************************************************************
+* person_file_view_name: Returnerar namnet för posten som vyn refererar till.
+*
+*                        - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_file_view_name(const struct person* self)
+{
+   const struct person_file_view* view = (const struct person_file_view*)self;
+   return person_file_name(view->file, view->index);
+}
+
+/********************************************************************************
+* person_file_view_age: Returnerar åldern för posten som vyn refererar till.
+*
+*                       - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static unsigned int person_file_view_age(const struct person* self)
+{
+   const struct person_file_view* view = (const struct person_file_view*)self;
+   return person_file_age(view->file, view->index);
+}
+
+/********************************************************************************
+* person_file_view_address: Returnerar hemadressen för posten som vyn
+*                           refererar till.
+*
+*                           - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_file_view_address(const struct person* self)
+{
+   const struct person_file_view* view = (const struct person_file_view*)self;
+   return person_file_address(view->file, view->index);
+}
+
+/********************************************************************************
+* person_file_view_occupation: Returnerar yrket för posten som vyn refererar
+*                              till.
+*
+*                              - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_file_view_occupation(const struct person* self)
+{
+   const struct person_file_view* view = (const struct person_file_view*)self;
+   return person_file_occupation(view->file, view->index);
+}
+
+/********************************************************************************
+* person_file_view_gender: Returnerar könet för posten som vyn refererar till.
+*
+*                          - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static enum gender person_file_view_gender(const struct person* self)
+{
+   const struct person_file_view* view = (const struct person_file_view*)self;
+   return person_file_gender(view->file, view->index);
+}
+
+/********************************************************************************
+* person_file_view_gender_str: Returnerar könet för posten som vyn refererar
+*                              till på textform.
+*
+*                              - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_file_view_gender_str(const struct person* self)
+{
+   return gender_str(person_file_view_gender(self));
+}
+
+/********************************************************************************
+* person_file_view_clear: Nollställer vyn. Den underliggande filen påverkas inte.
+*
+*                         - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static void person_file_view_clear(struct person* self)
+{
+   struct person_file_view* view = (struct person_file_view*)self;
+   view->base.vptr = 0;
+   view->file = 0;
+   view->index = 0;
+   return;
+}
@@ -0,0 +1,185 @@
+/********************************************************************************
+* person_file.h: Innehåller funktionalitet för lagring av persondata i ett
+*                kompakt binärt filformat samt för inläsning av sådana filer
+*                via minnesmappning (mmap). Vid inläsning sker ingen tolkning
+*                eller kopiering av data, utan returnerade strängar pekar
+*                direkt in i den mappade filen.
+*
+*                Filformat (version 1, samtliga heltal i värdens byteordning):
+*                - Huvud om 80 bytes, se strukten person_file_header.
+*                - Åldrar som uint32_t, en per post.
+*                - Kön som uint8_t, en per post.
+*                - Offset för namn, hemadress och yrke som uint64_t, en
+*                  tabell per fält, relativt strängheapens början.
+*                - Strängheap med nollterminerade strängar.
+*                Samtliga sektioner börjar på en adress som är jämnt delbar
+*                med 8.
+********************************************************************************/
+#ifndef PERSON_FILE_H_
+#define PERSON_FILE_H_
+
+/* Inkluderingsdirektiv: */
+#include "person_store.h"
+#include <stdint.h>
+
+/* Magiskt värde i början av varje fil. */
+#define PERSON_FILE_MAGIC "PERSONDB"
+
+/* Aktuell version av filformatet. */
+#define PERSON_FILE_VERSION 1
+
+/********************************************************************************
+* person_file_header: Filhuvud med fast storlek. Samtliga offset anges i bytes
+*                     från filens början.
+********************************************************************************/
+typedef struct person_file_header
+{
+   char magic[8];        /* Magiskt värde, PERSON_FILE_MAGIC. */
+   uint32_t version;     /* Filformatets version. */
+   uint32_t flags;       /* Reserverat för framtida bruk, ska vara 0. */
+   uint64_t count;       /* Antal poster i filen. */
+   uint64_t ages;        /* Offset till åldrarna. */
+   uint64_t genders;     /* Offset till könen. */
+   uint64_t names;       /* Offset till tabellen med namn. */
+   uint64_t addresses;   /* Offset till tabellen med hemadresser. */
+   uint64_t occupations; /* Offset till tabellen med yrken. */
+   uint64_t heap;        /* Offset till strängheapen. */
+   uint64_t heap_size;   /* Strängheapens storlek i bytes. */
+} person_file_header_t;
+
+/********************************************************************************
+* person_file: Strukt för en inläst (minnesmappad) personfil.
+********************************************************************************/
+typedef struct person_file
+{
+   void* data;                  /* Pekare till den mappade filen. */
+   size_t size;                 /* Filens storlek i bytes. */
+   size_t count;                /* Antal poster i filen. */
+   const uint32_t* ages;        /* Pekare till åldrarna. */
+   const uint8_t* genders;      /* Pekare till könen. */
+   const uint64_t* names;       /* Pekare till tabellen med namn. */
+   const uint64_t* addresses;   /* Pekare till tabellen med hemadresser. */
+   const uint64_t* occupations; /* Pekare till tabellen med yrken. */
+   const char* heap;            /* Pekare till strängheapen. */
+   size_t heap_size;            /* Strängheapens storlek i bytes. */
+} person_file_t, *person_file_ptr_t;
+
+/********************************************************************************
+* person_file_view: Vy över en enskild post i en person_file. Vyn innehåller
+*                   ett person-objekt som första medlem och kan därmed användas
+*                   som ett vanligt person-objekt. Returnerade strängar pekar
+*                   direkt in i den mappade filen och är giltiga tills
+*                   person_file_close anropas.
+********************************************************************************/
+typedef struct person_file_view
+{
+   struct person base;             /* Basobjekt, används vid anrop via vtable. */
+   const struct person_file* file; /* Pekare till tillhörande person_file. */
+   size_t index;                   /* Postens index i filen. */
+} person_file_view_t, *person_file_view_ptr_t;
+
+/********************************************************************************
+* person_file_write: Skriver samtliga poster i angiven person_store till en fil
+*                    på angiven sökväg. Vid lyckad skrivning returneras 0,
+*                    annars returneras 1.
+*
+*                    - store: Pekare till aktuell person_store.
+*                    - path : Sökväg till filen som ska skrivas.
+********************************************************************************/
+int person_file_write(const struct person_store* store,
+                      const char* path);
+
+/********************************************************************************
+* person_file_write_stream: Skriver samtliga poster i angiven person_store
+*                           till angiven utström. Vid lyckad skrivning
+*                           returneras 0, annars returneras 1.
+*
+*                           - store  : Pekare till aktuell person_store.
+*                           - ostream: Pekare till utströmmen.
+********************************************************************************/
+int person_file_write_stream(const struct person_store* store,
+                             FILE* ostream);
+
+/********************************************************************************
+* person_file_open: Mappar filen på angiven sökväg till minnet och validerar
+*                   dess huvud. Vid lyckad inläsning returneras 0, annars 1.
+*
+*                   - self: Pekare till objektet som ska lagra filen.
+*                   - path: Sökväg till filen som ska läsas in.
+********************************************************************************/
+int person_file_open(struct person_file* self,
+                     const char* path);
+
+/********************************************************************************
+* person_file_close: Avmappar angiven fil och nollställer objektet. Samtliga
+*                    vyer och strängar hämtade från filen blir ogiltiga.
+*
+*                    - self: Pekare till aktuell person_file.
+********************************************************************************/
+void person_file_close(struct person_file* self);
+
+/********************************************************************************
+* person_file_size: Returnerar antalet poster i angiven fil.
+*
+*                   - self: Pekare till aktuell person_file.
+********************************************************************************/
+size_t person_file_size(const struct person_file* self);
+
+/********************************************************************************
+* person_file_name: Returnerar namnet för posten på angivet index.
+*
+*                   - self : Pekare till aktuell person_file.
+*                   - index: Postens index.
+********************************************************************************/
+const char* person_file_name(const struct person_file* self,
+                             const size_t index);
+
+/********************************************************************************
+* person_file_age: Returnerar åldern för posten på angivet index.
+*
+*                  - self : Pekare till aktuell person_file.
+*                  - index: Postens index.
+********************************************************************************/
+unsigned int person_file_age(const struct person_file* self,
+                             const size_t index);
+
+/********************************************************************************
+* person_file_address: Returnerar hemadressen för posten på angivet index.
+*
+*                      - self : Pekare till aktuell person_file.
+*                      - index: Postens index.
+********************************************************************************/
+const char* person_file_address(const struct person_file* self,
+                                const size_t index);
+
+/********************************************************************************
+* person_file_occupation: Returnerar yrket för posten på angivet index.
+*
+*                         - self : Pekare till aktuell person_file.
+*                         - index: Postens index.
+********************************************************************************/
+const char* person_file_occupation(const struct person_file* self,
+                                   const size_t index);
+
+/********************************************************************************
+* person_file_gender: Returnerar könet för posten på angivet index.
+*
+*                     - self : Pekare till aktuell person_file.
+*                     - index: Postens index.
+********************************************************************************/
+enum gender person_file_gender(const struct person_file* self,
+                               const size_t index);
+
+/********************************************************************************
+* person_file_view: Initierar en vy över posten på angivet index och returnerar
+*                   en pekare till vyns person-objekt.
+*
+*                   - self : Pekare till aktuell person_file.
+*                   - index: Postens index.
+*                   - view : Pekare till vyn som ska initieras.
+********************************************************************************/
+struct person* person_file_view(const struct person_file* self,
+                                const size_t index,
+                                struct person_file_view* view);
+
+#endif /* PERSON_FILE_H_ */
@@ -0,0 +1,387 @@
+/********************************************************************************
+* person_filter.c: Innehåller definitioner av associerade funktioner
+*                  tillhörande strukten person_filter samt de skalära och
+*                  vektoriserade filterkärnorna.
+********************************************************************************/
+#include "person_filter.h"
+#include <pthread.h>
+
+/* Indikerar ifall vektoriserade x86-kärnor kan kompileras. */
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define PERSON_FILTER_X86 1
+#include <immintrin.h>
+#else
+#define PERSON_FILTER_X86 0
+#endif
+
+/********************************************************************************
+* person_filter_kernel_t: Funktionspekare till en filterkärna, som filtrerar
+*                         64 poster per ord i bitmappen.
+*
+*                         - self   : Pekare till aktuellt filter.
+*                         - ages   : Pekare till första åldern.
+*                         - genders: Pekare till första könet.
+*                         - words  : Antal ord att beräkna (64 poster per ord).
+*                         - bitmap : Bitmapp där resultatet lagras.
+********************************************************************************/
+typedef void (*person_filter_kernel_t)(const struct person_filter* self,
+                                       const unsigned int* ages,
+                                       const unsigned char* genders,
+                                       const size_t words,
+                                       uint64_t* bitmap);
+
+/* Vald kärna samt dess namn, bestäms en gång via person_filter_kernel_select. */
+static pthread_once_t person_filter_kernel_once = PTHREAD_ONCE_INIT;
+static person_filter_kernel_t person_filter_kernel_selected;
+static const char* person_filter_kernel_selected_name;
+
+/* Statiska funktioner: */
+static person_filter_kernel_t person_filter_kernel(const char** name);
+static void person_filter_kernel_select(void);
+static void person_filter_scalar(const struct person_filter* self,
+                                 const unsigned int* ages,
+                                 const unsigned char* genders,
+                                 const size_t count,
+                                 uint64_t* word);
+static void person_filter_kernel_scalar(const struct person_filter* self,
+                                        const unsigned int* ages,
+                                        const unsigned char* genders,
+                                        const size_t words,
+                                        uint64_t* bitmap);
+#if PERSON_FILTER_X86
+static void person_filter_kernel_sse2(const struct person_filter* self,
+                                      const unsigned int* ages,
+                                      const unsigned char* genders,
+                                      const size_t words,
+                                      uint64_t* bitmap);
+static void person_filter_kernel_avx2(const struct person_filter* self,
+                                      const unsigned int* ages,
+                                      const unsigned char* genders,
+                                      const size_t words,
+                                      uint64_t* bitmap);
+#endif /* PERSON_FILTER_X86 */
+
+/********************************************************************************
+* person_filter_words: Returnerar antalet 64-bitars ord som krävs för en
+*                      bitmapp över angivet antal poster.
+*
+*                      - count: Antal poster.
+********************************************************************************/
+size_t person_filter_words(const size_t count)
+{
+   return (count + 63) / 64;
+}
+
+/********************************************************************************
+* person_filter_bitmap: Kör angivet filter över samtliga poster i angiven
+*                       person_store och lagrar resultatet i angiven bitmapp,
+*                       där bit i % 64 i ord i / 64 är ettställd om post i
+*                       matchar. Bitmappen måste rymma
+*                       person_filter_words(person_store_size(store)) ord.
+*
+*                       - self  : Pekare till aktuellt filter.
+*                       - store : Pekare till aktuell person_store.
+*                       - bitmap: Bitmapp där resultatet lagras.
+********************************************************************************/
+void person_filter_bitmap(const struct person_filter* self,
+                          const struct person_store* store,
+                          uint64_t* bitmap)
+{
+   const size_t words = store->size / 64;
+   const size_t rest = store->size % 64;
+
+   if (self->min_age > self->max_age || !(self->genders & PERSON_FILTER_ANY_GENDER))
+   {
+      for (size_t i = 0; i < person_filter_words(store->size); ++i)
+      {
+         bitmap[i] = 0;
+      }
+      return;
+   }
+
+   person_filter_kernel(0)(self, store->ages, store->genders, words, bitmap);
+
+   if (rest)
+   {
+      person_filter_scalar(self, store->ages + words * 64, store->genders + words * 64,
+                           rest, bitmap + words);
+   }
+   return;
+}
+
+/********************************************************************************
+* person_filter_indices: Kör angivet filter över samtliga poster i angiven
+*                        person_store, lagrar index för matchande poster i
+*                        angiven array och returnerar antalet träffar. Arrayen
+*                        måste rymma minst person_store_size(store) element.
+*                        Om minnesallokeringen misslyckas returneras 0.
+*
+*                        - self   : Pekare till aktuellt filter.
+*                        - store  : Pekare till aktuell person_store.
+*                        - indices: Array där index för träffarna lagras.
+********************************************************************************/
+size_t person_filter_indices(const struct person_filter* self,
+                             const struct person_store* store,
+                             size_t* indices)
+{
+   uint64_t* bitmap = (uint64_t*)malloc((person_filter_words(store->size) + 1) * sizeof(uint64_t));
+   if (!bitmap) return 0;
+
+   person_filter_bitmap(self, store, bitmap);
+   const size_t count = person_filter_bitmap_indices(bitmap, store->size, indices);
+   free(bitmap);
+   return count;
+}
+
+/********************************************************************************
+* person_filter_bitmap_indices: Lagrar index för samtliga ettställda bitar i
+*                               angiven bitmapp i angiven array och returnerar
+*                               antalet index.
+*
+*                               - bitmap : Bitmapp att läsa.
+*                               - count  : Antal poster som bitmappen omfattar.
+*                               - indices: Array där indexen lagras.
+********************************************************************************/
+size_t person_filter_bitmap_indices(const uint64_t* bitmap,
+                                    const size_t count,
+                                    size_t* indices)
+{
+   size_t size = 0;
+
+   for (size_t i = 0; i < person_filter_words(count); ++i)
+   {
+      uint64_t word = bitmap[i];
+
+      while (word)
+      {
+         indices[size++] = i * 64 + (size_t)__builtin_ctzll(word);
+         word &= word - 1;
+      }
+   }
+   return size;
+}
+
+/********************************************************************************
+* person_filter_bitmap_count: Returnerar antalet ettställda bitar i angiven
+*                             bitmapp.
+*
+*                             - bitmap: Bitmapp att läsa.
+*                             - count : Antal poster som bitmappen omfattar.
+********************************************************************************/
+size_t person_filter_bitmap_count(const uint64_t* bitmap,
+                                  const size_t count)
+{
+   size_t size = 0;
+
+   for (size_t i = 0; i < person_filter_words(count); ++i)
+   {
+      size += (size_t)__builtin_popcountll(bitmap[i]);
+   }
+   return size;
+}
+
+/********************************************************************************
+* person_filter_kernel_name: Returnerar namnet på den kärna som används på
+*                            aktuell processor ("avx2", "sse2" eller "scalar").
+********************************************************************************/
+const char* person_filter_kernel_name(void)
+{
+   const char* name;
+   person_filter_kernel(&name);
+   return name;
+}
+
+/********************************************************************************
+* person_filter_kernel: Returnerar den snabbaste kärnan som stöds av aktuell
+*                       processor och lagrar dess namn på angiven adress.
+*                       Kärnan väljs vid första anropet, varefter samma
+*                       kärna returneras utan ny detektering.
+*
+*                       - name: Adress där kärnans namn lagras (eller null).
+********************************************************************************/
+static person_filter_kernel_t person_filter_kernel(const char** name)
+{
+   pthread_once(&person_filter_kernel_once, &person_filter_kernel_select);
+   if (name) *name = person_filter_kernel_selected_name;
+   return person_filter_kernel_selected;
+}
+
+/********************************************************************************
+* person_filter_kernel_select: Detekterar processorns stöd för
+*                              vektorinstruktioner och väljer den snabbaste
+*                              kärnan. Anropas en gång via pthread_once.
+********************************************************************************/
+static void person_filter_kernel_select(void)
+{
+#if PERSON_FILTER_X86
+   __builtin_cpu_init();
+
+   if (__builtin_cpu_supports("avx2"))
+   {
+      person_filter_kernel_selected_name = "avx2";
+      person_filter_kernel_selected = &person_filter_kernel_avx2;
+      return;
+   }
+   if (__builtin_cpu_supports("sse2"))
+   {
+      person_filter_kernel_selected_name = "sse2";
+      person_filter_kernel_selected = &person_filter_kernel_sse2;
+      return;
+   }
+#endif /* PERSON_FILTER_X86 */
+
+   person_filter_kernel_selected_name = "scalar";
+   person_filter_kernel_selected = &person_filter_kernel_scalar;
+   return;
+}
+
+/********************************************************************************
+* person_filter_scalar: Filtrerar upp till 64 poster utan villkorliga hopp och
+*                       lagrar resultatet i angivet ord.
+*
+*                       - self   : Pekare till aktuellt filter.
+*                       - ages   : Pekare till första åldern.
+*                       - genders: Pekare till första könet.
+*                       - count  : Antal poster att filtrera (högst 64).
+*                       - word   : Ord där resultatet lagras.
+********************************************************************************/
+static void person_filter_scalar(const struct person_filter* self,
+                                 const unsigned int* ages,
+                                 const unsigned char* genders,
+                                 const size_t count,
+                                 uint64_t* word)
+{
+   const unsigned int range = self->max_age - self->min_age;
+   const unsigned int mask = self->genders & PERSON_FILTER_ANY_GENDER;
+   uint64_t result = 0;
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      const unsigned int gender = genders[i];
+      const uint64_t match = (ages[i] - self->min_age <= range) &
+         (gender <= GENDER_NONE) & (mask >> (gender & 3));
+      result |= (match & 1) << i;
+   }
+
+   *word = result;
+   return;
+}
+
+/********************************************************************************
+* person_filter_kernel_scalar: Skalär kärna som används när processorn saknar
+*                              stöd för vektorinstruktioner.
+********************************************************************************/
+static void person_filter_kernel_scalar(const struct person_filter* self,
+                                        const unsigned int* ages,
+                                        const unsigned char* genders,
+                                        const size_t words,
+                                        uint64_t* bitmap)
+{
+   for (size_t i = 0; i < words; ++i)
+   {
+      person_filter_scalar(self, ages + i * 64, genders + i * 64, 64, bitmap + i);
+   }
+   return;
+}
+
+#if PERSON_FILTER_X86
+
+/********************************************************************************
+* person_filter_kernel_sse2: SSE2-kärna som filtrerar 16 poster per iteration.
+*                            Åldrarna jämförs osignerat genom att teckenbiten
+*                            inverteras före en signerad jämförelse.
+********************************************************************************/
+static void person_filter_kernel_sse2(const struct person_filter* self,
+                                      const unsigned int* ages,
+                                      const unsigned char* genders,
+                                      const size_t words,
+                                      uint64_t* bitmap)
+{
+   const __m128i min_age = _mm_set1_epi32((int)self->min_age);
+   const __m128i sign = _mm_set1_epi32((int)0x80000000u);
+   const __m128i range = _mm_set1_epi32((int)((self->max_age - self->min_age) ^ 0x80000000u));
+   const unsigned int mask = self->genders;
+
+   for (size_t i = 0; i < words; ++i)
+   {
+      uint64_t word = 0;
+
+      for (size_t j = 0; j < 64; j += 16)
+      {
+         const unsigned int* a = ages + i * 64 + j;
+         unsigned int age_bits = 0;
+
+         for (size_t k = 0; k < 4; ++k)
+         {
+            const __m128i delta = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(a + k * 4)), min_age);
+            const __m128i above = _mm_cmpgt_epi32(_mm_xor_si128(delta, sign), range);
+            age_bits |= (unsigned int)(~_mm_movemask_ps(_mm_castsi128_ps(above)) & 0xF) << (k * 4);
+         }
+
+         const __m128i g = _mm_loadu_si128((const __m128i*)(genders + i * 64 + j));
+         __m128i accepted = _mm_setzero_si128();
+
+         for (int k = 0; k <= GENDER_NONE; ++k)
+         {
+            if (mask & (1u << k)) accepted = _mm_or_si128(accepted, _mm_cmpeq_epi8(g, _mm_set1_epi8((char)k)));
+         }
+
+         const unsigned int gender_bits = (unsigned int)_mm_movemask_epi8(accepted);
+         word |= (uint64_t)(age_bits & gender_bits) << j;
+      }
+
+      bitmap[i] = word;
+   }
+   return;
+}
+
+/********************************************************************************
+* person_filter_kernel_avx2: AVX2-kärna som filtrerar 32 poster per iteration.
+*                            Osignerad jämförelse sker via min(delta, range) ==
+*                            delta, dvs. delta <= range.
+********************************************************************************/
+__attribute__((target("avx2")))
+static void person_filter_kernel_avx2(const struct person_filter* self,
+                                      const unsigned int* ages,
+                                      const unsigned char* genders,
+                                      const size_t words,
+                                      uint64_t* bitmap)
+{
+   const __m256i min_age = _mm256_set1_epi32((int)self->min_age);
+   const __m256i range = _mm256_set1_epi32((int)(self->max_age - self->min_age));
+   const unsigned int mask = self->genders;
+
+   for (size_t i = 0; i < words; ++i)
+   {
+      uint64_t word = 0;
+
+      for (size_t j = 0; j < 64; j += 32)
+      {
+         const unsigned int* a = ages + i * 64 + j;
+         unsigned int age_bits = 0;
+
+         for (size_t k = 0; k < 4; ++k)
+         {
+            const __m256i delta = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(a + k * 8)), min_age);
+            const __m256i inside = _mm256_cmpeq_epi32(_mm256_min_epu32(delta, range), delta);
+            age_bits |= (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(inside)) << (k * 8);
+         }
+
+         const __m256i g = _mm256_loadu_si256((const __m256i*)(genders + i * 64 + j));
+         __m256i accepted = _mm256_setzero_si256();
+
+         for (int k = 0; k <= GENDER_NONE; ++k)
+         {
+            if (mask & (1u << k)) accepted = _mm256_or_si256(accepted, _mm256_cmpeq_epi8(g, _mm256_set1_epi8((char)k)));
+         }
+
+         const unsigned int gender_bits = (unsigned int)_mm256_movemask_epi8(accepted);
+         word |= (uint64_t)(age_bits & gender_bits) << j;
+      }
+
+      bitmap[i] = word;
+   }
+   return;
+}
+
+#endif /* PERSON_FILTER_X86 */
@@ -0,0 +1,102 @@
+/********************************************************************************
+* person_filter.h: Innehåller vektoriserade filter över åldrar samt kön i en
+*                  person_store via strukten person_filter. Filtret körs över
+*                  de sammanhängande kolumnerna utan villkorliga hopp per post
+*                  och resultatet lagras som en bitmapp med en bit per post.
+*                  På x86-processorer väljs en AVX2- eller SSE2-kärna vid
+*                  körning beroende på processorns stöd, annars används en
+*                  skalär kärna.
+********************************************************************************/
+#ifndef PERSON_FILTER_H_
+#define PERSON_FILTER_H_
+
+/* Inkluderingsdirektiv: */
+#include "person_store.h"
+#include <stdint.h>
+
+/* Bitmask som accepterar samtliga kön. */
+#define PERSON_FILTER_ANY_GENDER 0xFu
+
+/* Returnerar bitmasken för angivet kön, exempelvis PERSON_FILTER_GENDER(GENDER_FEMALE). */
+#define PERSON_FILTER_GENDER(gender) (1u << (gender))
+
+/********************************************************************************
+* person_filter: Strukt innehållande ett filter på ålder samt kön. En post
+*                matchar om dess ålder ligger inom [min_age, max_age] och dess
+*                kön finns med i bitmasken genders.
+********************************************************************************/
+typedef struct person_filter
+{
+   unsigned int min_age; /* Lägsta ålder som ska inkluderas. */
+   unsigned int max_age; /* Högsta ålder som ska inkluderas. */
+   unsigned int genders; /* Bitmask med accepterade kön, se PERSON_FILTER_GENDER. */
+} person_filter_t, *person_filter_ptr_t;
+
+/********************************************************************************
+* person_filter_words: Returnerar antalet 64-bitars ord som krävs för en
+*                      bitmapp över angivet antal poster.
+*
+*                      - count: Antal poster.
+********************************************************************************/
+size_t person_filter_words(const size_t count);
+
+/********************************************************************************
+* person_filter_bitmap: Kör angivet filter över samtliga poster i angiven
+*                       person_store och lagrar resultatet i angiven bitmapp,
+*                       där bit i % 64 i ord i / 64 är ettställd om post i
+*                       matchar. Bitmappen måste rymma
+*                       person_filter_words(person_store_size(store)) ord.
+*
+*                       - self  : Pekare till aktuellt filter.
+*                       - store : Pekare till aktuell person_store.
+*                       - bitmap: Bitmapp där resultatet lagras.
+********************************************************************************/
+void person_filter_bitmap(const struct person_filter* self,
+                          const struct person_store* store,
+                          uint64_t* bitmap);
+
+/********************************************************************************
+* person_filter_indices: Kör angivet filter över samtliga poster i angiven
+*                        person_store, lagrar index för matchande poster i
+*                        angiven array och returnerar antalet träffar. Arrayen
+*                        måste rymma minst person_store_size(store) element.
+*                        Om minnesallokeringen misslyckas returneras 0.
+*
+*                        - self   : Pekare till aktuellt filter.
+*                        - store  : Pekare till aktuell person_store.
+*                        - indices: Array där index för träffarna lagras.
+********************************************************************************/
+size_t person_filter_indices(const struct person_filter* self,
+                             const struct person_store* store,
+                             size_t* indices);
+
+/********************************************************************************
+* person_filter_bitmap_indices: Lagrar index för samtliga ettställda bitar i
+*                               angiven bitmapp i angiven array och returnerar
+*                               antalet index.
+*
+*                               - bitmap : Bitmapp att läsa.
+*                               - count  : Antal poster som bitmappen omfattar.
+*                               - indices: Array där indexen lagras.
+********************************************************************************/
+size_t person_filter_bitmap_indices(const uint64_t* bitmap,
+                                    const size_t count,
+                                    size_t* indices);
+
+/********************************************************************************
+* person_filter_bitmap_count: Returnerar antalet ettställda bitar i angiven
+*                             bitmapp.
+*
+*                             - bitmap: Bitmapp att läsa.
+*                             - count : Antal poster som bitmappen omfattar.
+********************************************************************************/
+size_t person_filter_bitmap_count(const uint64_t* bitmap,
+                                  const size_t count);
+
+/********************************************************************************
+* person_filter_kernel_name: Returnerar namnet på den kärna som används på
+*                            aktuell processor ("avx2", "sse2" eller "scalar").
+********************************************************************************/
+const char* person_filter_kernel_name(void);
+
+#endif /* PERSON_FILTER_H_ */
@@ -0,0 +1,446 @@
+/********************************************************************************
+* person_index.c: Innehåller definitioner av associerade funktioner tillhörande
+*                 strukten person_index, som används för sekundära index över
+*                 poster i en person_store.
+********************************************************************************/
+#include "person_index.h"
+#include "person_intern.h"
+#include <string.h>
+
+/* Markerar en borttagen plats i hashtabellen. */
+#define PERSON_INDEX_REMOVED ((size_t)-1)
+
+/********************************************************************************
+* person_index_slot: Plats i namnindexets hashtabell. Fältet index innehåller
+*                    postens index plus ett, 0 för en tom plats eller
+*                    PERSON_INDEX_REMOVED för en borttagen plats.
+********************************************************************************/
+struct person_index_slot
+{
+   uint64_t hash; /* Namnets hashvärde. */
+   size_t index;  /* Postens index plus ett. */
+};
+
+/* Statiska funktioner: */
+static int person_index_rehash(struct person_index* self,
+                               const size_t slot_count);
+static void person_index_slot_put(struct person_index* self,
+                                  const uint64_t hash,
+                                  const size_t index);
+static struct person_index_slot* person_index_slot_find(const struct person_index* self,
+                                                        const struct person_store* store,
+                                                        const size_t index);
+static size_t person_index_age_lower(const struct person_index* self,
+                                     const unsigned int age,
+                                     const size_t index);
+static int person_index_age_insert(struct person_index* self,
+                                   const unsigned int age,
+                                   const size_t index);
+static void person_index_age_erase(struct person_index* self,
+                                   const unsigned int age,
+                                   const size_t index);
+static int person_index_age_compare(const void* a,
+                                    const void* b);
+
+/********************************************************************************
+* person_index_init: Initierar ett nytt tomt index.
+*
+*                    - self: Pekare till indexet som ska initieras.
+********************************************************************************/
+void person_index_init(struct person_index* self)
+{
+   self->slots = 0;
+   self->slot_count = 0;
+   self->slot_used = 0;
+   self->ages = 0;
+   self->size = 0;
+   self->capacity = 0;
+   return;
+}
+
+/********************************************************************************
+* person_index_clear: Frigör minne allokerat av angivet index och nollställer
+*                     detta.
+*
+*                     - self: Pekare till indexet som ska nollställas.
+********************************************************************************/
+void person_index_clear(struct person_index* self)
+{
+   free(self->slots);
+   free(self->ages);
+   person_index_init(self);
+   return;
+}
+
+/********************************************************************************
+* person_index_build: Bygger om indexet för samtliga poster i angiven
+*                     person_store. Vid lyckad allokering returneras 0,
+*                     annars returneras 1.
+*
+*                     - self : Pekare till aktuellt index.
+*                     - store: Pekare till indexerad person_store.
+********************************************************************************/
+int person_index_build(struct person_index* self,
+                       const struct person_store* store)
+{
+   size_t slot_count = 16;
+   while (slot_count < store->size * 2) slot_count *= 2;
+
+   struct person_index_age* ages = (struct person_index_age*)malloc(
+      (store->size ? store->size : 1) * sizeof(struct person_index_age));
+   if (!ages) return 1;
+
+   person_index_clear(self);
+   if (person_index_rehash(self, slot_count))
+   {
+      free(ages);
+      return 1;
+   }
+
+   for (size_t i = 0; i < store->size; ++i)
+   {
+      person_index_slot_put(self, person_intern_hash_str(person_store_name(store, i)), i);
+      ages[i].age = store->ages[i];
+      ages[i].index = i;
+   }
+
+   qsort(ages, store->size, sizeof(struct person_index_age), &person_index_age_compare);
+   self->ages = ages;
+   self->size = store->size;
+   self->capacity = store->size ? store->size : 1;
+   return 0;
+}
+
+/********************************************************************************
+* person_index_insert: Lägger till posten på angivet index i indexet. Anropas
+*                      efter att posten har lagts till via person_store_push.
+*                      Vid lyckad allokering returneras 0, annars returneras 1.
+*
+*                      - self : Pekare till aktuellt index.
+*                      - store: Pekare till indexerad person_store.
+*                      - index: Postens index i person_store.
+********************************************************************************/
+int person_index_insert(struct person_index* self,
+                        const struct person_store* store,
+                        const size_t index)
+{
+   if ((self->slot_used + 1) * 4 > self->slot_count * 3)
+   {
+      size_t slot_count = 16;
+      while (slot_count < (self->size + 1) * 2) slot_count *= 2;
+      if (person_index_rehash(self, slot_count)) return 1;
+   }
+
+   if (person_index_age_insert(self, store->ages[index], index)) return 1;
+   person_index_slot_put(self, person_intern_hash_str(person_store_name(store, index)), index);
+   return 0;
+}
+
+/********************************************************************************
+* person_index_remove: Tar bort posten på angivet index ur indexet och
+*                      uppdaterar den sista posten, som person_store_remove
+*                      flyttar till det lediga indexet. Anropas före
+*                      person_store_remove.
+*
+*                      - self : Pekare till aktuellt index.
+*                      - store: Pekare till indexerad person_store.
+*                      - index: Index för posten som ska tas bort.
+********************************************************************************/
+void person_index_remove(struct person_index* self,
+                         const struct person_store* store,
+                         const size_t index)
+{
+   if (index >= store->size) return;
+   const size_t last = store->size - 1;
+
+   struct person_index_slot* slot = person_index_slot_find(self, store, index);
+   if (slot) slot->index = PERSON_INDEX_REMOVED;
+   person_index_age_erase(self, store->ages[index], index);
+
+   if (index != last)
+   {
+      slot = person_index_slot_find(self, store, last);
+      if (slot) slot->index = index + 1;
+      person_index_age_erase(self, store->ages[last], last);
+      person_index_age_insert(self, store->ages[last], index);
+   }
+   return;
+}
+
+/********************************************************************************
+* person_index_find_name: Lagrar index för upp till max_count poster med angivet
+*                         namn i angiven array och returnerar det totala antalet
+*                         träffar, vilket kan överstiga max_count.
+*
+*                         - self     : Pekare till aktuellt index.
+*                         - store    : Pekare till indexerad person_store.
+*                         - name     : Namnet som ska slås upp.
+*                         - indices  : Array där index för träffarna lagras.
+*                         - max_count: Antal index som ryms i arrayen.
+********************************************************************************/
+size_t person_index_find_name(const struct person_index* self,
+                              const struct person_store* store,
+                              const char* name,
+                              size_t* indices,
+                              const size_t max_count)
+{
+   if (!self->slot_count) return 0;
+   const uint64_t hash = person_intern_hash_str(name);
+   const size_t mask = self->slot_count - 1;
+   size_t count = 0;
+
+   for (size_t i = (size_t)hash & mask; self->slots[i].index; i = (i + 1) & mask)
+   {
+      const struct person_index_slot* slot = self->slots + i;
+      if (slot->index == PERSON_INDEX_REMOVED || slot->hash != hash) continue;
+      if (strcmp(person_store_name(store, slot->index - 1), name)) continue;
+      if (count < max_count) indices[count] = slot->index - 1;
+      count++;
+   }
+   return count;
+}
+
+/********************************************************************************
+* person_index_age_range: Returnerar antalet poster vars ålder ligger inom
+*                         intervallet [min_age, max_age] och lagrar en pekare
+*                         till den första av dessa i åldersindexet på angiven
+*                         adress. Träffarna ligger i följd, sorterade efter
+*                         ålder, och är giltiga tills indexet ändras.
+*
+*                         - self   : Pekare till aktuellt index.
+*                         - min_age: Lägsta ålder som ska inkluderas.
+*                         - max_age: Högsta ålder som ska inkluderas.
+*                         - first  : Adress där pekaren till första träffen lagras.
+********************************************************************************/
+size_t person_index_age_range(const struct person_index* self,
+                              const unsigned int min_age,
+                              const unsigned int max_age,
+                              const struct person_index_age** first)
+{
+   const size_t begin = person_index_age_lower(self, min_age, 0);
+   const size_t end = max_age == (unsigned int)-1 ?
+      self->size : person_index_age_lower(self, max_age + 1, 0);
+
+   *first = self->ages + begin;
+   return end > begin ? end - begin : 0;
+}
+
+/********************************************************************************
+* person_index_find_age_occupation: Lagrar index för upp till max_count poster
+*                                   vars ålder ligger inom [min_age, max_age]
+*                                   och vars yrke är lika med angivet yrke i
+*                                   angiven array. Det totala antalet träffar
+*                                   returneras, vilket kan överstiga max_count.
+*
+*                                   - self      : Pekare till aktuellt index.
+*                                   - store     : Pekare till indexerad person_store.
+*                                   - min_age   : Lägsta ålder som ska inkluderas.
+*                                   - max_age   : Högsta ålder som ska inkluderas.
+*                                   - occupation: Yrket som ska matchas.
+*                                   - indices   : Array där index för träffarna lagras.
+*                                   - max_count : Antal index som ryms i arrayen.
+********************************************************************************/
+size_t person_index_find_age_occupation(const struct person_index* self,
+                                        const struct person_store* store,
+                                        const unsigned int min_age,
+                                        const unsigned int max_age,
+                                        const char* occupation,
+                                        size_t* indices,
+                                        const size_t max_count)
+{
+   const struct person_index_age* first;
+   const size_t range = person_index_age_range(self, min_age, max_age, &first);
+   size_t count = 0;
+
+   for (size_t i = 0; i < range; ++i)
+   {
+      if (strcmp(person_store_occupation(store, first[i].index), occupation)) continue;
+      if (count < max_count) indices[count] = first[i].index;
+      count++;
+   }
+   return count;
+}
+
+/********************************************************************************
+* person_index_rehash: Allokerar en ny hashtabell med angivet antal platser och
+*                      lägger in befintliga poster på nytt, varvid borttagna
+*                      platser försvinner. Vid lyckad allokering returneras 0,
+*                      annars returneras 1.
+*
+*                      - self      : Pekare till aktuellt index.
+*                      - slot_count: Antal platser, en jämn tvåpotens.
+********************************************************************************/
+static int person_index_rehash(struct person_index* self,
+                               const size_t slot_count)
+{
+   struct person_index_slot* old = self->slots;
+   const size_t old_count = self->slot_count;
+
+   self->slots = (struct person_index_slot*)calloc(slot_count, sizeof(struct person_index_slot));
+   if (!self->slots)
+   {
+      self->slots = old;
+      return 1;
+   }
+
+   self->slot_count = slot_count;
+   self->slot_used = 0;
+
+   for (size_t i = 0; i < old_count; ++i)
+   {
+      if (old[i].index && old[i].index != PERSON_INDEX_REMOVED)
+      {
+         person_index_slot_put(self, old[i].hash, old[i].index - 1);
+      }
+   }
+
+   free(old);
+   return 0;
+}
+
+/********************************************************************************
+* person_index_slot_put: Lägger in angivet postindex på första lediga plats i
+*                        hashtabellen utifrån angivet hashvärde. Tabellen måste
+*                        innehålla minst en tom plats.
+*
+*                        - self : Pekare till aktuellt index.
+*                        - hash : Namnets hashvärde.
+*                        - index: Postens index.
+********************************************************************************/
+static void person_index_slot_put(struct person_index* self,
+                                  const uint64_t hash,
+                                  const size_t index)
+{
+   const size_t mask = self->slot_count - 1;
+   size_t i = (size_t)hash & mask;
+
+   while (self->slots[i].index && self->slots[i].index != PERSON_INDEX_REMOVED)
+   {
+      i = (i + 1) & mask;
+   }
+
+   if (!self->slots[i].index) self->slot_used++;
+   self->slots[i].hash = hash;
+   self->slots[i].index = index + 1;
+   return;
+}
+
+/********************************************************************************
+* person_index_slot_find: Returnerar en pekare till platsen i hashtabellen som
+*                         innehåller angivet postindex, eller null om posten
+*                         inte finns i tabellen.
+*
+*                         - self : Pekare till aktuellt index.
+*                         - store: Pekare till indexerad person_store.
+*                         - index: Postens index.
+********************************************************************************/
+static struct person_index_slot* person_index_slot_find(const struct person_index* self,
+                                                        const struct person_store* store,
+                                                        const size_t index)
+{
+   if (!self->slot_count) return 0;
+   const uint64_t hash = person_intern_hash_str(person_store_name(store, index));
+   const size_t mask = self->slot_count - 1;
+
+   for (size_t i = (size_t)hash & mask; self->slots[i].index; i = (i + 1) & mask)
+   {
+      if (self->slots[i].index == index + 1) return self->slots + i;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_index_age_lower: Returnerar positionen för den första posten i
+*                         åldersindexet som inte är mindre än angiven ålder
+*                         och angivet postindex.
+*
+*                         - self : Pekare till aktuellt index.
+*                         - age  : Åldern som ska sökas efter.
+*                         - index: Postindexet som ska sökas efter.
+********************************************************************************/
+static size_t person_index_age_lower(const struct person_index* self,
+                                     const unsigned int age,
+                                     const size_t index)
+{
+   size_t low = 0, high = self->size;
+
+   while (low < high)
+   {
+      const size_t middle = low + (high - low) / 2;
+      const struct person_index_age* entry = self->ages + middle;
+
+      if (entry->age < age || (entry->age == age && entry->index < index)) low = middle + 1;
+      else high = middle;
+   }
+   return low;
+}
+
+/********************************************************************************
+* person_index_age_insert: Lägger till angiven post i åldersindexet med bibehållen
+*                          sortering. Vid lyckad allokering returneras 0, annars
+*                          returneras 1.
+*
+*                          - self : Pekare till aktuellt index.
+*                          - age  : Postens ålder.
+*                          - index: Postens index.
+********************************************************************************/
+static int person_index_age_insert(struct person_index* self,
+                                   const unsigned int age,
+                                   const size_t index)
+{
+   if (self->size == self->capacity)
+   {
+      const size_t capacity = self->capacity ? self->capacity * 2 : 16;
+      struct person_index_age* ages = (struct person_index_age*)realloc(self->ages,
+         capacity * sizeof(struct person_index_age));
+      if (!ages) return 1;
+      self->ages = ages;
+      self->capacity = capacity;
+   }
+
+   const size_t position = person_index_age_lower(self, age, index);
+   memmove(self->ages + position + 1, self->ages + position,
+           (self->size - position) * sizeof(struct person_index_age));
+   self->ages[position].age = age;
+   self->ages[position].index = index;
+   self->size++;
+   return 0;
+}
+
+/********************************************************************************
+* person_index_age_erase: Tar bort angiven post ur åldersindexet.
+*
+*                         - self : Pekare till aktuellt index.
+*                         - age  : Postens ålder.
+*                         - index: Postens index.
+********************************************************************************/
+static void person_index_age_erase(struct person_index* self,
+                                   const unsigned int age,
+                                   const size_t index)
+{
+   const size_t position = person_index_age_lower(self, age, index);
+   if (position == self->size || self->ages[position].index != index) return;
+
+   memmove(self->ages + position, self->ages + position + 1,
+           (self->size - position - 1) * sizeof(struct person_index_age));
+   self->size--;
+   return;
+}
+
+/********************************************************************************
+* person_index_age_compare: Jämför två poster i åldersindexet efter ålder och
+*                           därefter efter postindex, för sortering via qsort.
+*
+*                           - a: Pekare till första posten.
+*                           - b: Pekare till andra posten.
+********************************************************************************/
+static int person_index_age_compare(const void* a,
+                                    const void* b)
+{
+   const struct person_index_age* x = (const struct person_index_age*)a;
+   const struct person_index_age* y = (const struct person_index_age*)b;
+
+   if (x->age != y->age) return x->age < y->age ? -1 : 1;
+   if (x->index != y->index) return x->index < y->index ? -1 : 1;
+   return 0;
+}
@@ -0,0 +1,154 @@
+/********************************************************************************
+* person_index.h: Innehåller sekundära index över poster i en person_store via
+*                 strukten person_index: ett hashindex med öppen adressering
+*                 för uppslagning på namn samt ett sorterat index för
+*                 intervallfrågor på ålder. Exempelvis kan samtliga lärare
+*                 mellan 30 och 40 år hittas i O(log n + k) istället för
+*                 att samtliga poster behöver gås igenom.
+*
+*                 Indexet uppdateras inkrementellt: person_index_insert anropas
+*                 efter person_store_push och person_index_remove anropas före
+*                 person_store_remove.
+********************************************************************************/
+#ifndef PERSON_INDEX_H_
+#define PERSON_INDEX_H_
+
+/* Inkluderingsdirektiv: */
+#include "person_store.h"
+#include <stdint.h>
+
+/********************************************************************************
+* person_index_age: Post i åldersindexet. Posterna är sorterade efter ålder
+*                   och därefter efter index i tillhörande person_store.
+********************************************************************************/
+typedef struct person_index_age
+{
+   unsigned int age; /* Personens ålder. */
+   size_t index;     /* Postens index i tillhörande person_store. */
+} person_index_age_t;
+
+/********************************************************************************
+* person_index: Strukt innehållande index över namn samt ålder för poster i
+*               en person_store.
+********************************************************************************/
+typedef struct person_index
+{
+   struct person_index_slot* slots; /* Hashtabell för namnindexet. */
+   size_t slot_count;               /* Antal platser i hashtabellen. */
+   size_t slot_used;                /* Antal upptagna och borttagna platser. */
+   struct person_index_age* ages;   /* Sorterat åldersindex. */
+   size_t size;                     /* Antal indexerade poster. */
+   size_t capacity;                 /* Åldersindexets kapacitet. */
+} person_index_t, *person_index_ptr_t;
+
+/********************************************************************************
+* person_index_init: Initierar ett nytt tomt index.
+*
+*                    - self: Pekare till indexet som ska initieras.
+********************************************************************************/
+void person_index_init(struct person_index* self);
+
+/********************************************************************************
+* person_index_clear: Frigör minne allokerat av angivet index och nollställer
+*                     detta.
+*
+*                     - self: Pekare till indexet som ska nollställas.
+********************************************************************************/
+void person_index_clear(struct person_index* self);
+
+/********************************************************************************
+* person_index_build: Bygger om indexet för samtliga poster i angiven
+*                     person_store. Vid lyckad allokering returneras 0,
+*                     annars returneras 1.
+*
+*                     - self : Pekare till aktuellt index.
+*                     - store: Pekare till indexerad person_store.
+********************************************************************************/
+int person_index_build(struct person_index* self,
+                       const struct person_store* store);
+
+/********************************************************************************
+* person_index_insert: Lägger till posten på angivet index i indexet. Anropas
+*                      efter att posten har lagts till via person_store_push.
+*                      Vid lyckad allokering returneras 0, annars returneras 1.
+*
+*                      - self : Pekare till aktuellt index.
+*                      - store: Pekare till indexerad person_store.
+*                      - index: Postens index i person_store.
+********************************************************************************/
+int person_index_insert(struct person_index* self,
+                        const struct person_store* store,
+                        const size_t index);
+
+/********************************************************************************
+* person_index_remove: Tar bort posten på angivet index ur indexet och
+*                      uppdaterar den sista posten, som person_store_remove
+*                      flyttar till det lediga indexet. Anropas före
+*                      person_store_remove.
+*
+*                      - self : Pekare till aktuellt index.
+*                      - store: Pekare till indexerad person_store.
+*                      - index: Index för posten som ska tas bort.
+********************************************************************************/
+void person_index_remove(struct person_index* self,
+                         const struct person_store* store,
+                         const size_t index);
+
+/********************************************************************************
+* person_index_find_name: Lagrar index för upp till max_count poster med angivet
+*                         namn i angiven array och returnerar det totala antalet
+*                         träffar, vilket kan överstiga max_count.
+*
+*                         - self     : Pekare till aktuellt index.
+*                         - store    : Pekare till indexerad person_store.
+*                         - name     : Namnet som ska slås upp.
+*                         - indices  : Array där index för träffarna lagras.
+*                         - max_count: Antal index som ryms i arrayen.
+********************************************************************************/
+size_t person_index_find_name(const struct person_index* self,
+                              const struct person_store* store,
+                              const char* name,
+                              size_t* indices,
+                              const size_t max_count);
+
+/********************************************************************************
+* person_index_age_range: Returnerar antalet poster vars ålder ligger inom
+*                         intervallet [min_age, max_age] och lagrar en pekare
+*                         till den första av dessa i åldersindexet på angiven
+*                         adress. Träffarna ligger i följd, sorterade efter
+*                         ålder, och är giltiga tills indexet ändras.
+*
+*                         - self   : Pekare till aktuellt index.
+*                         - min_age: Lägsta ålder som ska inkluderas.
+*                         - max_age: Högsta ålder som ska inkluderas.
+*                         - first  : Adress där pekaren till första träffen lagras.
+********************************************************************************/
+size_t person_index_age_range(const struct person_index* self,
+                              const unsigned int min_age,
+                              const unsigned int max_age,
+                              const struct person_index_age** first);
+
+/********************************************************************************
+* person_index_find_age_occupation: Lagrar index för upp till max_count poster
+*                                   vars ålder ligger inom [min_age, max_age]
+*                                   och vars yrke är lika med angivet yrke i
+*                                   angiven array. Det totala antalet träffar
+*                                   returneras, vilket kan överstiga max_count.
+*
+*                                   - self      : Pekare till aktuellt index.
+*                                   - store     : Pekare till indexerad person_store.
+*                                   - min_age   : Lägsta ålder som ska inkluderas.
+*                                   - max_age   : Högsta ålder som ska inkluderas.
+*                                   - occupation: Yrket som ska matchas.
+*                                   - indices   : Array där index för träffarna lagras.
+*                                   - max_count : Antal index som ryms i arrayen.
+********************************************************************************/
+size_t person_index_find_age_occupation(const struct person_index* self,
+                                        const struct person_store* store,
+                                        const unsigned int min_age,
+                                        const unsigned int max_age,
+                                        const char* occupation,
+                                        size_t* indices,
+                                        const size_t max_count);
+
+#endif /* PERSON_INDEX_H_ */
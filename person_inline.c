@@ -0,0 +1,343 @@
+/********************************************************************************
+* person_inline.c: Innehåller definitioner av associerade funktioner
+*                  tillhörande strukten person_inline, som lagrar persondata
+*                  direkt i objektet.
+********************************************************************************/
+#include "person_inline.h"
+#include <string.h>
+
+/* Buffrarna måste rymma en pekare till en heapallokerad sträng samt markören. */
+_Static_assert(PERSON_INLINE_NAME_SIZE > sizeof(char*) &&
+               PERSON_INLINE_ADDRESS_SIZE > sizeof(char*) &&
+               PERSON_INLINE_OCCUPATION_SIZE > sizeof(char*),
+               "person_inline: string buffers must be larger than a pointer");
+
+/* Statiska funktioner: */
+static const struct person_vtable* person_inline_vtable_ptr_new(void);
+static int person_inline_string_new(char* buffer,
+                                    const size_t size,
+                                    const char* s);
+static const char* person_inline_string(const char* buffer,
+                                        const size_t size);
+static void person_inline_string_delete(char* buffer,
+                                        const size_t size);
+static const char* person_inline_base_name(const struct person* self);
+static unsigned int person_inline_base_age(const struct person* self);
+static const char* person_inline_base_address(const struct person* self);
+static const char* person_inline_base_occupation(const struct person* self);
+static enum gender person_inline_base_gender(const struct person* self);
+static const char* person_inline_base_gender_str(const struct person* self);
+static void person_inline_base_clear(struct person* self);
+
+/********************************************************************************
+* person_inline_init: Lagrar angiven persondata i ett person_inline-objekt.
+*                     Vid lyckad initiering returneras 0, annars returneras 1
+*                     och objektet lämnas nollställt.
+*
+*                     - self      : Pekare till objektet som ska initieras.
+*                     - name      : Personens namn.
+*                     - age       : Personens ålder.
+*                     - address   : Personens hemadress.
+*                     - occupation: Personens yrke.
+*                     - gender    : Personens kön.
+********************************************************************************/
+int person_inline_init(struct person_inline* self,
+                       const char* name,
+                       const unsigned int age,
+                       const char* address,
+                       const char* occupation,
+                       const enum gender gender)
+{
+   memset(self, 0, sizeof(*self));
+
+   if (person_inline_string_new(self->name, sizeof(self->name), name) ||
+       person_inline_string_new(self->address, sizeof(self->address), address) ||
+       person_inline_string_new(self->occupation, sizeof(self->occupation), occupation))
+   {
+      person_inline_clear(self);
+      return 1;
+   }
+
+   self->base.mem = 0;
+   self->base.vptr = person_inline_vtable_ptr_new();
+   self->age = age;
+   self->gender = (unsigned char)gender;
+   return 0;
+}
+
+/********************************************************************************
+* person_inline_init_from: Kopierar persondata från angivet person-objekt till
+*                          ett person_inline-objekt. Vid lyckad initiering
+*                          returneras 0, annars returneras 1.
+*
+*                          - self  : Pekare till objektet som ska initieras.
+*                          - person: Pekare till objektet vars data ska kopieras.
+********************************************************************************/
+int person_inline_init_from(struct person_inline* self,
+                            const struct person* person)
+{
+   return person_inline_init(self, person->vptr->name(person), person->vptr->age(person),
+                             person->vptr->address(person), person->vptr->occupation(person),
+                             person->vptr->gender(person));
+}
+
+/********************************************************************************
+* person_inline_clear: Frigör eventuella heapallokerade strängar och
+*                      nollställer angivet person_inline-objekt.
+*
+*                      - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_inline_clear(struct person_inline* self)
+{
+   person_inline_string_delete(self->name, sizeof(self->name));
+   person_inline_string_delete(self->address, sizeof(self->address));
+   person_inline_string_delete(self->occupation, sizeof(self->occupation));
+   memset(self, 0, sizeof(*self));
+   return;
+}
+
+/********************************************************************************
+* person_inline_array_new: Allokerar en sammanhängande array med angivet antal
+*                          nollställda person_inline-objekt. Om
+*                          minnesallokeringen misslyckas returneras null.
+*
+*                          - count: Antal objekt i arrayen.
+********************************************************************************/
+struct person_inline* person_inline_array_new(const size_t count)
+{
+   return (struct person_inline*)calloc(count ? count : 1, sizeof(struct person_inline));
+}
+
+/********************************************************************************
+* person_inline_array_delete: Nollställer samtliga objekt i angiven array,
+*                             frigör arrayen och sätter motsvarande pekare
+*                             till null.
+*
+*                             - self : Adressen till pekaren till arrayen.
+*                             - count: Antal objekt i arrayen.
+********************************************************************************/
+void person_inline_array_delete(struct person_inline** self,
+                                const size_t count)
+{
+   if (!*self) return;
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      if ((*self)[i].base.vptr) person_inline_clear(&(*self)[i]);
+   }
+
+   free(*self);
+   *self = 0;
+   return;
+}
+
+/********************************************************************************
+* person_inline_name: Returnerar personens namn.
+*
+*                     - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_inline_name(const struct person_inline* self)
+{
+   return person_inline_string(self->name, sizeof(self->name));
+}
+
+/********************************************************************************
+* person_inline_age: Returnerar personens ålder.
+*
+*                    - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+unsigned int person_inline_age(const struct person_inline* self)
+{
+   return self->age;
+}
+
+/********************************************************************************
+* person_inline_address: Returnerar personens hemadress.
+*
+*                        - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_inline_address(const struct person_inline* self)
+{
+   return person_inline_string(self->address, sizeof(self->address));
+}
+
+/********************************************************************************
+* person_inline_occupation: Returnerar personens yrke.
+*
+*                           - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_inline_occupation(const struct person_inline* self)
+{
+   return person_inline_string(self->occupation, sizeof(self->occupation));
+}
+
+/********************************************************************************
+* person_inline_gender: Returnerar personens kön.
+*
+*                       - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+enum gender person_inline_gender(const struct person_inline* self)
+{
+   return (enum gender)self->gender;
+}
+
+/********************************************************************************
+* person_inline_vtable_ptr_new: Returnerar en pekare till ett statiskt vtable
+*                               för person_inline-objekt. Utskrift sker via
+*                               person_print, som läser persondatan via
+*                               objektets accessorer.
+********************************************************************************/
+static const struct person_vtable* person_inline_vtable_ptr_new(void)
+{
+   static const struct person_vtable self =
+   {
+      .print = &person_print,
+      .gender_str = &person_inline_base_gender_str,
+      .name = &person_inline_base_name,
+      .age = &person_inline_base_age,
+      .address = &person_inline_base_address,
+      .occupation = &person_inline_base_occupation,
+      .gender = &person_inline_base_gender,
+      .clear = &person_inline_base_clear
+   };
+
+   return &self;
+}
+
+/********************************************************************************
+* person_inline_string_new: Lagrar angiven sträng i angiven buffert om den
+*                           ryms där, annars lagras en pekare till en
+*                           heapallokerad kopia i buffertens början och
+*                           buffertens sista byte sätts till 1. Vid lyckad
+*                           lagring returneras 0, annars returneras 1.
+*
+*                           - buffer: Pekare till bufferten.
+*                           - size  : Buffertens storlek i bytes.
+*                           - s     : Strängen som ska lagras (null = tom sträng).
+********************************************************************************/
+static int person_inline_string_new(char* buffer,
+                                    const size_t size,
+                                    const char* s)
+{
+   if (!s) s = "";
+   const size_t length = strlen(s) + 1;
+
+   if (length <= size)
+   {
+      memcpy(buffer, s, length);
+      buffer[size - 1] = '\0';
+      return 0;
+   }
+
+   char* copy = (char*)malloc(length);
+   if (!copy) return 1;
+   memcpy(copy, s, length);
+   memcpy(buffer, &copy, sizeof(copy));
+   buffer[size - 1] = 1;
+   return 0;
+}
+
+/********************************************************************************
+* person_inline_string: Returnerar strängen som lagras via angiven buffert.
+*
+*                       - buffer: Pekare till bufferten.
+*                       - size  : Buffertens storlek i bytes.
+********************************************************************************/
+static const char* person_inline_string(const char* buffer,
+                                        const size_t size)
+{
+   if (!buffer[size - 1]) return buffer;
+   const char* s;
+   memcpy(&s, buffer, sizeof(s));
+   return s;
+}
+
+/********************************************************************************
+* person_inline_string_delete: Frigör strängen som lagras via angiven buffert
+*                              om den är heapallokerad.
+*
+*                              - buffer: Pekare till bufferten.
+*                              - size  : Buffertens storlek i bytes.
+********************************************************************************/
+static void person_inline_string_delete(char* buffer,
+                                        const size_t size)
+{
+   if (!buffer[size - 1]) return;
+   char* s;
+   memcpy(&s, buffer, sizeof(s));
+   free(s);
+   buffer[size - 1] = '\0';
+   return;
+}
+
+/********************************************************************************
+* person_inline_base_name: Returnerar personens namn via basobjektet.
+*
+*                          - self: Pekare till objektets person-objekt.
+********************************************************************************/
+static const char* person_inline_base_name(const struct person* self)
+{
+   return person_inline_name((const struct person_inline*)self);
+}
+
+/********************************************************************************
+* person_inline_base_age: Returnerar personens ålder via basobjektet.
+*
+*                         - self: Pekare till objektets person-objekt.
+********************************************************************************/
+static unsigned int person_inline_base_age(const struct person* self)
+{
+   return person_inline_age((const struct person_inline*)self);
+}
+
+/********************************************************************************
+* person_inline_base_address: Returnerar personens hemadress via basobjektet.
+*
+*                             - self: Pekare till objektets person-objekt.
+********************************************************************************/
+static const char* person_inline_base_address(const struct person* self)
+{
+   return person_inline_address((const struct person_inline*)self);
+}
+
+/********************************************************************************
+* person_inline_base_occupation: Returnerar personens yrke via basobjektet.
+*
+*                                - self: Pekare till objektets person-objekt.
+********************************************************************************/
+static const char* person_inline_base_occupation(const struct person* self)
+{
+   return person_inline_occupation((const struct person_inline*)self);
+}
+
+/********************************************************************************
+* person_inline_base_gender: Returnerar personens kön via basobjektet.
+*
+*                            - self: Pekare till objektets person-objekt.
+********************************************************************************/
+static enum gender person_inline_base_gender(const struct person* self)
+{
+   return person_inline_gender((const struct person_inline*)self);
+}
+
+/********************************************************************************
+* person_inline_base_gender_str: Returnerar personens kön på textform via
+*                                basobjektet.
+*
+*                                - self: Pekare till objektets person-objekt.
+********************************************************************************/
+static const char* person_inline_base_gender_str(const struct person* self)
+{
+   return gender_str(person_inline_base_gender(self));
+}
+
+/********************************************************************************
+* person_inline_base_clear: Nollställer objektet via basobjektet.
+*
+*                           - self: Pekare till objektets person-objekt.
+********************************************************************************/
+static void person_inline_base_clear(struct person* self)
+{
+   person_inline_clear((struct person_inline*)self);
+   return;
+}
@@ -0,0 +1,146 @@
+/********************************************************************************
+* person_inline.h: Innehåller strukten person_inline, en variant av person
+*                  där persondatan lagras direkt i objektet istället för i ett
+*                  separat heapallokerat person_mem-block. Textfälten lagras
+*                  i inbyggda buffrar (small string optimization), där enbart
+*                  strängar som inte ryms i bufferten kopieras till heapen.
+*                  En array av person_inline utgör därmed en enda
+*                  sammanhängande allokering, där persondatan läses utan
+*                  pekarjakt.
+*
+*                  Objektet innehåller ett person-objekt som första medlem,
+*                  vilket medför att samtliga anrop via person_vtable fungerar
+*                  på samma sätt som för person-objekt initierade via
+*                  person_init. Objektet saknar dock person_mem, varför
+*                  accessorerna i person_fast.h inte får användas. Objektet
+*                  nollställs via person_inline_clear eller via
+*                  person_clear(&p.base), som anropar vtabellens clear-
+*                  funktion, så att heapallokerade strängar frigörs.
+*
+*                  Objekten innehåller inga pekare till sig själva och kan
+*                  därför flyttas i minnet, exempelvis via realloc.
+********************************************************************************/
+#ifndef PERSON_INLINE_H_
+#define PERSON_INLINE_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+
+/* Storlek på de inbyggda buffrarna i bytes, inklusive nolltecken. */
+#define PERSON_INLINE_NAME_SIZE 24
+#define PERSON_INLINE_ADDRESS_SIZE 24
+#define PERSON_INLINE_OCCUPATION_SIZE 16
+
+/********************************************************************************
+* person_inline: Person-objekt med inbyggd persondata. En sträng som ryms i
+*                sin buffert lagras direkt i denna, annars lagras en pekare
+*                till en heapallokerad kopia i buffertens början, vilket
+*                markeras via ett nollskilt värde i buffertens sista byte.
+********************************************************************************/
+typedef struct person_inline
+{
+   struct person base;                             /* Basobjekt, används vid anrop via vtable. */
+   unsigned int age;                               /* Personens ålder. */
+   unsigned char gender;                           /* Personens kön. */
+   char name[PERSON_INLINE_NAME_SIZE];             /* Personens namn. */
+   char address[PERSON_INLINE_ADDRESS_SIZE];       /* Personens hemadress. */
+   char occupation[PERSON_INLINE_OCCUPATION_SIZE]; /* Personens yrke. */
+} person_inline_t, *person_inline_ptr_t;
+
+/********************************************************************************
+* person_inline_init: Lagrar angiven persondata i ett person_inline-objekt.
+*                     Textfälten kopieras, vilket medför att anroparen inte
+*                     behöver behålla originalsträngarna. En nullpekare lagras
+*                     som en tom sträng. Vid lyckad initiering returneras 0,
+*                     annars returneras 1 och objektet lämnas nollställt.
+*
+*                     - self      : Pekare till objektet som ska initieras.
+*                     - name      : Personens namn.
+*                     - age       : Personens ålder.
+*                     - address   : Personens hemadress.
+*                     - occupation: Personens yrke.
+*                     - gender    : Personens kön.
+********************************************************************************/
+int person_inline_init(struct person_inline* self,
+                       const char* name,
+                       const unsigned int age,
+                       const char* address,
+                       const char* occupation,
+                       const enum gender gender);
+
+/********************************************************************************
+* person_inline_init_from: Kopierar persondata från angivet person-objekt till
+*                          ett person_inline-objekt. Vid lyckad initiering
+*                          returneras 0, annars returneras 1.
+*
+*                          - self  : Pekare till objektet som ska initieras.
+*                          - person: Pekare till objektet vars data ska kopieras.
+********************************************************************************/
+int person_inline_init_from(struct person_inline* self,
+                            const struct person* person);
+
+/********************************************************************************
+* person_inline_clear: Frigör eventuella heapallokerade strängar och
+*                      nollställer angivet person_inline-objekt.
+*
+*                      - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_inline_clear(struct person_inline* self);
+
+/********************************************************************************
+* person_inline_array_new: Allokerar en sammanhängande array med angivet antal
+*                          nollställda person_inline-objekt, som sedan
+*                          initieras via person_inline_init. Om
+*                          minnesallokeringen misslyckas returneras null.
+*
+*                          - count: Antal objekt i arrayen.
+********************************************************************************/
+struct person_inline* person_inline_array_new(const size_t count);
+
+/********************************************************************************
+* person_inline_array_delete: Nollställer samtliga objekt i angiven array,
+*                             frigör arrayen och sätter motsvarande pekare
+*                             till null. Nollställda objekt hoppas över.
+*
+*                             - self : Adressen till pekaren till arrayen.
+*                             - count: Antal objekt i arrayen.
+********************************************************************************/
+void person_inline_array_delete(struct person_inline** self,
+                                const size_t count);
+
+/********************************************************************************
+* person_inline_name: Returnerar personens namn.
+*
+*                     - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_inline_name(const struct person_inline* self);
+
+/********************************************************************************
+* person_inline_age: Returnerar personens ålder.
+*
+*                    - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+unsigned int person_inline_age(const struct person_inline* self);
+
+/********************************************************************************
+* person_inline_address: Returnerar personens hemadress.
+*
+*                        - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_inline_address(const struct person_inline* self);
+
+/********************************************************************************
+* person_inline_occupation: Returnerar personens yrke.
+*
+*                           - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+const char* person_inline_occupation(const struct person_inline* self);
+
+/********************************************************************************
+* person_inline_gender: Returnerar personens kön.
+*
+*                       - self: Pekare till objektet som lagrar persondatan.
+********************************************************************************/
+enum gender person_inline_gender(const struct person_inline* self);
+
+#endif /* PERSON_INLINE_H_ */
@@ -0,0 +1,303 @@
+/********************************************************************************
+* person_intern.c: Innehåller definitioner av associerade funktioner
+*                  tillhörande strukten person_intern, som används för
+*                  internering av textsträngar.
+********************************************************************************/
+#include "person_intern.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Minsta storlek på block i strängpoolen. */
+#define PERSON_INTERN_CHUNK_SIZE (64 * 1024)
+
+/********************************************************************************
+* person_intern_slot: Plats i hashtabellen. En tom plats har str satt till null.
+********************************************************************************/
+struct person_intern_slot
+{
+   const char* str; /* Pekare till den internerade strängen. */
+   uint64_t hash;   /* Strängens hashvärde. */
+   size_t length;   /* Strängens längd exklusive nolltecken. */
+};
+
+/********************************************************************************
+* person_intern_chunk: Block i strängpoolen. Strängarna lagras direkt efter
+*                      blockets huvud.
+********************************************************************************/
+struct person_intern_chunk
+{
+   struct person_intern_chunk* next; /* Pekare till föregående block. */
+   size_t size;                      /* Antal använda bytes i blocket. */
+   size_t capacity;                  /* Blockets kapacitet i bytes. */
+   char data[];                      /* Blockets strängar. */
+};
+
+/* Statiska funktioner: */
+static struct person_intern_slot* person_intern_lookup(const struct person_intern* self,
+                                                       const char* s,
+                                                       const size_t length,
+                                                       const uint64_t hash);
+static int person_intern_grow(struct person_intern* self);
+static const char* person_intern_copy(struct person_intern* self,
+                                      const char* s,
+                                      const size_t length);
+
+/********************************************************************************
+* person_intern_init: Initierar en ny tom interneringstabell.
+*
+*                     - self: Pekare till tabellen som ska initieras.
+********************************************************************************/
+void person_intern_init(struct person_intern* self)
+{
+   self->slots = 0;
+   self->slot_count = 0;
+   self->size = 0;
+   self->chunks = 0;
+   return;
+}
+
+/********************************************************************************
+* person_intern_clear: Frigör minne allokerat av angiven interneringstabell.
+*                      Samtliga strängar som returnerats av tabellen samt
+*                      person-objekt initierade via tabellen blir ogiltiga.
+*
+*                      - self: Pekare till tabellen som ska nollställas.
+********************************************************************************/
+void person_intern_clear(struct person_intern* self)
+{
+   struct person_intern_chunk* chunk = self->chunks;
+
+   while (chunk)
+   {
+      struct person_intern_chunk* next = chunk->next;
+      free(chunk);
+      chunk = next;
+   }
+
+   free(self->slots);
+   person_intern_init(self);
+   return;
+}
+
+/********************************************************************************
+* person_intern_str: Returnerar en pekare till den internerade kopian av
+*                    angiven sträng. Om strängen inte redan finns i tabellen
+*                    så kopieras den in i strängpoolen. Lika strängar ger
+*                    därmed alltid samma pekare. Om minnesallokeringen
+*                    misslyckas så returneras null.
+*
+*                    - self: Pekare till aktuell interneringstabell.
+*                    - s   : Strängen som ska interneras (null = tom sträng).
+********************************************************************************/
+const char* person_intern_str(struct person_intern* self,
+                              const char* s)
+{
+   if (!s) s = "";
+   const size_t length = strlen(s);
+   const uint64_t hash = person_intern_hash(s, length);
+
+   if (self->slot_count)
+   {
+      struct person_intern_slot* slot = person_intern_lookup(self, s, length, hash);
+      if (slot->str) return slot->str;
+   }
+
+   if ((self->size + 1) * 4 > self->slot_count * 3 && person_intern_grow(self)) return 0;
+   const char* copy = person_intern_copy(self, s, length);
+   if (!copy) return 0;
+
+   struct person_intern_slot* slot = person_intern_lookup(self, s, length, hash);
+   slot->str = copy;
+   slot->hash = hash;
+   slot->length = length;
+   self->size++;
+   return copy;
+}
+
+/********************************************************************************
+* person_intern_find: Returnerar en pekare till den internerade kopian av
+*                     angiven sträng, eller null om strängen inte finns i
+*                     tabellen.
+*
+*                     - self: Pekare till aktuell interneringstabell.
+*                     - s   : Strängen som ska slås upp.
+********************************************************************************/
+const char* person_intern_find(const struct person_intern* self,
+                               const char* s)
+{
+   if (!self->slot_count) return 0;
+   if (!s) s = "";
+   const size_t length = strlen(s);
+   return person_intern_lookup(self, s, length, person_intern_hash(s, length))->str;
+}
+
+/********************************************************************************
+* person_intern_size: Returnerar antalet unika strängar i angiven tabell.
+*
+*                     - self: Pekare till aktuell interneringstabell.
+********************************************************************************/
+size_t person_intern_size(const struct person_intern* self)
+{
+   return self->size;
+}
+
+/********************************************************************************
+* person_init_interned: Lagrar angiven persondata i ett person-objekt, där
+*                       textfälten interneras via angiven tabell. Objektet
+*                       äger därmed kopior av sina strängar och anroparen
+*                       behöver inte behålla originalsträngarna. Textfält
+*                       från objekt initierade via samma tabell kan jämföras
+*                       via pekarjämförelse, exempelvis
+*                       person_occupation(a) == person_occupation(b).
+*                       Om internering misslyckas sätts objektets mem till null.
+*
+*                       - self      : Pekare till objektet som ska lagra uppgifterna.
+*                       - intern    : Pekare till interneringstabellen.
+*                       - name      : Personens namn.
+*                       - age       : Personens ålder.
+*                       - address   : Personens hemadress.
+*                       - occupation: Personens yrke.
+*                       - gender    : Personens kön.
+********************************************************************************/
+void person_init_interned(struct person* self,
+                          struct person_intern* intern,
+                          const char* name,
+                          const unsigned int age,
+                          const char* address,
+                          const char* occupation,
+                          const enum gender gender)
+{
+   name = person_intern_str(intern, name);
+   address = person_intern_str(intern, address);
+   occupation = person_intern_str(intern, occupation);
+
+   if (!name || !address || !occupation)
+   {
+      self->mem = 0;
+      self->vptr = 0;
+      return;
+   }
+
+   person_init(self, name, age, address, occupation, gender);
+   return;
+}
+
+/********************************************************************************
+* person_new_interned: Allokerar minne och lagrar angiven persondata i ett
+*                      person-objekt, där textfälten interneras via angiven
+*                      tabell. En pekare till objektet returneras. Om
+*                      minnesallokeringen misslyckas så returneras null.
+*
+*                      - intern    : Pekare till interneringstabellen.
+*                      - name      : Personens namn.
+*                      - age       : Personens ålder.
+*                      - address   : Personens hemadress.
+*                      - occupation: Personens yrke.
+*                      - gender    : Personens kön.
+********************************************************************************/
+struct person* person_new_interned(struct person_intern* intern,
+                                   const char* name,
+                                   const unsigned int age,
+                                   const char* address,
+                                   const char* occupation,
+                                   const enum gender gender)
+{
+   name = person_intern_str(intern, name);
+   address = person_intern_str(intern, address);
+   occupation = person_intern_str(intern, occupation);
+   if (!name || !address || !occupation) return 0;
+   return person_new(name, age, address, occupation, gender);
+}
+
+/********************************************************************************
+* person_intern_lookup: Returnerar en pekare till platsen i hashtabellen som
+*                       innehåller angiven sträng, eller till den tomma plats
+*                       där strängen ska lagras om den inte finns i tabellen.
+*                       Tabellen måste innehålla minst en tom plats.
+*
+*                       - self  : Pekare till aktuell interneringstabell.
+*                       - s     : Strängen som ska slås upp.
+*                       - length: Strängens längd.
+*                       - hash  : Strängens hashvärde.
+********************************************************************************/
+static struct person_intern_slot* person_intern_lookup(const struct person_intern* self,
+                                                       const char* s,
+                                                       const size_t length,
+                                                       const uint64_t hash)
+{
+   const size_t mask = self->slot_count - 1;
+
+   for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask)
+   {
+      struct person_intern_slot* slot = self->slots + i;
+      if (!slot->str) return slot;
+      if (slot->hash == hash && slot->length == length && !memcmp(slot->str, s, length))
+      {
+         return slot;
+      }
+   }
+}
+
+/********************************************************************************
+* person_intern_grow: Fördubblar antalet platser i hashtabellen och lägger in
+*                     befintliga strängar på nytt. Vid lyckad omallokering
+*                     returneras 0, annars returneras 1.
+*
+*                     - self: Pekare till aktuell interneringstabell.
+********************************************************************************/
+static int person_intern_grow(struct person_intern* self)
+{
+   const size_t slot_count = self->slot_count ? self->slot_count * 2 : 64;
+   struct person_intern_slot* slots = (struct person_intern_slot*)calloc(slot_count,
+      sizeof(struct person_intern_slot));
+   if (!slots) return 1;
+
+   for (size_t i = 0; i < self->slot_count; ++i)
+   {
+      const struct person_intern_slot* old = self->slots + i;
+      if (!old->str) continue;
+
+      size_t j = (size_t)old->hash & (slot_count - 1);
+      while (slots[j].str) j = (j + 1) & (slot_count - 1);
+      slots[j] = *old;
+   }
+
+   free(self->slots);
+   self->slots = slots;
+   self->slot_count = slot_count;
+   return 0;
+}
+
+/********************************************************************************
+* person_intern_copy: Kopierar angiven sträng till strängpoolen och returnerar
+*                     en pekare till kopian. Om minnesallokeringen misslyckas
+*                     så returneras null.
+*
+*                     - self  : Pekare till aktuell interneringstabell.
+*                     - s     : Strängen som ska kopieras.
+*                     - length: Strängens längd.
+********************************************************************************/
+static const char* person_intern_copy(struct person_intern* self,
+                                      const char* s,
+                                      const size_t length)
+{
+   struct person_intern_chunk* chunk = self->chunks;
+
+   if (!chunk || chunk->size + length + 1 > chunk->capacity)
+   {
+      const size_t capacity = length + 1 > PERSON_INTERN_CHUNK_SIZE ?
+         length + 1 : PERSON_INTERN_CHUNK_SIZE;
+      chunk = (struct person_intern_chunk*)malloc(sizeof(struct person_intern_chunk) + capacity);
+      if (!chunk) return 0;
+      chunk->next = self->chunks;
+      chunk->size = 0;
+      chunk->capacity = capacity;
+      self->chunks = chunk;
+   }
+
+   char* copy = chunk->data + chunk->size;
+   memcpy(copy, s, length);
+   copy[length] = '\0';
+   chunk->size += length + 1;
+   return copy;
+}
@@ -0,0 +1,166 @@
+/********************************************************************************
+* person_intern.h: Innehåller funktionalitet för internering av textsträngar
+*                  via strukten person_intern. Varje unik sträng lagras en
+*                  gång i en sammanhängande strängpool, vilket medför att
+*                  upprepade värden (exempelvis yrket "Teacher") inte tar
+*                  extra minne och att internerade strängar kan jämföras
+*                  via sina adresser istället för via strcmp.
+********************************************************************************/
+#ifndef PERSON_INTERN_H_
+#define PERSON_INTERN_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+#include <stdint.h>
+
+/* Startvärde respektive primtal för hashfunktionen FNV-1a (64 bitar). */
+#define PERSON_INTERN_HASH_OFFSET 14695981039346656037ULL
+#define PERSON_INTERN_HASH_PRIME 1099511628211ULL
+
+/********************************************************************************
+* person_intern: Strukt för internering av textsträngar. Strängarna lagras i
+*                en kedja av minnesblock som aldrig flyttas, vilket medför att
+*                returnerade pekare är giltiga tills person_intern_clear anropas.
+*                Uppslagning sker via en hashtabell med öppen adressering.
+********************************************************************************/
+typedef struct person_intern
+{
+   struct person_intern_slot* slots;   /* Hashtabell med internerade strängar. */
+   size_t slot_count;                  /* Antal platser i hashtabellen. */
+   size_t size;                        /* Antal internerade strängar. */
+   struct person_intern_chunk* chunks; /* Kedja av block i strängpoolen. */
+} person_intern_t, *person_intern_ptr_t;
+
+/********************************************************************************
+* person_intern_hash: Returnerar hashvärdet för angiven sträng (FNV-1a).
+*                     Används av samtliga hashtabeller för textsträngar.
+*
+*                     - s     : Strängen som ska hashas.
+*                     - length: Strängens längd.
+********************************************************************************/
+static inline uint64_t person_intern_hash(const char* s,
+                                          const size_t length)
+{
+   uint64_t hash = PERSON_INTERN_HASH_OFFSET;
+
+   for (size_t i = 0; i < length; ++i)
+   {
+      hash ^= (unsigned char)s[i];
+      hash *= PERSON_INTERN_HASH_PRIME;
+   }
+   return hash;
+}
+
+/********************************************************************************
+* person_intern_hash_str: Returnerar hashvärdet för angiven nollterminerad
+*                         sträng, samma värde som person_intern_hash ger för
+*                         strängen och dess längd.
+*
+*                         - s: Strängen som ska hashas.
+********************************************************************************/
+static inline uint64_t person_intern_hash_str(const char* s)
+{
+   uint64_t hash = PERSON_INTERN_HASH_OFFSET;
+
+   for (; *s; ++s)
+   {
+      hash ^= (unsigned char)*s;
+      hash *= PERSON_INTERN_HASH_PRIME;
+   }
+   return hash;
+}
+
+/********************************************************************************
+* person_intern_init: Initierar en ny tom interneringstabell.
+*
+*                     - self: Pekare till tabellen som ska initieras.
+********************************************************************************/
+void person_intern_init(struct person_intern* self);
+
+/********************************************************************************
+* person_intern_clear: Frigör minne allokerat av angiven interneringstabell.
+*                      Samtliga strängar som returnerats av tabellen samt
+*                      person-objekt initierade via tabellen blir ogiltiga.
+*
+*                      - self: Pekare till tabellen som ska nollställas.
+********************************************************************************/
+void person_intern_clear(struct person_intern* self);
+
+/********************************************************************************
+* person_intern_str: Returnerar en pekare till den internerade kopian av
+*                    angiven sträng. Om strängen inte redan finns i tabellen
+*                    så kopieras den in i strängpoolen. Lika strängar ger
+*                    därmed alltid samma pekare. Om minnesallokeringen
+*                    misslyckas så returneras null.
+*
+*                    - self: Pekare till aktuell interneringstabell.
+*                    - s   : Strängen som ska interneras (null = tom sträng).
+********************************************************************************/
+const char* person_intern_str(struct person_intern* self,
+                              const char* s);
+
+/********************************************************************************
+* person_intern_find: Returnerar en pekare till den internerade kopian av
+*                     angiven sträng, eller null om strängen inte finns i
+*                     tabellen.
+*
+*                     - self: Pekare till aktuell interneringstabell.
+*                     - s   : Strängen som ska slås upp.
+********************************************************************************/
+const char* person_intern_find(const struct person_intern* self,
+                               const char* s);
+
+/********************************************************************************
+* person_intern_size: Returnerar antalet unika strängar i angiven tabell.
+*
+*                     - self: Pekare till aktuell interneringstabell.
+********************************************************************************/
+size_t person_intern_size(const struct person_intern* self);
+
+/********************************************************************************
+* person_init_interned: Lagrar angiven persondata i ett person-objekt, där
+*                       textfälten interneras via angiven tabell. Objektet
+*                       äger därmed kopior av sina strängar och anroparen
+*                       behöver inte behålla originalsträngarna. Textfält
+*                       från objekt initierade via samma tabell kan jämföras
+*                       via pekarjämförelse, exempelvis
+*                       person_occupation(a) == person_occupation(b).
+*                       Om internering misslyckas sätts objektets mem till null.
+*
+*                       - self      : Pekare till objektet som ska lagra uppgifterna.
+*                       - intern    : Pekare till interneringstabellen.
+*                       - name      : Personens namn.
+*                       - age       : Personens ålder.
+*                       - address   : Personens hemadress.
+*                       - occupation: Personens yrke.
+*                       - gender    : Personens kön.
+********************************************************************************/
+void person_init_interned(struct person* self,
+                          struct person_intern* intern,
+                          const char* name,
+                          const unsigned int age,
+                          const char* address,
+                          const char* occupation,
+                          const enum gender gender);
+
+/********************************************************************************
+* person_new_interned: Allokerar minne och lagrar angiven persondata i ett
+*                      person-objekt, där textfälten interneras via angiven
+*                      tabell. En pekare till objektet returneras. Om
+*                      minnesallokeringen misslyckas så returneras null.
+*
+*                      - intern    : Pekare till interneringstabellen.
+*                      - name      : Personens namn.
+*                      - age       : Personens ålder.
+*                      - address   : Personens hemadress.
+*                      - occupation: Personens yrke.
+*                      - gender    : Personens kön.
+********************************************************************************/
+struct person* person_new_interned(struct person_intern* intern,
+                                   const char* name,
+                                   const unsigned int age,
+                                   const char* address,
+                                   const char* occupation,
+                                   const enum gender gender);
+
+#endif /* PERSON_INTERN_H_ */
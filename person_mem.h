@@ -0,0 +1,58 @@
+/********************************************************************************
+* person_mem.h: Innehåller definitionen av strukten person_mem, som lagrar
+*               persondatan för person-objekt initierade via person_init.
+*               Definitionen är intern och används endast av person.c,
+*               person_delta.c samt av de inline-definierade accessorerna i
+*               person_fast.h.
+********************************************************************************/
+#ifndef PERSON_MEM_H_
+#define PERSON_MEM_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+#include <stdatomic.h>
+
+/* Strukt som definieras i person_delta.h. */
+struct person_delta;
+
+/********************************************************************************
+* person_mem: Strukt innehållande variabler för lagring av persondata.
+********************************************************************************/
+typedef struct person_mem
+{
+   const char* name;                         /* Personens namn. */
+   unsigned int age;                         /* Personens ålder. */
+   const char* address;                      /* Personens hemadress. */
+   const char* occupation;                   /* Personens yrke. */
+   enum gender gender;                       /* Personens kön. */
+   const struct person_allocator* allocator; /* Allokator som äger minnet. */
+   uint64_t generation;                      /* Generation för objektets senaste ändring. */
+   struct person_delta* delta;               /* Deltan som spårar objektet (null = ingen). */
+   size_t dirty_index;                       /* Objektets plats i deltans lista över ändrade objekt. */
+   atomic_int dirty;                         /* Indikerar att objektet finns i deltans lista. */
+} person_mem_t, *person_mem_ptr_t;
+
+/********************************************************************************
+* person_delta_mark: Lägger till angivet spårat objekt i listan över ändrade
+*                    objekt i angiven person_delta. Anropas av person.c när
+*                    ett spårat objekt ändras för första gången sedan
+*                    senaste export. Definieras i person_delta.c.
+*
+*                    - self  : Pekare till deltan som spårar objektet.
+*                    - person: Pekare till det ändrade objektet.
+********************************************************************************/
+void person_delta_mark(struct person_delta* self,
+                       struct person* person);
+
+/********************************************************************************
+* person_delta_forget: Slutar spåra objektet som lagrar angiven persondata.
+*                      Anropas av person.c innan persondatan frigörs.
+*                      Definieras i person_delta.c.
+*
+*                      - self: Pekare till deltan som spårar objektet.
+*                      - mem : Pekare till objektets persondata.
+********************************************************************************/
+void person_delta_forget(struct person_delta* self,
+                         struct person_mem* mem);
+
+#endif /* PERSON_MEM_H_ */
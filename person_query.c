@@ -0,0 +1,559 @@
+/********************************************************************************
+* person_query.c: Innehåller definitioner av associerade funktioner
+*                 tillhörande strukten person_query, som används för
+*                 parallella frågor och aggregeringar över en person_store.
+********************************************************************************/
+#include "person_query.h"
+#include "person_intern.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Cachelinjens storlek, delresultaten placeras på separata cachelinjer. */
+#define PERSON_QUERY_CACHE_LINE 64
+
+/********************************************************************************
+* person_query_task: Kontext för ett parallellt jobb.
+********************************************************************************/
+struct person_query_task
+{
+   const struct person_query* query; /* Pekare till frågan som körs. */
+   const struct person_store* store; /* Pekare till aktuell person_store. */
+   char* partials;                   /* Trådarnas delresultat. */
+   size_t stride;                    /* Avstånd mellan delresultaten i bytes. */
+   atomic_size_t next;               /* Index för nästa block att bearbeta. */
+};
+
+/********************************************************************************
+* person_query_count_context: Kontext för person_query_count_if.
+********************************************************************************/
+struct person_query_count_context
+{
+   int (*filter)(const struct person_store* store,
+                 const size_t index,
+                 void* context); /* Filter som anropas för varje post. */
+   void* context;                /* Kontext som passeras till filtret. */
+};
+
+/********************************************************************************
+* person_query_map: Hashtabell för antal personer per yrke.
+********************************************************************************/
+struct person_query_map
+{
+   struct person_occupation_count* slots; /* Tabellens platser. */
+   uint64_t* hashes;                      /* Hashvärden för respektive plats. */
+   size_t slot_count;                     /* Antal platser i tabellen. */
+   size_t size;                           /* Antal unika yrken. */
+   int error;                             /* Indikerar misslyckad allokering. */
+};
+
+/* Statiska funktioner: */
+static void person_query_job(void* context,
+                             const size_t worker,
+                             const size_t count);
+static void person_query_count_scan(const struct person_store* store,
+                                    const size_t begin,
+                                    const size_t end,
+                                    void* partial,
+                                    void* context);
+static void person_query_count_merge(void* result,
+                                     void* partial,
+                                     void* context);
+static void person_query_gender_scan(const struct person_store* store,
+                                     const size_t begin,
+                                     const size_t end,
+                                     void* partial,
+                                     void* context);
+static void person_query_gender_merge(void* result,
+                                      void* partial,
+                                      void* context);
+static void person_query_age_scan(const struct person_store* store,
+                                  const size_t begin,
+                                  const size_t end,
+                                  void* partial,
+                                  void* context);
+static void person_query_age_merge(void* result,
+                                   void* partial,
+                                   void* context);
+static void person_query_occupation_scan(const struct person_store* store,
+                                         const size_t begin,
+                                         const size_t end,
+                                         void* partial,
+                                         void* context);
+static void person_query_occupation_merge(void* result,
+                                          void* partial,
+                                          void* context);
+static void person_query_map_add(struct person_query_map* self,
+                                 const char* occupation,
+                                 const uint64_t hash,
+                                 const size_t count);
+static void person_query_map_clear(struct person_query_map* self);
+static int person_query_occupation_compare(const void* a,
+                                           const void* b);
+
+/********************************************************************************
+* person_query_run: Kör angiven fråga parallellt över samtliga poster i angiven
+*                   person_store och slår samman delresultaten i angivet
+*                   resultat, som måste vara initierat av anroparen. Vid
+*                   lyckad körning returneras 0, annars returneras 1.
+*
+*                   - self   : Pekare till frågan som ska köras.
+*                   - store  : Pekare till aktuell person_store.
+*                   - workers: Pekare till trådpoolen (null = enbart anropande tråd).
+*                   - result : Pekare till det slutliga resultatet.
+********************************************************************************/
+int person_query_run(const struct person_query* self,
+                     const struct person_store* store,
+                     struct person_workers* workers,
+                     void* result)
+{
+   const size_t count = person_workers_count(workers);
+   struct person_query_task task;
+
+   task.query = self;
+   task.store = store;
+   task.stride = (self->partial_size + PERSON_QUERY_CACHE_LINE - 1) /
+      PERSON_QUERY_CACHE_LINE * PERSON_QUERY_CACHE_LINE;
+   if (!task.stride) task.stride = PERSON_QUERY_CACHE_LINE;
+   task.partials = (char*)aligned_alloc(PERSON_QUERY_CACHE_LINE, count * task.stride);
+   if (!task.partials) return 1;
+   memset(task.partials, 0, count * task.stride);
+   atomic_init(&task.next, 0);
+
+   person_workers_run(workers, &person_query_job, &task);
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      self->merge(result, task.partials + i * task.stride, self->context);
+   }
+
+   free(task.partials);
+   return 0;
+}
+
+/********************************************************************************
+* person_query_count_if: Returnerar antalet poster för vilka angivet filter
+*                        returnerar ett annat värde än 0.
+*
+*                        - store  : Pekare till aktuell person_store.
+*                        - workers: Pekare till trådpoolen (null = enbart anropande tråd).
+*                        - filter : Filter som anropas med postens index.
+*                        - context: Kontext som passeras till filtret.
+********************************************************************************/
+size_t person_query_count_if(const struct person_store* store,
+                             struct person_workers* workers,
+                             int (*filter)(const struct person_store* store,
+                                           const size_t index,
+                                           void* context),
+                             void* context)
+{
+   struct person_query_count_context count_context = { filter, context };
+   const struct person_query query =
+   {
+      .scan = &person_query_count_scan,
+      .merge = &person_query_count_merge,
+      .partial_size = sizeof(size_t),
+      .context = &count_context
+   };
+   size_t result = 0;
+
+   person_query_run(&query, store, workers, &result);
+   return result;
+}
+
+/********************************************************************************
+* person_query_gender_histogram: Räknar antalet personer av respektive kön och
+*                                lagrar resultatet i angiven array, indexerad
+*                                via enumerationen gender.
+*
+*                                - store  : Pekare till aktuell person_store.
+*                                - workers: Pekare till trådpoolen (eller null).
+*                                - counts : Array som rymmer GENDER_NONE + 1 värden.
+********************************************************************************/
+void person_query_gender_histogram(const struct person_store* store,
+                                   struct person_workers* workers,
+                                   size_t* counts)
+{
+   const struct person_query query =
+   {
+      .scan = &person_query_gender_scan,
+      .merge = &person_query_gender_merge,
+      .partial_size = (GENDER_NONE + 1) * sizeof(size_t),
+      .context = 0
+   };
+
+   memset(counts, 0, (GENDER_NONE + 1) * sizeof(size_t));
+   person_query_run(&query, store, workers, counts);
+   return;
+}
+
+/********************************************************************************
+* person_query_age_stats: Beräknar åldersstatistik för samtliga personer.
+*
+*                         - store  : Pekare till aktuell person_store.
+*                         - workers: Pekare till trådpoolen (eller null).
+*                         - stats  : Pekare till strukten där statistiken lagras.
+********************************************************************************/
+void person_query_age_stats(const struct person_store* store,
+                            struct person_workers* workers,
+                            struct person_age_stats* stats)
+{
+   const struct person_query query =
+   {
+      .scan = &person_query_age_scan,
+      .merge = &person_query_age_merge,
+      .partial_size = sizeof(struct person_age_stats),
+      .context = 0
+   };
+
+   memset(stats, 0, sizeof(*stats));
+   person_query_run(&query, store, workers, stats);
+   stats->mean = stats->count ? (double)stats->sum / stats->count : 0.0;
+   return;
+}
+
+/********************************************************************************
+* person_query_occupation_counts: Räknar antalet personer per yrke. En
+*                                 dynamiskt allokerad array sorterad efter
+*                                 antal i fallande ordning lagras på angiven
+*                                 adress och ska frigöras via free. Antalet
+*                                 unika yrken returneras. Om minnesallokeringen
+*                                 misslyckas så lagras null och 0 returneras.
+*
+*                                 - store  : Pekare till aktuell person_store.
+*                                 - workers: Pekare till trådpoolen (eller null).
+*                                 - counts : Adress där pekaren till arrayen lagras.
+********************************************************************************/
+size_t person_query_occupation_counts(const struct person_store* store,
+                                      struct person_workers* workers,
+                                      struct person_occupation_count** counts)
+{
+   const struct person_query query =
+   {
+      .scan = &person_query_occupation_scan,
+      .merge = &person_query_occupation_merge,
+      .partial_size = sizeof(struct person_query_map),
+      .context = 0
+   };
+   struct person_query_map result;
+   memset(&result, 0, sizeof(result));
+   *counts = 0;
+
+   if (person_query_run(&query, store, workers, &result) || result.error)
+   {
+      person_query_map_clear(&result);
+      return 0;
+   }
+
+   struct person_occupation_count* array = (struct person_occupation_count*)malloc(
+      (result.size ? result.size : 1) * sizeof(struct person_occupation_count));
+   if (!array)
+   {
+      person_query_map_clear(&result);
+      return 0;
+   }
+
+   size_t size = 0;
+   for (size_t i = 0; i < result.slot_count; ++i)
+   {
+      if (result.slots[i].occupation) array[size++] = result.slots[i];
+   }
+
+   qsort(array, size, sizeof(struct person_occupation_count), &person_query_occupation_compare);
+   person_query_map_clear(&result);
+   *counts = array;
+   return size;
+}
+
+/********************************************************************************
+* person_query_job: Jobb som körs av varje tråd. Tråden hämtar block av poster
+*                   tills samtliga poster är bearbetade och ackumulerar
+*                   resultatet i sitt eget delresultat.
+*
+*                   - context: Pekare till aktuell person_query_task.
+*                   - worker : Trådens nummer.
+*                   - count  : Antal trådar (används ej).
+********************************************************************************/
+static void person_query_job(void* context,
+                             const size_t worker,
+                             const size_t count)
+{
+   struct person_query_task* task = (struct person_query_task*)context;
+   void* partial = task->partials + worker * task->stride;
+   const size_t size = task->store->size;
+   (void)count;
+
+   for (;;)
+   {
+      const size_t begin = atomic_fetch_add(&task->next, PERSON_QUERY_BLOCK_SIZE);
+      if (begin >= size) break;
+      const size_t end = size - begin < PERSON_QUERY_BLOCK_SIZE ? size : begin + PERSON_QUERY_BLOCK_SIZE;
+      task->query->scan(task->store, begin, end, partial, task->query->context);
+   }
+   return;
+}
+
+/********************************************************************************
+* person_query_count_scan: Räknar antalet poster i blocket som passerar filtret.
+********************************************************************************/
+static void person_query_count_scan(const struct person_store* store,
+                                    const size_t begin,
+                                    const size_t end,
+                                    void* partial,
+                                    void* context)
+{
+   const struct person_query_count_context* self = (const struct person_query_count_context*)context;
+   size_t count = 0;
+
+   for (size_t i = begin; i < end; ++i)
+   {
+      count += self->filter(store, i, self->context) != 0;
+   }
+
+   *(size_t*)partial += count;
+   return;
+}
+
+/********************************************************************************
+* person_query_count_merge: Summerar antalet träffar från ett delresultat.
+********************************************************************************/
+static void person_query_count_merge(void* result,
+                                     void* partial,
+                                     void* context)
+{
+   (void)context;
+   *(size_t*)result += *(const size_t*)partial;
+   return;
+}
+
+/********************************************************************************
+* person_query_gender_scan: Räknar antalet personer av respektive kön i blocket.
+********************************************************************************/
+static void person_query_gender_scan(const struct person_store* store,
+                                     const size_t begin,
+                                     const size_t end,
+                                     void* partial,
+                                     void* context)
+{
+   size_t* counts = (size_t*)partial;
+   size_t local[GENDER_NONE + 1] = { 0 };
+   (void)context;
+
+   for (size_t i = begin; i < end; ++i)
+   {
+      const unsigned char gender = store->genders[i];
+      local[gender <= GENDER_NONE ? gender : GENDER_NONE]++;
+   }
+
+   for (size_t i = 0; i <= GENDER_NONE; ++i)
+   {
+      counts[i] += local[i];
+   }
+   return;
+}
+
+/********************************************************************************
+* person_query_gender_merge: Summerar könsfördelningen från ett delresultat.
+********************************************************************************/
+static void person_query_gender_merge(void* result,
+                                      void* partial,
+                                      void* context)
+{
+   (void)context;
+
+   for (size_t i = 0; i <= GENDER_NONE; ++i)
+   {
+      ((size_t*)result)[i] += ((const size_t*)partial)[i];
+   }
+   return;
+}
+
+/********************************************************************************
+* person_query_age_scan: Beräknar åldersstatistik för blocket.
+********************************************************************************/
+static void person_query_age_scan(const struct person_store* store,
+                                  const size_t begin,
+                                  const size_t end,
+                                  void* partial,
+                                  void* context)
+{
+   struct person_age_stats* stats = (struct person_age_stats*)partial;
+   unsigned int min = (unsigned int)-1, max = 0;
+   unsigned long long sum = 0;
+   (void)context;
+
+   for (size_t i = begin; i < end; ++i)
+   {
+      const unsigned int age = store->ages[i];
+      sum += age;
+      min = age < min ? age : min;
+      max = age > max ? age : max;
+   }
+
+   if (!stats->count || min < stats->min) stats->min = min;
+   if (max > stats->max) stats->max = max;
+   stats->sum += sum;
+   stats->count += end - begin;
+   return;
+}
+
+/********************************************************************************
+* person_query_age_merge: Slår samman åldersstatistik från ett delresultat.
+********************************************************************************/
+static void person_query_age_merge(void* result,
+                                   void* partial,
+                                   void* context)
+{
+   struct person_age_stats* stats = (struct person_age_stats*)result;
+   const struct person_age_stats* other = (const struct person_age_stats*)partial;
+   (void)context;
+
+   if (!other->count) return;
+   if (!stats->count || other->min < stats->min) stats->min = other->min;
+   if (other->max > stats->max) stats->max = other->max;
+   stats->sum += other->sum;
+   stats->count += other->count;
+   return;
+}
+
+/********************************************************************************
+* person_query_occupation_scan: Räknar antalet personer per yrke i blocket.
+********************************************************************************/
+static void person_query_occupation_scan(const struct person_store* store,
+                                         const size_t begin,
+                                         const size_t end,
+                                         void* partial,
+                                         void* context)
+{
+   struct person_query_map* map = (struct person_query_map*)partial;
+   (void)context;
+
+   for (size_t i = begin; i < end; ++i)
+   {
+      const char* occupation = person_store_occupation(store, i);
+      person_query_map_add(map, occupation, person_intern_hash_str(occupation), 1);
+   }
+   return;
+}
+
+/********************************************************************************
+* person_query_occupation_merge: Slår samman antal per yrke från ett
+*                                delresultat och frigör delresultatet.
+********************************************************************************/
+static void person_query_occupation_merge(void* result,
+                                          void* partial,
+                                          void* context)
+{
+   struct person_query_map* self = (struct person_query_map*)result;
+   struct person_query_map* other = (struct person_query_map*)partial;
+   (void)context;
+
+   if (other->error) self->error = 1;
+
+   for (size_t i = 0; i < other->slot_count; ++i)
+   {
+      if (!other->slots[i].occupation) continue;
+      person_query_map_add(self, other->slots[i].occupation, other->hashes[i],
+                           other->slots[i].count);
+   }
+
+   person_query_map_clear(other);
+   return;
+}
+
+/********************************************************************************
+* person_query_map_add: Ökar antalet för angivet yrke med angivet värde. Om
+*                       tabellen behöver växa men allokeringen misslyckas så
+*                       sätts tabellens felflagga.
+*
+*                       - self      : Pekare till aktuell tabell.
+*                       - occupation: Yrket som ska räknas.
+*                       - hash      : Yrkets hashvärde.
+*                       - count     : Värdet som ska adderas.
+********************************************************************************/
+static void person_query_map_add(struct person_query_map* self,
+                                 const char* occupation,
+                                 const uint64_t hash,
+                                 const size_t count)
+{
+   if ((self->size + 1) * 2 > self->slot_count)
+   {
+      const size_t slot_count = self->slot_count ? self->slot_count * 2 : 64;
+      struct person_occupation_count* slots = (struct person_occupation_count*)calloc(
+         slot_count, sizeof(struct person_occupation_count));
+      uint64_t* hashes = (uint64_t*)malloc(slot_count * sizeof(uint64_t));
+
+      if (!slots || !hashes)
+      {
+         free(slots);
+         free(hashes);
+         self->error = 1;
+         return;
+      }
+
+      for (size_t i = 0; i < self->slot_count; ++i)
+      {
+         if (!self->slots[i].occupation) continue;
+         size_t j = (size_t)self->hashes[i] & (slot_count - 1);
+         while (slots[j].occupation) j = (j + 1) & (slot_count - 1);
+         slots[j] = self->slots[i];
+         hashes[j] = self->hashes[i];
+      }
+
+      free(self->slots);
+      free(self->hashes);
+      self->slots = slots;
+      self->hashes = hashes;
+      self->slot_count = slot_count;
+   }
+
+   const size_t mask = self->slot_count - 1;
+   size_t i = (size_t)hash & mask;
+
+   while (self->slots[i].occupation)
+   {
+      if (self->hashes[i] == hash && !strcmp(self->slots[i].occupation, occupation))
+      {
+         self->slots[i].count += count;
+         return;
+      }
+      i = (i + 1) & mask;
+   }
+
+   self->slots[i].occupation = occupation;
+   self->slots[i].count = count;
+   self->hashes[i] = hash;
+   self->size++;
+   return;
+}
+
+/********************************************************************************
+* person_query_map_clear: Frigör minne allokerat av angiven tabell.
+*
+*                         - self: Pekare till tabellen som ska nollställas.
+********************************************************************************/
+static void person_query_map_clear(struct person_query_map* self)
+{
+   free(self->slots);
+   free(self->hashes);
+   memset(self, 0, sizeof(*self));
+   return;
+}
+
+/********************************************************************************
+* person_query_occupation_compare: Jämför två yrken efter antal i fallande
+*                                  ordning och därefter alfabetiskt, för
+*                                  sortering via qsort.
+*
+*                                  - a: Pekare till första yrket.
+*                                  - b: Pekare till andra yrket.
+********************************************************************************/
+static int person_query_occupation_compare(const void* a,
+                                           const void* b)
+{
+   const struct person_occupation_count* x = (const struct person_occupation_count*)a;
+   const struct person_occupation_count* y = (const struct person_occupation_count*)b;
+
+   if (x->count != y->count) return x->count > y->count ? -1 : 1;
+   return strcmp(x->occupation, y->occupation);
+}
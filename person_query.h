@@ -0,0 +1,151 @@
+/********************************************************************************
+* person_query.h: Innehåller funktionalitet för parallella frågor och
+*                 aggregeringar över en person_store via strukten
+*                 person_query. Posterna delas upp i block som trådarna i en
+*                 person_workers hämtar dynamiskt. Varje tråd ackumulerar sitt
+*                 delresultat separat, varefter delresultaten slås samman.
+*                 Dessutom finns färdiga aggregeringar för könsfördelning,
+*                 åldersstatistik samt antal personer per yrke.
+********************************************************************************/
+#ifndef PERSON_QUERY_H_
+#define PERSON_QUERY_H_
+
+/* Inkluderingsdirektiv: */
+#include "person_store.h"
+#include "person_workers.h"
+
+/* Antal poster per block som trådarna hämtar åt gången. */
+#define PERSON_QUERY_BLOCK_SIZE 16384
+
+/********************************************************************************
+* person_query: Strukt innehållande en parallell fråga i form av en funktion
+*               som bearbetar ett block av poster samt en funktion som slår
+*               samman delresultat.
+********************************************************************************/
+typedef struct person_query
+{
+   /********************************************************************************
+   * scan: Bearbetar posterna i intervallet [begin, end) och ackumulerar
+   *       resultatet i angivet delresultat, som initialt är nollställt.
+   *
+   *       - store  : Pekare till aktuell person_store.
+   *       - begin  : Index för första posten i blocket.
+   *       - end    : Index direkt efter sista posten i blocket.
+   *       - partial: Pekare till trådens delresultat.
+   *       - context: Frågans kontext.
+   ********************************************************************************/
+   void (*scan)(const struct person_store* store,
+                const size_t begin,
+                const size_t end,
+                void* partial,
+                void* context);
+
+   /********************************************************************************
+   * merge: Slår samman ett delresultat med det slutliga resultatet.
+   *
+   *        - result : Pekare till det slutliga resultatet.
+   *        - partial: Pekare till delresultatet.
+   *        - context: Frågans kontext.
+   ********************************************************************************/
+   void (*merge)(void* result,
+                 void* partial,
+                 void* context);
+
+   size_t partial_size; /* Storlek på varje delresultat i bytes. */
+   void* context;       /* Kontext som passeras till scan samt merge. */
+} person_query_t, *person_query_ptr_t;
+
+/********************************************************************************
+* person_age_stats: Strukt innehållande åldersstatistik.
+********************************************************************************/
+typedef struct person_age_stats
+{
+   size_t count;             /* Antal personer. */
+   unsigned int min;         /* Lägsta ålder. */
+   unsigned int max;         /* Högsta ålder. */
+   unsigned long long sum;   /* Summan av samtliga åldrar. */
+   double mean;              /* Medelåldern. */
+} person_age_stats_t;
+
+/********************************************************************************
+* person_occupation_count: Antal personer med ett visst yrke.
+********************************************************************************/
+typedef struct person_occupation_count
+{
+   const char* occupation; /* Pekare till yrket i strängpoolen. */
+   size_t count;           /* Antal personer med yrket. */
+} person_occupation_count_t;
+
+/********************************************************************************
+* person_query_run: Kör angiven fråga parallellt över samtliga poster i angiven
+*                   person_store och slår samman delresultaten i angivet
+*                   resultat, som måste vara initierat av anroparen. Vid
+*                   lyckad körning returneras 0, annars returneras 1.
+*
+*                   - self   : Pekare till frågan som ska köras.
+*                   - store  : Pekare till aktuell person_store.
+*                   - workers: Pekare till trådpoolen (null = enbart anropande tråd).
+*                   - result : Pekare till det slutliga resultatet.
+********************************************************************************/
+int person_query_run(const struct person_query* self,
+                     const struct person_store* store,
+                     struct person_workers* workers,
+                     void* result);
+
+/********************************************************************************
+* person_query_count_if: Returnerar antalet poster för vilka angivet filter
+*                        returnerar ett annat värde än 0.
+*
+*                        - store  : Pekare till aktuell person_store.
+*                        - workers: Pekare till trådpoolen (null = enbart anropande tråd).
+*                        - filter : Filter som anropas med postens index.
+*                        - context: Kontext som passeras till filtret.
+********************************************************************************/
+size_t person_query_count_if(const struct person_store* store,
+                             struct person_workers* workers,
+                             int (*filter)(const struct person_store* store,
+                                           const size_t index,
+                                           void* context),
+                             void* context);
+
+/********************************************************************************
+* person_query_gender_histogram: Räknar antalet personer av respektive kön och
+*                                lagrar resultatet i angiven array, indexerad
+*                                via enumerationen gender.
+*
+*                                - store  : Pekare till aktuell person_store.
+*                                - workers: Pekare till trådpoolen (eller null).
+*                                - counts : Array som rymmer GENDER_NONE + 1 värden.
+********************************************************************************/
+void person_query_gender_histogram(const struct person_store* store,
+                                   struct person_workers* workers,
+                                   size_t* counts);
+
+/********************************************************************************
+* person_query_age_stats: Beräknar åldersstatistik för samtliga personer.
+*
+*                         - store  : Pekare till aktuell person_store.
+*                         - workers: Pekare till trådpoolen (eller null).
+*                         - stats  : Pekare till strukten där statistiken lagras.
+********************************************************************************/
+void person_query_age_stats(const struct person_store* store,
+                            struct person_workers* workers,
+                            struct person_age_stats* stats);
+
+/********************************************************************************
+* person_query_occupation_counts: Räknar antalet personer per yrke. En
+*                                 dynamiskt allokerad array sorterad efter
+*                                 antal i fallande ordning lagras på angiven
+*                                 adress och ska frigöras via free. Antalet
+*                                 unika yrken returneras. Om minnesallokeringen
+*                                 misslyckas så lagras null och 0 returneras.
+*
+*                                 - store  : Pekare till aktuell person_store.
+*                                 - workers: Pekare till trådpoolen (eller null).
+*                                 - counts : Adress där pekaren till arrayen lagras.
+********************************************************************************/
+size_t person_query_occupation_counts(const struct person_store* store,
+                                      struct person_workers* workers,
+                                      struct person_occupation_count** counts);
+
+#endif /* PERSON_QUERY_H_ */
@@ -0,0 +1,326 @@
+/********************************************************************************
+* person_reader.c: Innehåller definitioner av associerade funktioner
+*                  tillhörande strukten person_reader, som används för
+*                  inkrementell inläsning av persondata i textformat.
+********************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "person_reader.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Avskiljare som omger varje post, se person_print. */
+#define PERSON_READER_SEPARATOR \
+   "--------------------------------------------------------------------------------"
+
+/* Antal textfält per post. */
+#define PERSON_READER_FIELD_COUNT 5
+
+/********************************************************************************
+* person_reader_source: Källa som text läses från, antingen en inström eller
+*                       en fildeskriptor.
+********************************************************************************/
+struct person_reader_source
+{
+   FILE* istream; /* Inström att läsa från, eller null. */
+   int fd;        /* Fildeskriptor att läsa från om istream är null. */
+};
+
+/* Etiketter för respektive fält i den ordning de skrivs av person_print. */
+static const char* person_reader_labels[PERSON_READER_FIELD_COUNT] =
+{
+   "Name: ", "Age: ", "Address: ", "Occupation: ", "Gender: "
+};
+
+/* Statiska funktioner: */
+static int person_reader_run(struct person_reader* self,
+                             const struct person_reader_source* source,
+                             person_reader_callback_t callback,
+                             void* context);
+static int person_reader_fill(const struct person_reader_source* source,
+                              char* buffer,
+                              const size_t capacity,
+                              size_t* count);
+static int person_reader_parse_uint(const char* s,
+                                    unsigned int* value);
+static int person_reader_store_callback(void* context,
+                                        const char* name,
+                                        const unsigned int age,
+                                        const char* address,
+                                        const char* occupation,
+                                        const enum gender gender);
+
+/********************************************************************************
+* person_reader_init: Initierar en ny person_reader med en buffert av angiven
+*                     storlek. Vid lyckad allokering returneras 0, annars 1.
+*
+*                     - self    : Pekare till objektet som ska initieras.
+*                     - capacity: Buffertens storlek i bytes (0 = 64 kB).
+********************************************************************************/
+int person_reader_init(struct person_reader* self,
+                       const size_t capacity)
+{
+   self->capacity = capacity ? capacity : 64 * 1024;
+   self->buffer = (char*)malloc(self->capacity);
+   self->line = 0;
+   self->count = 0;
+
+   if (!self->buffer)
+   {
+      self->capacity = 0;
+      return 1;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_reader_clear: Frigör bufferten och nollställer angiven person_reader.
+*
+*                      - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_reader_clear(struct person_reader* self)
+{
+   free(self->buffer);
+   self->buffer = 0;
+   self->capacity = 0;
+   self->line = 0;
+   self->count = 0;
+   return;
+}
+
+/********************************************************************************
+* person_reader_read_file: Läser samtliga poster från angiven inström och anropar
+*                          angiven callback för varje post. Vid lyckad inläsning
+*                          returneras 0. Vid läsfel, felaktigt format, för lång
+*                          post eller avbrott från callback returneras 1, där
+*                          radnumret för felet lagras i self->line.
+*
+*                          - self    : Pekare till aktuell person_reader.
+*                          - istream : Pekare till inströmmen.
+*                          - callback: Funktion som anropas för varje post.
+*                          - context : Kontext som passeras till callback.
+********************************************************************************/
+int person_reader_read_file(struct person_reader* self,
+                            FILE* istream,
+                            person_reader_callback_t callback,
+                            void* context)
+{
+   const struct person_reader_source source = { istream, -1 };
+   return person_reader_run(self, &source, callback, context);
+}
+
+/********************************************************************************
+* person_reader_read_fd: Läser samtliga poster från angiven fildeskriptor och
+*                        anropar angiven callback för varje post. Returvärdet
+*                        motsvarar det från person_reader_read_file.
+*
+*                        - self    : Pekare till aktuell person_reader.
+*                        - fd      : Fildeskriptor att läsa från.
+*                        - callback: Funktion som anropas för varje post.
+*                        - context : Kontext som passeras till callback.
+********************************************************************************/
+int person_reader_read_fd(struct person_reader* self,
+                          const int fd,
+                          person_reader_callback_t callback,
+                          void* context)
+{
+   const struct person_reader_source source = { 0, fd };
+   return person_reader_run(self, &source, callback, context);
+}
+
+/********************************************************************************
+* person_reader_read_store: Läser samtliga poster från angiven inström och
+*                           lägger till dessa sist i angiven person_store.
+*                           Returvärdet motsvarar det från
+*                           person_reader_read_file.
+*
+*                           - self   : Pekare till aktuell person_reader.
+*                           - istream: Pekare till inströmmen.
+*                           - store  : Pekare till aktuell person_store.
+********************************************************************************/
+int person_reader_read_store(struct person_reader* self,
+                             FILE* istream,
+                             struct person_store* store)
+{
+   return person_reader_read_file(self, istream, &person_reader_store_callback, store);
+}
+
+/********************************************************************************
+* person_reader_run: Läser och tolkar text från angiven källa post för post.
+*                    Varje post tolkas på plats i bufferten, där radsluten
+*                    ersätts med nolltecken. När bufferten saknar ett helt
+*                    radslut flyttas den påbörjade posten till buffertens
+*                    början innan mer text läses in. Vid lyckad inläsning
+*                    returneras 0, annars returneras 1.
+*
+*                    - self    : Pekare till aktuell person_reader.
+*                    - source  : Pekare till källan som ska läsas.
+*                    - callback: Funktion som anropas för varje post.
+*                    - context : Kontext som passeras till callback.
+********************************************************************************/
+static int person_reader_run(struct person_reader* self,
+                             const struct person_reader_source* source,
+                             person_reader_callback_t callback,
+                             void* context)
+{
+   char* buffer = self->buffer;
+   size_t size = 0;     /* Antal giltiga bytes i bufferten. */
+   size_t position = 0; /* Början av nästa otolkade rad. */
+   size_t record = 0;   /* Början av aktuell post. */
+   size_t fields[PERSON_READER_FIELD_COUNT]; /* Fältens offset från postens början. */
+   size_t state = 0;    /* 0 = mellan poster, 1-5 = fält, 6 = avslutande avskiljare. */
+   int eof = 0;
+
+   self->line = 0;
+   self->count = 0;
+
+   for (;;)
+   {
+      char* newline = position < size ? (char*)memchr(buffer + position, '\n', size - position) : 0;
+
+      if (!newline)
+      {
+         const size_t keep = state ? record : position;
+         memmove(buffer, buffer + keep, size - keep);
+         size -= keep;
+         position -= keep;
+         record -= state ? keep : record;
+
+         if (eof)
+         {
+            if (position == size) return state ? 1 : 0;
+            if (size == self->capacity) return 1;
+            buffer[size++] = '\n';
+            continue;
+         }
+
+         size_t count;
+         if (size == self->capacity) return 1;
+         if (person_reader_fill(source, buffer + size, self->capacity - size, &count)) return 1;
+         eof = count == 0;
+         size += count;
+         continue;
+      }
+
+      char* line = buffer + position;
+      size_t length = (size_t)(newline - line);
+      position += length + 1;
+      self->line++;
+
+      *newline = '\0';
+      if (length && line[length - 1] == '\r') line[--length] = '\0';
+
+      if (state == 0)
+      {
+         if (!length) continue;
+         if (strcmp(line, PERSON_READER_SEPARATOR)) return 1;
+         record = (size_t)(line - buffer);
+         state = 1;
+      }
+      else if (state <= PERSON_READER_FIELD_COUNT)
+      {
+         const char* label = person_reader_labels[state - 1];
+         const size_t label_length = strlen(label);
+         if (strncmp(line, label, label_length)) return 1;
+         fields[state - 1] = (size_t)(line - buffer) + label_length - record;
+         state++;
+      }
+      else
+      {
+         const char* s = buffer + record;
+         unsigned int age;
+
+         if (strcmp(line, PERSON_READER_SEPARATOR) ||
+             person_reader_parse_uint(s + fields[1], &age) ||
+             callback(context, s + fields[0], age, s + fields[2], s + fields[3],
+                      gender_from_str(s + fields[4])))
+         {
+            return 1;
+         }
+
+         self->count++;
+         state = 0;
+      }
+   }
+}
+
+/********************************************************************************
+* person_reader_fill: Läser upp till angivet antal bytes från angiven källa och
+*                     lagrar antalet lästa bytes på angiven adress, där 0
+*                     indikerar filslut. Vid läsfel returneras 1, annars 0.
+*
+*                     - source  : Pekare till källan som ska läsas.
+*                     - buffer  : Buffert som texten ska lagras i.
+*                     - capacity: Maximalt antal bytes att läsa.
+*                     - count   : Adress där antalet lästa bytes lagras.
+********************************************************************************/
+static int person_reader_fill(const struct person_reader_source* source,
+                              char* buffer,
+                              const size_t capacity,
+                              size_t* count)
+{
+   if (source->istream)
+   {
+      *count = fread(buffer, 1, capacity, source->istream);
+      return *count == 0 && ferror(source->istream);
+   }
+
+   for (;;)
+   {
+      const ssize_t result = read(source->fd, buffer, capacity);
+
+      if (result >= 0)
+      {
+         *count = (size_t)result;
+         return 0;
+      }
+      if (errno != EINTR) return 1;
+   }
+}
+
+/********************************************************************************
+* person_reader_parse_uint: Omvandlar angiven decimal text till ett heltal. Vid
+*                           tom text, ogiltiga tecken eller överspill returneras
+*                           1, annars returneras 0.
+*
+*                           - s    : Texten som ska omvandlas.
+*                           - value: Adress där heltalet lagras.
+********************************************************************************/
+static int person_reader_parse_uint(const char* s,
+                                    unsigned int* value)
+{
+   unsigned long long result = 0;
+   if (!*s) return 1;
+
+   for (; *s; ++s)
+   {
+      if (*s < '0' || *s > '9') return 1;
+      result = result * 10 + (unsigned long long)(*s - '0');
+      if (result > 0xFFFFFFFFULL) return 1;
+   }
+
+   *value = (unsigned int)result;
+   return 0;
+}
+
+/********************************************************************************
+* person_reader_store_callback: Lägger till en inläst post i den person_store
+*                               som passeras som kontext.
+*
+*                               - context   : Pekare till aktuell person_store.
+*                               - name      : Personens namn.
+*                               - age       : Personens ålder.
+*                               - address   : Personens hemadress.
+*                               - occupation: Personens yrke.
+*                               - gender    : Personens kön.
+********************************************************************************/
+static int person_reader_store_callback(void* context,
+                                        const char* name,
+                                        const unsigned int age,
+                                        const char* address,
+                                        const char* occupation,
+                                        const enum gender gender)
+{
+   return person_store_push((struct person_store*)context, name, age, address,
+                            occupation, gender);
+}
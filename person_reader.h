@@ -0,0 +1,110 @@
+/********************************************************************************
+* person_reader.h: Innehåller funktionalitet för inläsning av persondata i det
+*                  textformat som skrivs av person_print (exempelvis filen
+*                  "persons.txt") via strukten person_reader. Inläsningen sker
+*                  inkrementellt via en buffert av fast storlek, vilket gör att
+*                  godtyckligt stora filer kan läsas med begränsat minne.
+*                  Radslut letas upp via memchr och ingen allokering sker per
+*                  rad eller post. Både LF och CRLF som radslut accepteras.
+********************************************************************************/
+#ifndef PERSON_READER_H_
+#define PERSON_READER_H_
+
+/* Inkluderingsdirektiv: */
+#include "person_store.h"
+
+/********************************************************************************
+* person_reader_callback_t: Funktionspekare som anropas för varje inläst post.
+*                           Strängarna är giltiga endast under anropet. Om
+*                           funktionen returnerar ett annat värde än 0 så
+*                           avbryts inläsningen.
+*
+*                           - context   : Kontext angiven vid inläsningen.
+*                           - name      : Personens namn.
+*                           - age       : Personens ålder.
+*                           - address   : Personens hemadress.
+*                           - occupation: Personens yrke.
+*                           - gender    : Personens kön.
+********************************************************************************/
+typedef int (*person_reader_callback_t)(void* context,
+                                        const char* name,
+                                        const unsigned int age,
+                                        const char* address,
+                                        const char* occupation,
+                                        const enum gender gender);
+
+/********************************************************************************
+* person_reader: Strukt för inkrementell inläsning av persondata i textformat.
+********************************************************************************/
+typedef struct person_reader
+{
+   char* buffer;    /* Buffert innehållande inläst men ej tolkad text. */
+   size_t capacity; /* Buffertens kapacitet i bytes, tillika största postlängd. */
+   size_t line;     /* Aktuellt radnummer, används vid felrapportering. */
+   size_t count;    /* Antal poster lästa vid senaste inläsningen. */
+} person_reader_t, *person_reader_ptr_t;
+
+/********************************************************************************
+* person_reader_init: Initierar en ny person_reader med en buffert av angiven
+*                     storlek. Vid lyckad allokering returneras 0, annars 1.
+*
+*                     - self    : Pekare till objektet som ska initieras.
+*                     - capacity: Buffertens storlek i bytes (0 = 64 kB).
+********************************************************************************/
+int person_reader_init(struct person_reader* self,
+                       const size_t capacity);
+
+/********************************************************************************
+* person_reader_clear: Frigör bufferten och nollställer angiven person_reader.
+*
+*                      - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_reader_clear(struct person_reader* self);
+
+/********************************************************************************
+* person_reader_read_file: Läser samtliga poster från angiven inström och anropar
+*                          angiven callback för varje post. Vid lyckad inläsning
+*                          returneras 0. Vid läsfel, felaktigt format, för lång
+*                          post eller avbrott från callback returneras 1, där
+*                          radnumret för felet lagras i self->line.
+*
+*                          - self    : Pekare till aktuell person_reader.
+*                          - istream : Pekare till inströmmen.
+*                          - callback: Funktion som anropas för varje post.
+*                          - context : Kontext som passeras till callback.
+********************************************************************************/
+int person_reader_read_file(struct person_reader* self,
+                            FILE* istream,
+                            person_reader_callback_t callback,
+                            void* context);
+
+/********************************************************************************
+* person_reader_read_fd: Läser samtliga poster från angiven fildeskriptor och
+*                        anropar angiven callback för varje post. Returvärdet
+*                        motsvarar det från person_reader_read_file.
+*
+*                        - self    : Pekare till aktuell person_reader.
+*                        - fd      : Fildeskriptor att läsa från.
+*                        - callback: Funktion som anropas för varje post.
+*                        - context : Kontext som passeras till callback.
+********************************************************************************/
+int person_reader_read_fd(struct person_reader* self,
+                          const int fd,
+                          person_reader_callback_t callback,
+                          void* context);
+
+/********************************************************************************
+* person_reader_read_store: Läser samtliga poster från angiven inström och
+*                           lägger till dessa sist i angiven person_store.
+*                           Returvärdet motsvarar det från
+*                           person_reader_read_file.
+*
+*                           - self   : Pekare till aktuell person_reader.
+*                           - istream: Pekare till inströmmen.
+*                           - store  : Pekare till aktuell person_store.
+********************************************************************************/
+int person_reader_read_store(struct person_reader* self,
+                             FILE* istream,
+                             struct person_store* store);
+
+#endif /* PERSON_READER_H_ */
@@ -0,0 +1,656 @@
+/********************************************************************************
+* person_registry.c: Innehåller definitioner av associerade funktioner
+*                    tillhörande strukten person_registry, som används för
+*                    delning av person-objekt mellan trådar.
+*
+*                    Varje läsare annonserar den globala epoken när den går
+*                    in i en lässektion och 0 när den lämnar den. Minne som
+*                    kopplas bort märks med epoken vid bortkopplingen, varefter
+*                    epoken räknas upp. Minnet frigörs när samtliga aktiva
+*                    läsare har annonserat en senare epok, eftersom dessa
+*                    läsare gick in efter bortkopplingen och inte kan ha sett
+*                    det bortkopplade minnet.
+********************************************************************************/
+#include "person_registry.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Cachelinjens storlek, varje läsare placeras på en separat cachelinje. */
+#define PERSON_REGISTRY_CACHE_LINE 64
+
+/* Antal platser i hashtabellen om ingen kapacitet anges. */
+#define PERSON_REGISTRY_DEFAULT_CAPACITY 64
+
+/********************************************************************************
+* person_registry_garbage: Huvud för minne som väntar på att frigöras. Ligger
+*                          först i samtliga strukter som frigörs uppskjutet.
+********************************************************************************/
+struct person_registry_garbage
+{
+   struct person_registry_garbage* next;                  /* Nästa objekt i listan. */
+   uint64_t epoch;                                        /* Epok vid bortkopplingen. */
+   void (*destroy)(struct person_registry_garbage* self); /* Frigör objektet. */
+};
+
+/********************************************************************************
+* person_registry_record: Ett oföränderligt person-objekt med tillhörande
+*                         strängar, som ersätts i sin helhet vid uppdatering.
+********************************************************************************/
+struct person_registry_record
+{
+   struct person_registry_garbage garbage; /* Huvud för uppskjuten frigöring. */
+   struct person person;                   /* Objektet som returneras till läsare. */
+   char strings[];                         /* Namn, adress samt yrke i följd. */
+};
+
+/********************************************************************************
+* person_registry_entry: Plats i en kedja i hashtabellen.
+********************************************************************************/
+struct person_registry_entry
+{
+   struct person_registry_garbage garbage;        /* Huvud för uppskjuten frigöring. */
+   struct person_registry_entry* _Atomic next;    /* Nästa plats i kedjan. */
+   uint64_t id;                                   /* Objektets id. */
+   struct person_registry_record* _Atomic record; /* Aktuell version av objektet. */
+};
+
+/********************************************************************************
+* person_registry_table: Hashtabell med kedjor, där antalet kedjor är en
+*                        tvåpotens.
+********************************************************************************/
+struct person_registry_table
+{
+   struct person_registry_garbage garbage;          /* Huvud för uppskjuten frigöring. */
+   size_t mask;                                     /* Antal kedjor minus ett. */
+   struct person_registry_entry* _Atomic buckets[]; /* Första platsen i varje kedja. */
+};
+
+/********************************************************************************
+* person_registry_reader: En registrerad läsare.
+********************************************************************************/
+struct person_registry_reader
+{
+   _Atomic uint64_t epoch;              /* Annonserad epok, 0 utanför lässektion. */
+   struct person_registry* registry;    /* Registret som läsaren tillhör. */
+   struct person_registry_reader* next; /* Nästa läsare i listan. */
+};
+
+/* Statiska funktioner: */
+static uint64_t person_registry_hash(const uint64_t id);
+static struct person_registry_table* person_registry_table_new(const size_t bucket_count);
+static struct person_registry_table* person_registry_grow(struct person_registry* self,
+                                                          struct person_registry_table* table);
+static struct person_registry_record* person_registry_record_new(const char* name,
+                                                                 const unsigned int age,
+                                                                 const char* address,
+                                                                 const char* occupation,
+                                                                 const enum gender gender);
+static void person_registry_record_destroy(struct person_registry_garbage* self);
+static void person_registry_free(struct person_registry_garbage* self);
+static void person_registry_retire(struct person_registry* self,
+                                   struct person_registry_garbage* garbage);
+static size_t person_registry_collect(struct person_registry* self);
+
+/********************************************************************************
+* person_registry_init: Initierar ett nytt tomt register. Vid lyckad
+*                       initiering returneras 0, annars returneras 1.
+*
+*                       - self    : Pekare till registret som ska initieras.
+*                       - capacity: Förväntat antal poster (0 = default).
+********************************************************************************/
+int person_registry_init(struct person_registry* self,
+                         const size_t capacity)
+{
+   size_t bucket_count = PERSON_REGISTRY_DEFAULT_CAPACITY;
+   while (bucket_count < capacity) bucket_count *= 2;
+
+   struct person_registry_table* table = person_registry_table_new(bucket_count);
+   if (!table) return 1;
+
+   if (pthread_mutex_init(&self->mutex, 0))
+   {
+      free(table);
+      return 1;
+   }
+
+   atomic_init(&self->table, table);
+   atomic_init(&self->epoch, 1);
+   atomic_init(&self->size, 0);
+   self->readers = 0;
+   self->garbage = 0;
+   self->garbage_count = 0;
+   return 0;
+}
+
+/********************************************************************************
+* person_registry_clear: Frigör samtliga poster, läsare och allokerat minne.
+*                        Får endast anropas när inga andra trådar använder
+*                        registret.
+*
+*                        - self: Pekare till registret som ska nollställas.
+********************************************************************************/
+void person_registry_clear(struct person_registry* self)
+{
+   struct person_registry_table* table = atomic_load_explicit(&self->table, memory_order_relaxed);
+
+   while (self->garbage)
+   {
+      struct person_registry_garbage* next = self->garbage->next;
+      self->garbage->destroy(self->garbage);
+      self->garbage = next;
+   }
+
+   for (size_t i = 0; table && i <= table->mask; ++i)
+   {
+      struct person_registry_entry* entry = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+
+      while (entry)
+      {
+         struct person_registry_entry* next = atomic_load_explicit(&entry->next, memory_order_relaxed);
+         person_registry_record_destroy(&atomic_load_explicit(&entry->record, memory_order_relaxed)->garbage);
+         free(entry);
+         entry = next;
+      }
+   }
+
+   while (self->readers)
+   {
+      struct person_registry_reader* next = self->readers->next;
+      free(self->readers);
+      self->readers = next;
+   }
+
+   free(table);
+   atomic_store_explicit(&self->table, 0, memory_order_relaxed);
+   atomic_store_explicit(&self->size, 0, memory_order_relaxed);
+   self->garbage_count = 0;
+   pthread_mutex_destroy(&self->mutex);
+   return;
+}
+
+/********************************************************************************
+* person_registry_reader_new: Registrerar en ny läsare och returnerar en pekare
+*                             till denna. Varje tråd som läser ur registret
+*                             behöver en egen läsare. Om minnesallokeringen
+*                             misslyckas returneras null.
+*
+*                             - self: Pekare till aktuellt register.
+********************************************************************************/
+struct person_registry_reader* person_registry_reader_new(struct person_registry* self)
+{
+   const size_t size = (sizeof(struct person_registry_reader) + PERSON_REGISTRY_CACHE_LINE - 1) /
+      PERSON_REGISTRY_CACHE_LINE * PERSON_REGISTRY_CACHE_LINE;
+   struct person_registry_reader* reader =
+      (struct person_registry_reader*)aligned_alloc(PERSON_REGISTRY_CACHE_LINE, size);
+   if (!reader) return 0;
+
+   atomic_init(&reader->epoch, 0);
+   reader->registry = self;
+
+   pthread_mutex_lock(&self->mutex);
+   reader->next = self->readers;
+   self->readers = reader;
+   pthread_mutex_unlock(&self->mutex);
+   return reader;
+}
+
+/********************************************************************************
+* person_registry_reader_delete: Avregistrerar angiven läsare, frigör dess
+*                                minne och sätter motsvarande pekare till null.
+*                                Läsaren får inte befinna sig i en lässektion.
+*
+*                                - self  : Pekare till aktuellt register.
+*                                - reader: Adressen till pekaren till läsaren.
+********************************************************************************/
+void person_registry_reader_delete(struct person_registry* self,
+                                   struct person_registry_reader** reader)
+{
+   if (!*reader) return;
+   pthread_mutex_lock(&self->mutex);
+
+   for (struct person_registry_reader** i = &self->readers; *i; i = &(*i)->next)
+   {
+      if (*i == *reader)
+      {
+         *i = (*reader)->next;
+         break;
+      }
+   }
+
+   person_registry_collect(self);
+   pthread_mutex_unlock(&self->mutex);
+   free(*reader);
+   *reader = 0;
+   return;
+}
+
+/********************************************************************************
+* person_registry_read_begin: Påbörjar en lässektion för angiven läsare.
+*                             Objekt som returneras av person_registry_find
+*                             är giltiga tills lässektionen avslutas.
+*                             Lässektioner kan inte nästlas.
+*
+*                             - reader: Pekare till aktuell läsare.
+********************************************************************************/
+void person_registry_read_begin(struct person_registry_reader* reader)
+{
+   const uint64_t epoch = atomic_load_explicit(&reader->registry->epoch, memory_order_acquire);
+   atomic_store_explicit(&reader->epoch, epoch, memory_order_relaxed);
+
+   /* Annonseringen måste bli synlig innan någon pekare i tabellen läses. */
+   atomic_thread_fence(memory_order_seq_cst);
+   return;
+}
+
+/********************************************************************************
+* person_registry_read_end: Avslutar en lässektion för angiven läsare.
+*
+*                           - reader: Pekare till aktuell läsare.
+********************************************************************************/
+void person_registry_read_end(struct person_registry_reader* reader)
+{
+   atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+   return;
+}
+
+/********************************************************************************
+* person_registry_find: Returnerar en pekare till objektet med angivet id, eller
+*                       null om inget sådant objekt finns. Funktionen tar inga
+*                       lås och ska anropas inom en lässektion (eller av en
+*                       tråd som ensam ändrar registret). Objektet får inte
+*                       ändras eller nollställas av anroparen.
+*
+*                       - self: Pekare till aktuellt register.
+*                       - id  : Objektets id.
+********************************************************************************/
+const struct person* person_registry_find(const struct person_registry* self,
+                                          const uint64_t id)
+{
+   const struct person_registry_table* table = atomic_load_explicit(&self->table, memory_order_acquire);
+   struct person_registry_entry* entry =
+      atomic_load_explicit(&table->buckets[person_registry_hash(id) & table->mask], memory_order_acquire);
+
+   while (entry)
+   {
+      if (entry->id == id)
+      {
+         return &atomic_load_explicit(&entry->record, memory_order_acquire)->person;
+      }
+      entry = atomic_load_explicit(&entry->next, memory_order_acquire);
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_registry_put: Lagrar angiven persondata under angivet id. Om ett objekt
+*                      med samma id redan finns så ersätts det i sin helhet,
+*                      där läsare antingen ser det gamla eller det nya
+*                      objektet. Vid lyckad lagring returneras 0, annars
+*                      returneras 1.
+*
+*                      - self      : Pekare till aktuellt register.
+*                      - id        : Objektets id.
+*                      - name      : Personens namn.
+*                      - age       : Personens ålder.
+*                      - address   : Personens hemadress.
+*                      - occupation: Personens yrke.
+*                      - gender    : Personens kön.
+********************************************************************************/
+int person_registry_put(struct person_registry* self,
+                        const uint64_t id,
+                        const char* name,
+                        const unsigned int age,
+                        const char* address,
+                        const char* occupation,
+                        const enum gender gender)
+{
+   struct person_registry_record* record = person_registry_record_new(name, age, address,
+                                                                      occupation, gender);
+   if (!record) return 1;
+   pthread_mutex_lock(&self->mutex);
+
+   struct person_registry_table* table = atomic_load_explicit(&self->table, memory_order_relaxed);
+   const uint64_t hash = person_registry_hash(id);
+   struct person_registry_entry* entry =
+      atomic_load_explicit(&table->buckets[hash & table->mask], memory_order_relaxed);
+
+   while (entry && entry->id != id)
+   {
+      entry = atomic_load_explicit(&entry->next, memory_order_relaxed);
+   }
+
+   if (entry)
+   {
+      struct person_registry_record* old = atomic_exchange_explicit(&entry->record, record,
+                                                                    memory_order_acq_rel);
+      person_registry_retire(self, &old->garbage);
+   }
+   else
+   {
+      const size_t size = atomic_load_explicit(&self->size, memory_order_relaxed);
+      if (size >= table->mask + 1) table = person_registry_grow(self, table);
+
+      entry = (struct person_registry_entry*)malloc(sizeof(struct person_registry_entry));
+      if (!entry)
+      {
+         pthread_mutex_unlock(&self->mutex);
+         person_registry_record_destroy(&record->garbage);
+         return 1;
+      }
+
+      struct person_registry_entry* _Atomic* bucket = &table->buckets[hash & table->mask];
+      entry->garbage.destroy = &person_registry_free;
+      entry->id = id;
+      atomic_init(&entry->record, record);
+      atomic_init(&entry->next, atomic_load_explicit(bucket, memory_order_relaxed));
+      atomic_store_explicit(bucket, entry, memory_order_release);
+      atomic_store_explicit(&self->size, size + 1, memory_order_relaxed);
+   }
+
+   person_registry_collect(self);
+   pthread_mutex_unlock(&self->mutex);
+   return 0;
+}
+
+/********************************************************************************
+* person_registry_remove: Tar bort objektet med angivet id. Minnet frigörs när
+*                         inga läsare längre kan referera till objektet. Om
+*                         objektet togs bort returneras 0, annars returneras 1.
+*
+*                         - self: Pekare till aktuellt register.
+*                         - id  : Objektets id.
+********************************************************************************/
+int person_registry_remove(struct person_registry* self,
+                           const uint64_t id)
+{
+   pthread_mutex_lock(&self->mutex);
+   struct person_registry_table* table = atomic_load_explicit(&self->table, memory_order_relaxed);
+   struct person_registry_entry* _Atomic* link = &table->buckets[person_registry_hash(id) & table->mask];
+   struct person_registry_entry* entry = atomic_load_explicit(link, memory_order_relaxed);
+
+   while (entry && entry->id != id)
+   {
+      link = &entry->next;
+      entry = atomic_load_explicit(link, memory_order_relaxed);
+   }
+
+   if (!entry)
+   {
+      pthread_mutex_unlock(&self->mutex);
+      return 1;
+   }
+
+   /* Läsare som redan står på platsen kan fortfarande följa dess next-pekare. */
+   atomic_store_explicit(link, atomic_load_explicit(&entry->next, memory_order_relaxed),
+                         memory_order_release);
+   person_registry_retire(self, &atomic_load_explicit(&entry->record, memory_order_relaxed)->garbage);
+   person_registry_retire(self, &entry->garbage);
+   atomic_store_explicit(&self->size, atomic_load_explicit(&self->size, memory_order_relaxed) - 1,
+                         memory_order_relaxed);
+
+   person_registry_collect(self);
+   pthread_mutex_unlock(&self->mutex);
+   return 0;
+}
+
+/********************************************************************************
+* person_registry_size: Returnerar antalet objekt i registret.
+*
+*                       - self: Pekare till aktuellt register.
+********************************************************************************/
+size_t person_registry_size(const struct person_registry* self)
+{
+   return atomic_load_explicit(&self->size, memory_order_relaxed);
+}
+
+/********************************************************************************
+* person_registry_reclaim: Frigör minne som inga läsare längre kan referera
+*                          till och returnerar antalet objekt som fortfarande
+*                          väntar på att frigöras. Anropas automatiskt vid
+*                          varje ändring, men kan även anropas explicit.
+*
+*                          - self: Pekare till aktuellt register.
+********************************************************************************/
+size_t person_registry_reclaim(struct person_registry* self)
+{
+   pthread_mutex_lock(&self->mutex);
+   const size_t pending = person_registry_collect(self);
+   pthread_mutex_unlock(&self->mutex);
+   return pending;
+}
+
+/********************************************************************************
+* person_registry_hash: Returnerar ett hashvärde för angivet id, där samtliga
+*                       bitar i id påverkar de lägre bitarna i hashvärdet.
+*
+*                       - id: Id:t som ska hashas.
+********************************************************************************/
+static uint64_t person_registry_hash(const uint64_t id)
+{
+   uint64_t hash = id + 0x9e3779b97f4a7c15ull;
+   hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+   hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+   return hash ^ (hash >> 31);
+}
+
+/********************************************************************************
+* person_registry_table_new: Allokerar en ny tom hashtabell med angivet antal
+*                            kedjor. Om minnesallokeringen misslyckas
+*                            returneras null.
+*
+*                            - bucket_count: Antal kedjor (en tvåpotens).
+********************************************************************************/
+static struct person_registry_table* person_registry_table_new(const size_t bucket_count)
+{
+   struct person_registry_table* self = (struct person_registry_table*)malloc(
+      sizeof(struct person_registry_table) + bucket_count * sizeof(struct person_registry_entry*));
+   if (!self) return 0;
+
+   self->garbage.destroy = &person_registry_free;
+   self->mask = bucket_count - 1;
+
+   for (size_t i = 0; i < bucket_count; ++i)
+   {
+      atomic_init(&self->buckets[i], 0);
+   }
+   return self;
+}
+
+/********************************************************************************
+* person_registry_grow: Ersätter angiven hashtabell med en dubbelt så stor
+*                       tabell och returnerar den nya tabellen. Eftersom läsare
+*                       kan befinna sig i den gamla tabellen flyttas inga
+*                       platser, utan nya platser som pekar på samma objekt
+*                       skapas. Den gamla tabellen frigörs uppskjutet. Om
+*                       minnesallokeringen misslyckas returneras den gamla
+*                       tabellen, som då fortsätter att användas.
+*
+*                       - self : Pekare till aktuellt register.
+*                       - table: Pekare till aktuell hashtabell.
+********************************************************************************/
+static struct person_registry_table* person_registry_grow(struct person_registry* self,
+                                                          struct person_registry_table* table)
+{
+   struct person_registry_table* grown = person_registry_table_new((table->mask + 1) * 2);
+   if (!grown) return table;
+
+   for (size_t i = 0; i <= table->mask; ++i)
+   {
+      struct person_registry_entry* entry = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+
+      for (; entry; entry = atomic_load_explicit(&entry->next, memory_order_relaxed))
+      {
+         struct person_registry_entry* copy = (struct person_registry_entry*)malloc(
+            sizeof(struct person_registry_entry));
+
+         if (!copy)
+         {
+            for (size_t j = 0; j <= grown->mask; ++j)
+            {
+               struct person_registry_entry* k = atomic_load_explicit(&grown->buckets[j], memory_order_relaxed);
+
+               while (k)
+               {
+                  struct person_registry_entry* next = atomic_load_explicit(&k->next, memory_order_relaxed);
+                  free(k);
+                  k = next;
+               }
+            }
+            free(grown);
+            return table;
+         }
+
+         struct person_registry_entry* _Atomic* bucket =
+            &grown->buckets[person_registry_hash(entry->id) & grown->mask];
+         copy->garbage.destroy = &person_registry_free;
+         copy->id = entry->id;
+         atomic_init(&copy->record, atomic_load_explicit(&entry->record, memory_order_relaxed));
+         atomic_init(&copy->next, atomic_load_explicit(bucket, memory_order_relaxed));
+         atomic_store_explicit(bucket, copy, memory_order_relaxed);
+      }
+   }
+
+   atomic_store_explicit(&self->table, grown, memory_order_release);
+
+   for (size_t i = 0; i <= table->mask; ++i)
+   {
+      struct person_registry_entry* entry = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+
+      while (entry)
+      {
+         struct person_registry_entry* next = atomic_load_explicit(&entry->next, memory_order_relaxed);
+         person_registry_retire(self, &entry->garbage);
+         entry = next;
+      }
+   }
+
+   person_registry_retire(self, &table->garbage);
+   return grown;
+}
+
+/********************************************************************************
+* person_registry_record_new: Allokerar ett nytt objekt innehållande kopior av
+*                             angivna strängar. Om minnesallokeringen
+*                             misslyckas returneras null.
+*
+*                             - name      : Personens namn.
+*                             - age       : Personens ålder.
+*                             - address   : Personens hemadress.
+*                             - occupation: Personens yrke.
+*                             - gender    : Personens kön.
+********************************************************************************/
+static struct person_registry_record* person_registry_record_new(const char* name,
+                                                                 const unsigned int age,
+                                                                 const char* address,
+                                                                 const char* occupation,
+                                                                 const enum gender gender)
+{
+   if (!name) name = "";
+   if (!address) address = "";
+   if (!occupation) occupation = "";
+
+   const size_t name_size = strlen(name) + 1;
+   const size_t address_size = strlen(address) + 1;
+   const size_t occupation_size = strlen(occupation) + 1;
+   struct person_registry_record* self = (struct person_registry_record*)malloc(
+      sizeof(struct person_registry_record) + name_size + address_size + occupation_size);
+   if (!self) return 0;
+
+   char* s = self->strings;
+   memcpy(s, name, name_size);
+   memcpy(s + name_size, address, address_size);
+   memcpy(s + name_size + address_size, occupation, occupation_size);
+
+   person_init(&self->person, s, age, s + name_size, s + name_size + address_size, gender);
+   if (!self->person.mem)
+   {
+      free(self);
+      return 0;
+   }
+
+   self->garbage.destroy = &person_registry_record_destroy;
+   return self;
+}
+
+/********************************************************************************
+* person_registry_record_destroy: Nollställer och frigör angivet objekt.
+*
+*                                 - self: Pekare till objektets huvud.
+********************************************************************************/
+static void person_registry_record_destroy(struct person_registry_garbage* self)
+{
+   struct person_registry_record* record = (struct person_registry_record*)self;
+   person_clear(&record->person);
+   free(record);
+   return;
+}
+
+/********************************************************************************
+* person_registry_free: Frigör angivet minne, som inte kräver någon
+*                       nollställning (platser samt hashtabeller).
+*
+*                       - self: Pekare till minnets huvud.
+********************************************************************************/
+static void person_registry_free(struct person_registry_garbage* self)
+{
+   free(self);
+   return;
+}
+
+/********************************************************************************
+* person_registry_retire: Lägger till bortkopplat minne i listan över minne som
+*                         väntar på att frigöras, märkt med aktuell epok.
+*                         Anropas med registrets mutex låst.
+*
+*                         - self   : Pekare till aktuellt register.
+*                         - garbage: Pekare till minnets huvud.
+********************************************************************************/
+static void person_registry_retire(struct person_registry* self,
+                                   struct person_registry_garbage* garbage)
+{
+   garbage->epoch = atomic_load_explicit(&self->epoch, memory_order_seq_cst);
+   garbage->next = self->garbage;
+   self->garbage = garbage;
+   self->garbage_count++;
+   return;
+}
+
+/********************************************************************************
+* person_registry_collect: Räknar upp epoken och frigör minne som bortkopplats
+*                          före den äldsta epoken som annonseras av en aktiv
+*                          läsare. Antalet objekt som fortfarande väntar på att
+*                          frigöras returneras. Anropas med mutexen låst.
+*
+*                          - self: Pekare till aktuellt register.
+********************************************************************************/
+static size_t person_registry_collect(struct person_registry* self)
+{
+   if (!self->garbage) return 0;
+   uint64_t oldest = UINT64_MAX;
+
+   atomic_fetch_add_explicit(&self->epoch, 1, memory_order_seq_cst);
+   atomic_thread_fence(memory_order_seq_cst);
+
+   for (const struct person_registry_reader* i = self->readers; i; i = i->next)
+   {
+      const uint64_t epoch = atomic_load_explicit(&i->epoch, memory_order_acquire);
+      if (epoch && epoch < oldest) oldest = epoch;
+   }
+
+   for (struct person_registry_garbage** i = &self->garbage; *i;)
+   {
+      struct person_registry_garbage* garbage = *i;
+
+      if (garbage->epoch < oldest)
+      {
+         *i = garbage->next;
+         garbage->destroy(garbage);
+         self->garbage_count--;
+      }
+      else
+      {
+         i = &garbage->next;
+      }
+   }
+   return self->garbage_count;
+}
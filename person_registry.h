@@ -0,0 +1,169 @@
+/********************************************************************************
+* person_registry.h: Innehåller ett trådsäkert register över person-objekt
+*                    via strukten person_registry, där varje objekt
+*                    identifieras via ett unikt id. Läsare blockeras aldrig
+*                    av skrivare: uppslagning sker utan lås inom en
+*                    lässektion, medan skrivare serialiseras via en mutex och
+*                    ersätter poster i sin helhet. Ersatta och borttagna
+*                    poster frigörs först när samtliga läsare som kan ha
+*                    sett dem har lämnat sin lässektion (epokbaserad
+*                    återvinning).
+*
+*                    Exempel på läsning:
+*
+*                    person_registry_read_begin(reader);
+*                    const struct person* p = person_registry_find(&registry, id);
+*                    if (p) printf("%s\n", p->vptr->name(p));
+*                    person_registry_read_end(reader);
+********************************************************************************/
+#ifndef PERSON_REGISTRY_H_
+#define PERSON_REGISTRY_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+/* Interna strukter som definieras i person_registry.c. */
+struct person_registry_table;
+struct person_registry_reader;
+struct person_registry_garbage;
+
+/********************************************************************************
+* person_registry: Register över person-objekt indexerade via id. Registret
+*                  äger kopior av samtliga strängar.
+********************************************************************************/
+typedef struct person_registry
+{
+   struct person_registry_table* _Atomic table; /* Aktuell hashtabell. */
+   _Atomic uint64_t epoch;                      /* Global epok, räknas upp vid varje ändring. */
+   _Atomic size_t size;                         /* Antal poster i registret. */
+   struct person_registry_reader* readers;      /* Registrerade läsare. */
+   struct person_registry_garbage* garbage;     /* Minne som väntar på att frigöras. */
+   size_t garbage_count;                        /* Antal objekt som väntar på att frigöras. */
+   pthread_mutex_t mutex;                       /* Serialiserar skrivare. */
+} person_registry_t, *person_registry_ptr_t;
+
+/********************************************************************************
+* person_registry_init: Initierar ett nytt tomt register. Vid lyckad
+*                       initiering returneras 0, annars returneras 1.
+*
+*                       - self    : Pekare till registret som ska initieras.
+*                       - capacity: Förväntat antal poster (0 = default).
+********************************************************************************/
+int person_registry_init(struct person_registry* self,
+                         const size_t capacity);
+
+/********************************************************************************
+* person_registry_clear: Frigör samtliga poster, läsare och allokerat minne.
+*                        Får endast anropas när inga andra trådar använder
+*                        registret.
+*
+*                        - self: Pekare till registret som ska nollställas.
+********************************************************************************/
+void person_registry_clear(struct person_registry* self);
+
+/********************************************************************************
+* person_registry_reader_new: Registrerar en ny läsare och returnerar en pekare
+*                             till denna. Varje tråd som läser ur registret
+*                             behöver en egen läsare. Om minnesallokeringen
+*                             misslyckas returneras null.
+*
+*                             - self: Pekare till aktuellt register.
+********************************************************************************/
+struct person_registry_reader* person_registry_reader_new(struct person_registry* self);
+
+/********************************************************************************
+* person_registry_reader_delete: Avregistrerar angiven läsare, frigör dess
+*                                minne och sätter motsvarande pekare till null.
+*                                Läsaren får inte befinna sig i en lässektion.
+*
+*                                - self  : Pekare till aktuellt register.
+*                                - reader: Adressen till pekaren till läsaren.
+********************************************************************************/
+void person_registry_reader_delete(struct person_registry* self,
+                                   struct person_registry_reader** reader);
+
+/********************************************************************************
+* person_registry_read_begin: Påbörjar en lässektion för angiven läsare.
+*                             Objekt som returneras av person_registry_find
+*                             är giltiga tills lässektionen avslutas.
+*                             Lässektioner kan inte nästlas.
+*
+*                             - reader: Pekare till aktuell läsare.
+********************************************************************************/
+void person_registry_read_begin(struct person_registry_reader* reader);
+
+/********************************************************************************
+* person_registry_read_end: Avslutar en lässektion för angiven läsare.
+*
+*                           - reader: Pekare till aktuell läsare.
+********************************************************************************/
+void person_registry_read_end(struct person_registry_reader* reader);
+
+/********************************************************************************
+* person_registry_find: Returnerar en pekare till objektet med angivet id, eller
+*                       null om inget sådant objekt finns. Funktionen tar inga
+*                       lås och ska anropas inom en lässektion (eller av en
+*                       tråd som ensam ändrar registret). Objektet får inte
+*                       ändras eller nollställas av anroparen.
+*
+*                       - self: Pekare till aktuellt register.
+*                       - id  : Objektets id.
+********************************************************************************/
+const struct person* person_registry_find(const struct person_registry* self,
+                                          const uint64_t id);
+
+/********************************************************************************
+* person_registry_put: Lagrar angiven persondata under angivet id. Om ett objekt
+*                      med samma id redan finns så ersätts det i sin helhet,
+*                      där läsare antingen ser det gamla eller det nya
+*                      objektet. Vid lyckad lagring returneras 0, annars
+*                      returneras 1.
+*
+*                      - self      : Pekare till aktuellt register.
+*                      - id        : Objektets id.
+*                      - name      : Personens namn.
+*                      - age       : Personens ålder.
+*                      - address   : Personens hemadress.
+*                      - occupation: Personens yrke.
+*                      - gender    : Personens kön.
+********************************************************************************/
+int person_registry_put(struct person_registry* self,
+                        const uint64_t id,
+                        const char* name,
+                        const unsigned int age,
+                        const char* address,
+                        const char* occupation,
+                        const enum gender gender);
+
+/********************************************************************************
+* person_registry_remove: Tar bort objektet med angivet id. Minnet frigörs när
+*                         inga läsare längre kan referera till objektet. Om
+*                         objektet togs bort returneras 0, annars returneras 1.
+*
+*                         - self: Pekare till aktuellt register.
+*                         - id  : Objektets id.
+********************************************************************************/
+int person_registry_remove(struct person_registry* self,
+                           const uint64_t id);
+
+/********************************************************************************
+* person_registry_size: Returnerar antalet objekt i registret.
+*
+*                       - self: Pekare till aktuellt register.
+********************************************************************************/
+size_t person_registry_size(const struct person_registry* self);
+
+/********************************************************************************
+* person_registry_reclaim: Frigör minne som inga läsare längre kan referera
+*                          till och returnerar antalet objekt som fortfarande
+*                          väntar på att frigöras. Anropas automatiskt vid
+*                          varje ändring, men kan även anropas explicit.
+*
+*                          - self: Pekare till aktuellt register.
+********************************************************************************/
+size_t person_registry_reclaim(struct person_registry* self);
+
+#endif /* PERSON_REGISTRY_H_ */
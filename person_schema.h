@@ -0,0 +1,501 @@
+/********************************************************************************
+* person_schema.h: Innehåller makrot PERSON_SCHEMA, som utifrån en enda
+*                  fältlista (X-makro) genererar en postvariant av persondata
+*                  vid kompilering: lagringsstrukt, accessorer, vy med vtable,
+*                  utskrift samt binär kodning och avkodning. Varje variant
+*                  innehåller enbart de fält den behöver, och samtliga
+*                  funktioner är inline-definierade och specialiserade för
+*                  fältlistan.
+*
+*                  Varje fält anges som X(fält, typ, roll, "Etikett"), där
+*                  typ är STRING, U32, U64 eller GENDER och roll anger vilken
+*                  accessor i person_vtable som fältet motsvarar (NAME, AGE,
+*                  ADDRESS, OCCUPATION, GENDER eller NONE för övriga fält).
+*                  Accessorer för roller som saknas returnerar "", 0
+*                  respektive GENDER_NONE. Exempel:
+*
+*                  #define PERSON_COMPACT_FIELDS(X)              \
+*                     X(id, U64, NONE, "Id")                     \
+*                     X(name, STRING, NAME, "Name")              \
+*                     X(age, U32, AGE, "Age")                    \
+*                     X(gender, GENDER, GENDER, "Gender")
+*
+*                  PERSON_SCHEMA(person_compact, PERSON_COMPACT_FIELDS)
+*
+*                  Ovanstående genererar bland annat strukten person_compact
+*                  samt funktionerna person_compact_name, person_compact_view,
+*                  person_compact_format, person_compact_print,
+*                  person_compact_encode samt person_compact_decode, se
+*                  PERSON_SCHEMA nedan. Fälten placeras i fallande
+*                  storleksordning oavsett ordningen i listan, så att posten
+*                  inte innehåller onödig utfyllnad, medan utskrift och
+*                  kodning sker i listans ordning.
+********************************************************************************/
+#ifndef PERSON_SCHEMA_H_
+#define PERSON_SCHEMA_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Fältlista motsvarande person_mem, dvs. samtliga fält som skrivs av person_print. */
+#define PERSON_SCHEMA_DEFAULT_FIELDS(X)              \
+   X(name, STRING, NAME, "Name")                     \
+   X(age, U32, AGE, "Age")                           \
+   X(address, STRING, ADDRESS, "Address")            \
+   X(occupation, STRING, OCCUPATION, "Occupation")   \
+   X(gender, GENDER, GENDER, "Gender")
+
+/* Avgränsare som skrivs före och efter varje post, samma som för person_print. */
+#define PERSON_SCHEMA_SEPARATOR \
+   "--------------------------------------------------------------------------------\n"
+
+/********************************************************************************
+* person_schema_type: Enumeration för fälttyper.
+********************************************************************************/
+enum person_schema_type
+{
+   PERSON_SCHEMA_TYPE_STRING, /* Nollterminerad sträng (const char*). */
+   PERSON_SCHEMA_TYPE_U32,    /* Osignerat 32-bitars heltal. */
+   PERSON_SCHEMA_TYPE_U64,    /* Osignerat 64-bitars heltal. */
+   PERSON_SCHEMA_TYPE_GENDER  /* Kön, lagrat i en byte. */
+};
+
+/********************************************************************************
+* person_schema_role: Enumeration för den accessor i person_vtable som ett
+*                     fält motsvarar.
+********************************************************************************/
+enum person_schema_role
+{
+   PERSON_SCHEMA_ROLE_NONE,       /* Fältet nås enbart via genererade accessorer. */
+   PERSON_SCHEMA_ROLE_NAME,       /* Personens namn. */
+   PERSON_SCHEMA_ROLE_AGE,        /* Personens ålder. */
+   PERSON_SCHEMA_ROLE_ADDRESS,    /* Personens hemadress. */
+   PERSON_SCHEMA_ROLE_OCCUPATION, /* Personens yrke. */
+   PERSON_SCHEMA_ROLE_GENDER      /* Personens kön. */
+};
+
+/********************************************************************************
+* person_schema_uint_str: Skriver angivet heltal decimalt till angiven buffert,
+*                         som måste rymma minst 20 tecken, och returnerar
+*                         antalet skrivna tecken.
+*
+*                         - value : Heltalet som ska skrivas.
+*                         - digits: Buffert där siffrorna lagras.
+********************************************************************************/
+static inline size_t person_schema_uint_str(uint64_t value,
+                                            char* digits)
+{
+   char reversed[20];
+   size_t length = 0;
+
+   do
+   {
+      reversed[length++] = (char)('0' + value % 10);
+      value /= 10;
+   } while (value);
+
+   for (size_t i = 0; i < length; ++i)
+   {
+      digits[i] = reversed[length - 1 - i];
+   }
+   return length;
+}
+
+/********************************************************************************
+* person_schema_put: Skriver angivet heltal som little endian med angivet antal
+*                    bytes till angiven buffert och returnerar en pekare
+*                    direkt efter de skrivna byten.
+*
+*                    - s    : Buffert att skriva till.
+*                    - value: Heltalet som ska skrivas.
+*                    - size : Antal bytes.
+********************************************************************************/
+static inline unsigned char* person_schema_put(unsigned char* s,
+                                               uint64_t value,
+                                               const size_t size)
+{
+   for (size_t i = 0; i < size; ++i, value >>= 8)
+   {
+      s[i] = (unsigned char)value;
+   }
+   return s + size;
+}
+
+/********************************************************************************
+* person_schema_get: Läser ett heltal lagrat som little endian med angivet
+*                    antal bytes.
+*
+*                    - s   : Buffert att läsa från.
+*                    - size: Antal bytes.
+********************************************************************************/
+static inline uint64_t person_schema_get(const unsigned char* s,
+                                         const size_t size)
+{
+   uint64_t value = 0;
+
+   for (size_t i = size; i > 0; --i)
+   {
+      value = value << 8 | s[i - 1];
+   }
+   return value;
+}
+
+/* Medlemmar grupperade efter storlek: pekare och 64-bitars tal, 32-bitars tal, bytes. */
+#define PERSON_SCHEMA_WIDE_STRING(field) const char* field;
+#define PERSON_SCHEMA_WIDE_U64(field) uint64_t field;
+#define PERSON_SCHEMA_WIDE_U32(field)
+#define PERSON_SCHEMA_WIDE_GENDER(field)
+#define PERSON_SCHEMA_WORD_STRING(field)
+#define PERSON_SCHEMA_WORD_U64(field)
+#define PERSON_SCHEMA_WORD_U32(field) uint32_t field;
+#define PERSON_SCHEMA_WORD_GENDER(field)
+#define PERSON_SCHEMA_BYTE_STRING(field)
+#define PERSON_SCHEMA_BYTE_U64(field)
+#define PERSON_SCHEMA_BYTE_U32(field)
+#define PERSON_SCHEMA_BYTE_GENDER(field) uint8_t field;
+#define PERSON_SCHEMA_MEMBER_WIDE(field, type, role, label) PERSON_SCHEMA_WIDE_##type(field)
+#define PERSON_SCHEMA_MEMBER_WORD(field, type, role, label) PERSON_SCHEMA_WORD_##type(field)
+#define PERSON_SCHEMA_MEMBER_BYTE(field, type, role, label) PERSON_SCHEMA_BYTE_##type(field)
+
+/* Typ som krävs för fält med angiven roll. */
+#define PERSON_SCHEMA_ROLE_TYPE(role)                                  \
+   ((role) == PERSON_SCHEMA_ROLE_AGE ? PERSON_SCHEMA_TYPE_U32 :        \
+    (role) == PERSON_SCHEMA_ROLE_GENDER ? PERSON_SCHEMA_TYPE_GENDER :  \
+    PERSON_SCHEMA_TYPE_STRING)
+
+/* Antal fält med respektive roll. */
+#define PERSON_SCHEMA_IS(role, wanted) (PERSON_SCHEMA_ROLE_##role == PERSON_SCHEMA_ROLE_##wanted)
+#define PERSON_SCHEMA_COUNT_NAME(field, type, role, label) + PERSON_SCHEMA_IS(role, NAME)
+#define PERSON_SCHEMA_COUNT_AGE(field, type, role, label) + PERSON_SCHEMA_IS(role, AGE)
+#define PERSON_SCHEMA_COUNT_ADDRESS(field, type, role, label) + PERSON_SCHEMA_IS(role, ADDRESS)
+#define PERSON_SCHEMA_COUNT_OCCUPATION(field, type, role, label) + PERSON_SCHEMA_IS(role, OCCUPATION)
+#define PERSON_SCHEMA_COUNT_GENDER(field, type, role, label) + PERSON_SCHEMA_IS(role, GENDER)
+
+/* Läsning av fältet med angiven roll. Enbart fält av rollens typ genererar kod,
+   så att uttrycken alltid är korrekt typade. */
+#define PERSON_SCHEMA_RETURN(role, wanted, field) \
+   if (PERSON_SCHEMA_IS(role, wanted)) return self->field;
+#define PERSON_SCHEMA_STRING_STRING(role, wanted, field) PERSON_SCHEMA_RETURN(role, wanted, field)
+#define PERSON_SCHEMA_STRING_U32(role, wanted, field)
+#define PERSON_SCHEMA_STRING_U64(role, wanted, field)
+#define PERSON_SCHEMA_STRING_GENDER(role, wanted, field)
+#define PERSON_SCHEMA_U32_STRING(role, wanted, field)
+#define PERSON_SCHEMA_U32_U32(role, wanted, field) PERSON_SCHEMA_RETURN(role, wanted, field)
+#define PERSON_SCHEMA_U32_U64(role, wanted, field)
+#define PERSON_SCHEMA_U32_GENDER(role, wanted, field)
+#define PERSON_SCHEMA_GENDER_STRING(role, wanted, field)
+#define PERSON_SCHEMA_GENDER_U32(role, wanted, field)
+#define PERSON_SCHEMA_GENDER_U64(role, wanted, field)
+#define PERSON_SCHEMA_GENDER_GENDER(role, wanted, field) \
+   if (PERSON_SCHEMA_IS(role, wanted)) return (enum gender)self->field;
+#define PERSON_SCHEMA_GET_NAME(field, type, role, label) PERSON_SCHEMA_STRING_##type(role, NAME, field)
+#define PERSON_SCHEMA_GET_AGE(field, type, role, label) PERSON_SCHEMA_U32_##type(role, AGE, field)
+#define PERSON_SCHEMA_GET_ADDRESS(field, type, role, label) PERSON_SCHEMA_STRING_##type(role, ADDRESS, field)
+#define PERSON_SCHEMA_GET_OCCUPATION(field, type, role, label) PERSON_SCHEMA_STRING_##type(role, OCCUPATION, field)
+#define PERSON_SCHEMA_GET_GENDER(field, type, role, label) PERSON_SCHEMA_GENDER_##type(role, GENDER, field)
+
+/* Kontroll vid kompilering av att fältets typ passar dess roll. */
+#define PERSON_SCHEMA_CHECK(field, type, role, label)                                     \
+   _Static_assert(PERSON_SCHEMA_ROLE_##role == PERSON_SCHEMA_ROLE_NONE ||                 \
+                  PERSON_SCHEMA_ROLE_TYPE(PERSON_SCHEMA_ROLE_##role) == PERSON_SCHEMA_TYPE_##type, \
+                  "person_schema: field '" #field "' has the wrong type for its role");
+
+/* Förberedelse av fältets text inför utskrift: pekare till texten samt dess längd. */
+#define PERSON_SCHEMA_TEXT_STRING(field, value)                     \
+   const char* field##_text = (value) ? (value) : "(null)";         \
+   const size_t field##_length = strlen(field##_text);
+#define PERSON_SCHEMA_TEXT_U32(field, value)                        \
+   char field##_digits[20];                                         \
+   const char* field##_text = field##_digits;                       \
+   const size_t field##_length = person_schema_uint_str((value), field##_digits);
+#define PERSON_SCHEMA_TEXT_U64(field, value) PERSON_SCHEMA_TEXT_U32(field, value)
+#define PERSON_SCHEMA_TEXT_GENDER(field, value)                     \
+   const char* field##_text = gender_str((enum gender)(value));     \
+   const size_t field##_length = strlen(field##_text);
+#define PERSON_SCHEMA_TEXT(field, type, role, label) PERSON_SCHEMA_TEXT_##type(field, self->field)
+#define PERSON_SCHEMA_TEXT_LENGTH(field, type, role, label) + sizeof(label ": ") + field##_length
+#define PERSON_SCHEMA_TEXT_COPY(field, type, role, label)           \
+   memcpy(s, label ": ", sizeof(label ": ") - 1);                   \
+   s += sizeof(label ": ") - 1;                                     \
+   memcpy(s, field##_text, field##_length);                         \
+   s += field##_length;                                             \
+   *s++ = '\n';
+
+/* Binär kodning: heltal som little endian, strängar som längd (inklusive
+   nolltecken) följt av tecknen och nolltecknet. */
+#define PERSON_SCHEMA_STRING_OR_EMPTY(value) ((value) ? (value) : "")
+#define PERSON_SCHEMA_ENCODED_SIZE_STRING(value) (4 + strlen(PERSON_SCHEMA_STRING_OR_EMPTY(value)) + 1)
+#define PERSON_SCHEMA_ENCODED_SIZE_U32(value) 4
+#define PERSON_SCHEMA_ENCODED_SIZE_U64(value) 8
+#define PERSON_SCHEMA_ENCODED_SIZE_GENDER(value) 1
+#define PERSON_SCHEMA_ENCODED_SIZE(field, type, role, label) \
+   + PERSON_SCHEMA_ENCODED_SIZE_##type(self->field)
+#define PERSON_SCHEMA_ENCODE_STRING(value)                                    \
+   {                                                                          \
+      const char* string = PERSON_SCHEMA_STRING_OR_EMPTY(value);              \
+      const size_t string_size = strlen(string) + 1;                          \
+      s = person_schema_put(s, string_size, 4);                               \
+      memcpy(s, string, string_size);                                         \
+      s += string_size;                                                       \
+   }
+#define PERSON_SCHEMA_ENCODE_U32(value) s = person_schema_put(s, (value), 4);
+#define PERSON_SCHEMA_ENCODE_U64(value) s = person_schema_put(s, (value), 8);
+#define PERSON_SCHEMA_ENCODE_GENDER(value) *s++ = (unsigned char)(value);
+#define PERSON_SCHEMA_ENCODE(field, type, role, label) PERSON_SCHEMA_ENCODE_##type(self->field)
+#define PERSON_SCHEMA_DECODE_STRING(target)                                   \
+   {                                                                          \
+      if (end - s < 4) return 0;                                              \
+      const uint64_t string_size = person_schema_get(s, 4);                   \
+      s += 4;                                                                 \
+      if (!string_size || string_size > (uint64_t)(end - s) ||                \
+          s[string_size - 1] != '\0') return 0;                               \
+      target = (const char*)s;                                                \
+      s += string_size;                                                       \
+   }
+#define PERSON_SCHEMA_DECODE_U32(target)                                      \
+   if (end - s < 4) return 0;                                                 \
+   target = (uint32_t)person_schema_get(s, 4);                                \
+   s += 4;
+#define PERSON_SCHEMA_DECODE_U64(target)                                      \
+   if (end - s < 8) return 0;                                                 \
+   target = person_schema_get(s, 8);                                          \
+   s += 8;
+#define PERSON_SCHEMA_DECODE_GENDER(target)                                   \
+   if (end - s < 1 || *s > GENDER_NONE) return 0;                             \
+   target = *s++;
+#define PERSON_SCHEMA_DECODE(field, type, role, label) PERSON_SCHEMA_DECODE_##type(self->field)
+
+/* Tilldelning av fält med angiven roll från ett person-objekt. */
+#define PERSON_SCHEMA_ASSIGN_NONE(field)
+#define PERSON_SCHEMA_ASSIGN_NAME(field) self->field = person->vptr->name(person);
+#define PERSON_SCHEMA_ASSIGN_AGE(field) self->field = person->vptr->age(person);
+#define PERSON_SCHEMA_ASSIGN_ADDRESS(field) self->field = person->vptr->address(person);
+#define PERSON_SCHEMA_ASSIGN_OCCUPATION(field) self->field = person->vptr->occupation(person);
+#define PERSON_SCHEMA_ASSIGN_GENDER(field) self->field = (uint8_t)person->vptr->gender(person);
+#define PERSON_SCHEMA_ASSIGN(field, type, role, label) PERSON_SCHEMA_ASSIGN_##role(field)
+
+/********************************************************************************
+* PERSON_SCHEMA: Genererar en postvariant med angivet namn (prefix) utifrån
+*                angiven fältlista (fields). Följande genereras:
+*
+*                - struct prefix        : Posten, med fälten i fallande
+*                                         storleksordning.
+*                - prefix_name, prefix_age, prefix_address, prefix_occupation,
+*                  prefix_gender        : Accessorer för respektive roll.
+*                - prefix_from_person   : Kopierar rollernas värden från ett
+*                                         person-objekt (strängarna kopieras ej).
+*                - prefix_format        : Formaterar posten till en buffert på
+*                                         samma sätt som person_writer_format.
+*                - prefix_print         : Skriver ut posten via en utström.
+*                - prefix_encoded_size  : Storleken på posten i binär form.
+*                - prefix_encode        : Kodar posten till binär form.
+*                - prefix_decode        : Avkodar en post i binär form, där
+*                                         strängarna pekar in i bufferten.
+*                - struct prefix_view   : Vy som gör posten till ett
+*                                         person-objekt, med tillhörande vtable.
+*                - prefix_view          : Initierar en vy över en post.
+********************************************************************************/
+#define PERSON_SCHEMA(prefix, fields)                                                    \
+   struct prefix                                                                         \
+   {                                                                                     \
+      fields(PERSON_SCHEMA_MEMBER_WIDE)                                                  \
+      fields(PERSON_SCHEMA_MEMBER_WORD)                                                  \
+      fields(PERSON_SCHEMA_MEMBER_BYTE)                                                  \
+   };                                                                                    \
+                                                                                         \
+   fields(PERSON_SCHEMA_CHECK)                                                           \
+   _Static_assert(0 fields(PERSON_SCHEMA_COUNT_NAME) <= 1 &&                             \
+                  0 fields(PERSON_SCHEMA_COUNT_AGE) <= 1 &&                              \
+                  0 fields(PERSON_SCHEMA_COUNT_ADDRESS) <= 1 &&                          \
+                  0 fields(PERSON_SCHEMA_COUNT_OCCUPATION) <= 1 &&                       \
+                  0 fields(PERSON_SCHEMA_COUNT_GENDER) <= 1,                             \
+                  "person_schema: each role may be assigned to at most one field");       \
+                                                                                         \
+   static inline const char* prefix##_name(const struct prefix* self)                    \
+   {                                                                                     \
+      fields(PERSON_SCHEMA_GET_NAME)                                                     \
+      (void)self;                                                                        \
+      return "";                                                                         \
+   }                                                                                     \
+                                                                                         \
+   static inline unsigned int prefix##_age(const struct prefix* self)                    \
+   {                                                                                     \
+      fields(PERSON_SCHEMA_GET_AGE)                                                      \
+      (void)self;                                                                        \
+      return 0;                                                                          \
+   }                                                                                     \
+                                                                                         \
+   static inline const char* prefix##_address(const struct prefix* self)                 \
+   {                                                                                     \
+      fields(PERSON_SCHEMA_GET_ADDRESS)                                                  \
+      (void)self;                                                                        \
+      return "";                                                                         \
+   }                                                                                     \
+                                                                                         \
+   static inline const char* prefix##_occupation(const struct prefix* self)              \
+   {                                                                                     \
+      fields(PERSON_SCHEMA_GET_OCCUPATION)                                               \
+      (void)self;                                                                        \
+      return "";                                                                         \
+   }                                                                                     \
+                                                                                         \
+   static inline enum gender prefix##_gender(const struct prefix* self)                  \
+   {                                                                                     \
+      fields(PERSON_SCHEMA_GET_GENDER)                                                   \
+      (void)self;                                                                        \
+      return GENDER_NONE;                                                                \
+   }                                                                                     \
+                                                                                         \
+   static inline void prefix##_from_person(struct prefix* self,                          \
+                                           const struct person* person)                  \
+   {                                                                                     \
+      memset(self, 0, sizeof(*self));                                                    \
+      fields(PERSON_SCHEMA_ASSIGN)                                                       \
+      (void)person;                                                                      \
+   }                                                                                     \
+                                                                                         \
+   static inline size_t prefix##_format(const struct prefix* self,                       \
+                                        char* buffer,                                    \
+                                        const size_t capacity)                           \
+   {                                                                                     \
+      fields(PERSON_SCHEMA_TEXT)                                                         \
+      const size_t separator_size = sizeof(PERSON_SCHEMA_SEPARATOR) - 1;                 \
+      const size_t total = 2 * separator_size + 1 fields(PERSON_SCHEMA_TEXT_LENGTH);     \
+      if (total > capacity) return total;                                                \
+                                                                                         \
+      char* s = buffer;                                                                  \
+      memcpy(s, PERSON_SCHEMA_SEPARATOR, separator_size);                                \
+      s += separator_size;                                                               \
+      fields(PERSON_SCHEMA_TEXT_COPY)                                                    \
+      memcpy(s, PERSON_SCHEMA_SEPARATOR, separator_size);                                \
+      s += separator_size;                                                               \
+      *s = '\n';                                                                         \
+      return total;                                                                      \
+   }                                                                                     \
+                                                                                         \
+   static inline void prefix##_print(const struct prefix* self,                          \
+                                     FILE* ostream)                                      \
+   {                                                                                     \
+      char buffer[512];                                                                  \
+      if (!ostream) ostream = stdout;                                                    \
+      const size_t length = prefix##_format(self, buffer, sizeof(buffer));               \
+                                                                                         \
+      if (length <= sizeof(buffer))                                                      \
+      {                                                                                  \
+         fwrite(buffer, 1, length, ostream);                                             \
+         return;                                                                         \
+      }                                                                                  \
+                                                                                         \
+      char* heap = (char*)malloc(length);                                                \
+      if (!heap) return;                                                                 \
+      prefix##_format(self, heap, length);                                               \
+      fwrite(heap, 1, length, ostream);                                                  \
+      free(heap);                                                                        \
+   }                                                                                     \
+                                                                                         \
+   static inline size_t prefix##_encoded_size(const struct prefix* self)                 \
+   {                                                                                     \
+      (void)self;                                                                        \
+      return 0 fields(PERSON_SCHEMA_ENCODED_SIZE);                                       \
+   }                                                                                     \
+                                                                                         \
+   static inline size_t prefix##_encode(const struct prefix* self,                       \
+                                        unsigned char* buffer,                           \
+                                        const size_t capacity)                           \
+   {                                                                                     \
+      const size_t size = prefix##_encoded_size(self);                                   \
+      if (size > capacity) return size;                                                  \
+      unsigned char* s = buffer;                                                         \
+      fields(PERSON_SCHEMA_ENCODE)                                                       \
+      return size;                                                                       \
+   }                                                                                     \
+                                                                                         \
+   static inline size_t prefix##_decode(struct prefix* self,                             \
+                                        const void* buffer,                              \
+                                        const size_t size)                               \
+   {                                                                                     \
+      const unsigned char* s = (const unsigned char*)buffer;                             \
+      const unsigned char* const end = s + size;                                         \
+      fields(PERSON_SCHEMA_DECODE)                                                       \
+      return (size_t)(s - (const unsigned char*)buffer);                                 \
+   }                                                                                     \
+                                                                                         \
+   struct prefix##_view                                                                  \
+   {                                                                                     \
+      struct person base;                                                                \
+      const struct prefix* record;                                                       \
+   };                                                                                    \
+                                                                                         \
+   static inline const char* prefix##_view_name(const struct person* self)               \
+   {                                                                                     \
+      return prefix##_name(((const struct prefix##_view*)self)->record);                 \
+   }                                                                                     \
+                                                                                         \
+   static inline unsigned int prefix##_view_age(const struct person* self)               \
+   {                                                                                     \
+      return prefix##_age(((const struct prefix##_view*)self)->record);                  \
+   }                                                                                     \
+                                                                                         \
+   static inline const char* prefix##_view_address(const struct person* self)            \
+   {                                                                                     \
+      return prefix##_address(((const struct prefix##_view*)self)->record);              \
+   }                                                                                     \
+                                                                                         \
+   static inline const char* prefix##_view_occupation(const struct person* self)         \
+   {                                                                                     \
+      return prefix##_occupation(((const struct prefix##_view*)self)->record);           \
+   }                                                                                     \
+                                                                                         \
+   static inline enum gender prefix##_view_gender(const struct person* self)             \
+   {                                                                                     \
+      return prefix##_gender(((const struct prefix##_view*)self)->record);               \
+   }                                                                                     \
+                                                                                         \
+   static inline const char* prefix##_view_gender_str(const struct person* self)         \
+   {                                                                                     \
+      return gender_str(prefix##_view_gender(self));                                     \
+   }                                                                                     \
+                                                                                         \
+   static inline void prefix##_view_print(const struct person* self,                     \
+                                          FILE* ostream)                                 \
+   {                                                                                     \
+      prefix##_print(((const struct prefix##_view*)self)->record, ostream);              \
+   }                                                                                     \
+                                                                                         \
+   static inline void prefix##_view_clear(struct person* self)                           \
+   {                                                                                     \
+      ((struct prefix##_view*)self)->base.vptr = 0;                                      \
+      ((struct prefix##_view*)self)->record = 0;                                         \
+   }                                                                                     \
+                                                                                         \
+   static inline const struct person_vtable* prefix##_vtable_ptr_new(void)               \
+   {                                                                                     \
+      static const struct person_vtable self =                                           \
+      {                                                                                  \
+         .print = &prefix##_view_print,                                                  \
+         .gender_str = &prefix##_view_gender_str,                                        \
+         .name = &prefix##_view_name,                                                    \
+         .age = &prefix##_view_age,                                                      \
+         .address = &prefix##_view_address,                                              \
+         .occupation = &prefix##_view_occupation,                                        \
+         .gender = &prefix##_view_gender,                                                \
+         .clear = &prefix##_view_clear                                                   \
+      };                                                                                 \
+      return &self;                                                                      \
+   }                                                                                     \
+                                                                                         \
+   static inline struct person* prefix##_view(const struct prefix* self,                 \
+                                              struct prefix##_view* view)                \
+   {                                                                                     \
+      view->base.mem = 0;                                                                \
+      view->base.vptr = prefix##_vtable_ptr_new();                                       \
+      view->record = self;                                                               \
+      return &view->base;                                                                \
+   }
+
+#endif /* PERSON_SCHEMA_H_ */
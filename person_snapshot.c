@@ -0,0 +1,994 @@
+/********************************************************************************
+* person_snapshot.c: Innehåller definitioner av associerade funktioner
+*                    tillhörande strukten person_snapshot, som används för
+*                    komprimerade kolumnbaserade ögonblicksbilder av
+*                    persondata.
+********************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "person_snapshot.h"
+#include "person_intern.h"
+#include <limits.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Antal värden som avkodas åt gången vid filtrering. */
+#define PERSON_SNAPSHOT_BLOCK 256
+
+/* Huvudet måste bevara justeringen av efterföljande sektioner. */
+_Static_assert(sizeof(struct person_snapshot_header) % 8 == 0,
+               "person_snapshot: header size must be a multiple of 8");
+
+/********************************************************************************
+* person_snapshot_map: Hashtabell som tilldelar unika strängar koder i den
+*                      ordning de påträffas, används när en ordlista skapas.
+********************************************************************************/
+struct person_snapshot_map
+{
+   const char** strings; /* Unika strängar i kodordning. */
+   size_t* slots;        /* Tabellens platser, kod + 1 (0 = ledig plats). */
+   size_t slot_count;    /* Antal platser i tabellen (tvåpotens). */
+   size_t size;          /* Antal unika strängar. */
+   size_t bytes;         /* Summan av strängarnas storlek inklusive nolltecken. */
+};
+
+/* Statiska funktioner: */
+static const struct person_vtable* person_snapshot_vtable_ptr_new(void);
+static unsigned int person_snapshot_bits(uint64_t value);
+static size_t person_snapshot_words(const size_t count,
+                                    const unsigned int bits);
+static void person_snapshot_pack(uint64_t* words,
+                                 const size_t index,
+                                 const unsigned int bits,
+                                 const uint64_t value);
+static uint64_t person_snapshot_unpack(const uint64_t* words,
+                                       const size_t index,
+                                       const unsigned int bits);
+static size_t person_snapshot_range(const struct person_snapshot* self,
+                                    const size_t begin,
+                                    const size_t count);
+static int person_snapshot_load(struct person_snapshot* self);
+static int person_snapshot_section_valid(const struct person_snapshot* self,
+                                         const uint64_t offset,
+                                         const size_t count,
+                                         const unsigned int bits);
+static const char* person_snapshot_heap_string(const struct person_snapshot* self,
+                                               const uint64_t offset);
+static int person_snapshot_map_init(struct person_snapshot_map* self,
+                                    const size_t capacity);
+static void person_snapshot_map_clear(struct person_snapshot_map* self);
+static int person_snapshot_map_code(struct person_snapshot_map* self,
+                                    const char* s,
+                                    size_t* code);
+static const char* person_snapshot_view_name(const struct person* self);
+static unsigned int person_snapshot_view_age(const struct person* self);
+static const char* person_snapshot_view_address(const struct person* self);
+static const char* person_snapshot_view_occupation(const struct person* self);
+static enum gender person_snapshot_view_gender(const struct person* self);
+static const char* person_snapshot_view_gender_str(const struct person* self);
+static void person_snapshot_view_clear(struct person* self);
+
+/********************************************************************************
+* person_snapshot_build: Skapar en komprimerad snapshot av samtliga poster i
+*                        angiven person_store. Ordlistorna skapas i ett första
+*                        pass, varefter storleken på samtliga sektioner är
+*                        känd och kolumnerna packas i ett andra pass.
+*                        Könskolumnen lagrar två bitar per post, varför en
+*                        post med ett könsvärde över 3 medför att 1
+*                        returneras.
+*
+*                        - self : Pekare till objektet som ska lagra snapshoten.
+*                        - store: Pekare till aktuell person_store.
+********************************************************************************/
+int person_snapshot_build(struct person_snapshot* self,
+                          const struct person_store* store)
+{
+   struct person_snapshot_map maps[PERSON_SNAPSHOT_DICTIONARIES];
+   struct person_snapshot_header header;
+   const size_t count = store->size;
+   unsigned int min_age = count ? UINT_MAX : 0, max_age = 0;
+   uint64_t name_bytes = 0;
+   size_t code;
+   int error = 0;
+
+   memset(self, 0, sizeof(*self));
+   memset(&header, 0, sizeof(header));
+   if (person_snapshot_map_init(&maps[PERSON_SNAPSHOT_OCCUPATIONS], 64)) return 1;
+   if (person_snapshot_map_init(&maps[PERSON_SNAPSHOT_ADDRESSES], 64))
+   {
+      person_snapshot_map_clear(&maps[PERSON_SNAPSHOT_OCCUPATIONS]);
+      return 1;
+   }
+
+   for (size_t i = 0; i < count && !error; ++i)
+   {
+      const unsigned int age = store->ages[i];
+      if (age < min_age) min_age = age;
+      if (age > max_age) max_age = age;
+      name_bytes += strlen(person_store_name(store, i)) + 1;
+      error = store->genders[i] > 3 ||
+              person_snapshot_map_code(&maps[PERSON_SNAPSHOT_OCCUPATIONS],
+                                       person_store_occupation(store, i), &code) ||
+              person_snapshot_map_code(&maps[PERSON_SNAPSHOT_ADDRESSES],
+                                       person_store_address(store, i), &code);
+   }
+
+   if (!error)
+   {
+      memcpy(header.magic, PERSON_SNAPSHOT_MAGIC, sizeof(header.magic));
+      header.version = PERSON_SNAPSHOT_VERSION;
+      header.age_base = min_age;
+      header.count = count;
+      header.age_bits = (uint8_t)person_snapshot_bits(max_age - min_age);
+      header.heap_size = name_bytes;
+
+      for (size_t d = 0; d < PERSON_SNAPSHOT_DICTIONARIES; ++d)
+      {
+         header.dictionary_sizes[d] = maps[d].size;
+         header.code_bits[d] = (uint8_t)person_snapshot_bits(maps[d].size ? maps[d].size - 1 : 0);
+         header.heap_size += maps[d].bytes;
+      }
+
+      header.offset_bits = (uint8_t)person_snapshot_bits(header.heap_size);
+      header.ages = sizeof(header);
+      header.genders = header.ages + 8 * person_snapshot_words(count, header.age_bits);
+      header.codes[0] = header.genders + 8 * person_snapshot_words(count, 2);
+      header.codes[1] = header.codes[0] + 8 * person_snapshot_words(count, header.code_bits[0]);
+      header.names = header.codes[1] + 8 * person_snapshot_words(count, header.code_bits[1]);
+      header.dictionaries[0] = header.names + 8 * person_snapshot_words(count, header.offset_bits);
+      header.dictionaries[1] = header.dictionaries[0] +
+         8 * person_snapshot_words(maps[0].size, header.offset_bits);
+      header.heap = header.dictionaries[1] + 8 * person_snapshot_words(maps[1].size, header.offset_bits);
+
+      self->size = (size_t)(header.heap + header.heap_size);
+      self->data = calloc(self->size, 1);
+      error = !self->data;
+   }
+
+   if (!error)
+   {
+      char* data = (char*)self->data;
+      char* heap = data + header.heap;
+      uint64_t offset = 0;
+      memcpy(data, &header, sizeof(header));
+
+      for (size_t d = 0; d < PERSON_SNAPSHOT_DICTIONARIES; ++d)
+      {
+         uint64_t* words = (uint64_t*)(data + header.dictionaries[d]);
+
+         for (size_t j = 0; j < maps[d].size; ++j)
+         {
+            const size_t size = strlen(maps[d].strings[j]) + 1;
+            memcpy(heap + offset, maps[d].strings[j], size);
+            person_snapshot_pack(words, j, header.offset_bits, offset);
+            offset += size;
+         }
+      }
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         const char* name = person_store_name(store, i);
+         const size_t size = strlen(name) + 1;
+         memcpy(heap + offset, name, size);
+         person_snapshot_pack((uint64_t*)(data + header.names), i, header.offset_bits, offset);
+         offset += size;
+
+         person_snapshot_pack((uint64_t*)(data + header.ages), i, header.age_bits,
+                              store->ages[i] - min_age);
+         person_snapshot_pack((uint64_t*)(data + header.genders), i, 2, store->genders[i]);
+         person_snapshot_map_code(&maps[PERSON_SNAPSHOT_OCCUPATIONS], person_store_occupation(store, i), &code);
+         person_snapshot_pack((uint64_t*)(data + header.codes[PERSON_SNAPSHOT_OCCUPATIONS]), i,
+                              header.code_bits[PERSON_SNAPSHOT_OCCUPATIONS], code);
+         person_snapshot_map_code(&maps[PERSON_SNAPSHOT_ADDRESSES], person_store_address(store, i), &code);
+         person_snapshot_pack((uint64_t*)(data + header.codes[PERSON_SNAPSHOT_ADDRESSES]), i,
+                              header.code_bits[PERSON_SNAPSHOT_ADDRESSES], code);
+      }
+
+      error = person_snapshot_load(self);
+   }
+
+   person_snapshot_map_clear(&maps[PERSON_SNAPSHOT_ADDRESSES]);
+   person_snapshot_map_clear(&maps[PERSON_SNAPSHOT_OCCUPATIONS]);
+   if (error) person_snapshot_close(self);
+   return error;
+}
+
+/********************************************************************************
+* person_snapshot_write: Skriver angiven snapshot till en fil på angiven
+*                        sökväg. Vid lyckad skrivning returneras 0, annars 1.
+*
+*                        - self: Pekare till aktuell person_snapshot.
+*                        - path: Sökväg till filen som ska skrivas.
+********************************************************************************/
+int person_snapshot_write(const struct person_snapshot* self,
+                          const char* path)
+{
+   FILE* ostream = fopen(path, "wb");
+   if (!ostream) return 1;
+   const int error = fwrite(self->data, 1, self->size, ostream) != self->size;
+   return fclose(ostream) || error;
+}
+
+/********************************************************************************
+* person_snapshot_open: Mappar filen på angiven sökväg till minnet och
+*                       validerar dess innehåll. Vid lyckad inläsning
+*                       returneras 0, annars returneras 1.
+*
+*                       - self: Pekare till objektet som ska lagra snapshoten.
+*                       - path: Sökväg till filen som ska läsas in.
+********************************************************************************/
+int person_snapshot_open(struct person_snapshot* self,
+                         const char* path)
+{
+   struct stat info;
+   memset(self, 0, sizeof(*self));
+
+   const int fd = open(path, O_RDONLY);
+   if (fd < 0) return 1;
+
+   if (fstat(fd, &info) || (size_t)info.st_size < sizeof(struct person_snapshot_header))
+   {
+      close(fd);
+      return 1;
+   }
+
+   void* data = mmap(0, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (data == MAP_FAILED) return 1;
+
+   self->data = data;
+   self->size = (size_t)info.st_size;
+   self->mapped = 1;
+
+   if (person_snapshot_load(self))
+   {
+      person_snapshot_close(self);
+      return 1;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_snapshot_close: Frigör eller avmappar angiven snapshot och
+*                        nollställer objektet.
+*
+*                        - self: Pekare till aktuell person_snapshot.
+********************************************************************************/
+void person_snapshot_close(struct person_snapshot* self)
+{
+   if (self->mapped) munmap(self->data, self->size);
+   else free(self->data);
+   memset(self, 0, sizeof(*self));
+   return;
+}
+
+/********************************************************************************
+* person_snapshot_size: Returnerar antalet poster i angiven snapshot.
+*
+*                       - self: Pekare till aktuell person_snapshot.
+********************************************************************************/
+size_t person_snapshot_size(const struct person_snapshot* self)
+{
+   return self->count;
+}
+
+/********************************************************************************
+* person_snapshot_bytes: Returnerar snapshotens storlek i bytes.
+*
+*                        - self: Pekare till aktuell person_snapshot.
+********************************************************************************/
+size_t person_snapshot_bytes(const struct person_snapshot* self)
+{
+   return self->size;
+}
+
+/********************************************************************************
+* person_snapshot_name: Returnerar namnet för posten på angivet index.
+*
+*                       - self : Pekare till aktuell person_snapshot.
+*                       - index: Postens index.
+********************************************************************************/
+const char* person_snapshot_name(const struct person_snapshot* self,
+                                 const size_t index)
+{
+   return person_snapshot_heap_string(self, person_snapshot_unpack(self->names, index,
+                                                                   self->offset_bits));
+}
+
+/********************************************************************************
+* person_snapshot_age: Returnerar åldern för posten på angivet index.
+*
+*                      - self : Pekare till aktuell person_snapshot.
+*                      - index: Postens index.
+********************************************************************************/
+unsigned int person_snapshot_age(const struct person_snapshot* self,
+                                 const size_t index)
+{
+   return self->age_base + (unsigned int)person_snapshot_unpack(self->ages, index, self->age_bits);
+}
+
+/********************************************************************************
+* person_snapshot_address: Returnerar hemadressen för posten på angivet index.
+*
+*                          - self : Pekare till aktuell person_snapshot.
+*                          - index: Postens index.
+********************************************************************************/
+const char* person_snapshot_address(const struct person_snapshot* self,
+                                    const size_t index)
+{
+   const enum person_snapshot_dictionary d = PERSON_SNAPSHOT_ADDRESSES;
+   return person_snapshot_string(self, d, (uint32_t)person_snapshot_unpack(self->codes[d], index,
+                                                                           self->code_bits[d]));
+}
+
+/********************************************************************************
+* person_snapshot_occupation: Returnerar yrket för posten på angivet index.
+*
+*                             - self : Pekare till aktuell person_snapshot.
+*                             - index: Postens index.
+********************************************************************************/
+const char* person_snapshot_occupation(const struct person_snapshot* self,
+                                       const size_t index)
+{
+   const enum person_snapshot_dictionary d = PERSON_SNAPSHOT_OCCUPATIONS;
+   return person_snapshot_string(self, d, (uint32_t)person_snapshot_unpack(self->codes[d], index,
+                                                                           self->code_bits[d]));
+}
+
+/********************************************************************************
+* person_snapshot_gender: Returnerar könet för posten på angivet index.
+*
+*                         - self : Pekare till aktuell person_snapshot.
+*                         - index: Postens index.
+********************************************************************************/
+enum gender person_snapshot_gender(const struct person_snapshot* self,
+                                   const size_t index)
+{
+   return (enum gender)person_snapshot_unpack(self->genders, index, 2);
+}
+
+/********************************************************************************
+* person_snapshot_view: Initierar en vy över posten på angivet index och
+*                       returnerar en pekare till vyns person-objekt.
+*
+*                       - self : Pekare till aktuell person_snapshot.
+*                       - index: Postens index.
+*                       - view : Pekare till vyn som ska initieras.
+********************************************************************************/
+struct person* person_snapshot_view(const struct person_snapshot* self,
+                                    const size_t index,
+                                    struct person_snapshot_view* view)
+{
+   view->base.mem = 0;
+   view->base.vptr = person_snapshot_vtable_ptr_new();
+   view->snapshot = self;
+   view->index = index;
+   return &view->base;
+}
+
+/********************************************************************************
+* person_snapshot_decode_ages: Avkodar åldrarna för angivet intervall av poster
+*                              till angiven array och returnerar antalet
+*                              avkodade åldrar.
+*
+*                              - self : Pekare till aktuell person_snapshot.
+*                              - begin: Index för första posten.
+*                              - count: Antal poster att avkoda.
+*                              - ages : Array där åldrarna lagras.
+********************************************************************************/
+size_t person_snapshot_decode_ages(const struct person_snapshot* self,
+                                   const size_t begin,
+                                   const size_t count,
+                                   unsigned int* ages)
+{
+   const size_t size = person_snapshot_range(self, begin, count);
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      ages[i] = self->age_base + (unsigned int)person_snapshot_unpack(self->ages, begin + i,
+                                                                      self->age_bits);
+   }
+   return size;
+}
+
+/********************************************************************************
+* person_snapshot_decode_genders: Avkodar könen för angivet intervall av poster
+*                                 till angiven array och returnerar antalet
+*                                 avkodade kön.
+*
+*                                 - self   : Pekare till aktuell person_snapshot.
+*                                 - begin  : Index för första posten.
+*                                 - count  : Antal poster att avkoda.
+*                                 - genders: Array där könen lagras.
+********************************************************************************/
+size_t person_snapshot_decode_genders(const struct person_snapshot* self,
+                                      const size_t begin,
+                                      const size_t count,
+                                      unsigned char* genders)
+{
+   const size_t size = person_snapshot_range(self, begin, count);
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      genders[i] = (unsigned char)person_snapshot_unpack(self->genders, begin + i, 2);
+   }
+   return size;
+}
+
+/********************************************************************************
+* person_snapshot_decode_codes: Avkodar koderna i angiven ordlista för angivet
+*                               intervall av poster till angiven array och
+*                               returnerar antalet avkodade koder.
+*
+*                               - self      : Pekare till aktuell person_snapshot.
+*                               - dictionary: Aktuell ordlista.
+*                               - begin     : Index för första posten.
+*                               - count     : Antal poster att avkoda.
+*                               - codes     : Array där koderna lagras.
+********************************************************************************/
+size_t person_snapshot_decode_codes(const struct person_snapshot* self,
+                                    const enum person_snapshot_dictionary dictionary,
+                                    const size_t begin,
+                                    const size_t count,
+                                    uint32_t* codes)
+{
+   const size_t size = person_snapshot_range(self, begin, count);
+   const uint64_t* words = self->codes[dictionary];
+   const unsigned int bits = self->code_bits[dictionary];
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      codes[i] = (uint32_t)person_snapshot_unpack(words, begin + i, bits);
+   }
+   return size;
+}
+
+/********************************************************************************
+* person_snapshot_dictionary_size: Returnerar antalet unika strängar i angiven
+*                                  ordlista.
+*
+*                                  - self      : Pekare till aktuell person_snapshot.
+*                                  - dictionary: Aktuell ordlista.
+********************************************************************************/
+size_t person_snapshot_dictionary_size(const struct person_snapshot* self,
+                                       const enum person_snapshot_dictionary dictionary)
+{
+   return self->dictionary_sizes[dictionary];
+}
+
+/********************************************************************************
+* person_snapshot_string: Returnerar strängen med angiven kod i angiven
+*                         ordlista. En ogiltig kod ger en tom sträng.
+*
+*                         - self      : Pekare till aktuell person_snapshot.
+*                         - dictionary: Aktuell ordlista.
+*                         - code      : Strängens kod.
+********************************************************************************/
+const char* person_snapshot_string(const struct person_snapshot* self,
+                                   const enum person_snapshot_dictionary dictionary,
+                                   const uint32_t code)
+{
+   if (code >= self->dictionary_sizes[dictionary]) return "";
+   return person_snapshot_heap_string(self, person_snapshot_unpack(self->dictionaries[dictionary],
+                                                                   code, self->offset_bits));
+}
+
+/********************************************************************************
+* person_snapshot_code: Slår upp koden för angiven sträng i angiven ordlista.
+*                       Ordlistan genomsöks linjärt, vilket förutsätter att
+*                       antalet unika strängar är litet i förhållande till
+*                       antalet poster.
+*
+*                       - self      : Pekare till aktuell person_snapshot.
+*                       - dictionary: Aktuell ordlista.
+*                       - s         : Strängen som ska slås upp.
+*                       - code      : Adress där koden ska lagras.
+********************************************************************************/
+int person_snapshot_code(const struct person_snapshot* self,
+                         const enum person_snapshot_dictionary dictionary,
+                         const char* s,
+                         uint32_t* code)
+{
+   if (!s) s = "";
+
+   for (size_t i = 0; i < self->dictionary_sizes[dictionary]; ++i)
+   {
+      if (!strcmp(person_snapshot_string(self, dictionary, (uint32_t)i), s))
+      {
+         *code = (uint32_t)i;
+         return 0;
+      }
+   }
+   return 1;
+}
+
+/********************************************************************************
+* person_snapshot_filter_age: Lagrar index för samtliga poster med en ålder
+*                             mellan min och max (inklusive) i angiven array.
+*                             Gränserna omvandlas till åldrarnas packade form,
+*                             varefter åldrarna avkodas och jämförs blockvis.
+*
+*                             - self   : Pekare till aktuell person_snapshot.
+*                             - min    : Lägsta ålder.
+*                             - max    : Högsta ålder.
+*                             - indices: Array där matchande index lagras.
+********************************************************************************/
+size_t person_snapshot_filter_age(const struct person_snapshot* self,
+                                  const unsigned int min,
+                                  const unsigned int max,
+                                  size_t* indices)
+{
+   uint64_t block[PERSON_SNAPSHOT_BLOCK];
+   size_t size = 0;
+   if (min > max || max < self->age_base) return 0;
+
+   const uint64_t low = min > self->age_base ? min - self->age_base : 0;
+   const uint64_t span = (max - self->age_base) - low;
+
+   for (size_t begin = 0; begin < self->count; begin += PERSON_SNAPSHOT_BLOCK)
+   {
+      const size_t n = person_snapshot_range(self, begin, PERSON_SNAPSHOT_BLOCK);
+
+      for (size_t i = 0; i < n; ++i)
+      {
+         block[i] = person_snapshot_unpack(self->ages, begin + i, self->age_bits);
+      }
+
+      for (size_t i = 0; i < n; ++i)
+      {
+         if (block[i] - low <= span) indices[size++] = begin + i;
+      }
+   }
+   return size;
+}
+
+/********************************************************************************
+* person_snapshot_count_gender: Returnerar antalet poster med angivet kön.
+*                               Varje ord jämförs med ett mönster där könet
+*                               upprepas 32 gånger, varefter poster där båda
+*                               bitarna överensstämmer räknas via popcount.
+*
+*                               - self  : Pekare till aktuell person_snapshot.
+*                               - gender: Könet som ska räknas.
+********************************************************************************/
+size_t person_snapshot_count_gender(const struct person_snapshot* self,
+                                    const enum gender gender)
+{
+   const uint64_t low_bits = 0x5555555555555555ULL;
+   const uint64_t pattern = low_bits * ((uint64_t)gender & 3);
+   const size_t full_words = self->count / 32;
+   const size_t rest = self->count % 32;
+   size_t size = 0;
+
+   for (size_t i = 0; i < full_words; ++i)
+   {
+      const uint64_t difference = self->genders[i] ^ pattern;
+      size += (size_t)__builtin_popcountll(~(difference | difference >> 1) & low_bits);
+   }
+
+   if (rest)
+   {
+      const uint64_t difference = self->genders[full_words] ^ pattern;
+      const uint64_t mask = ((uint64_t)1 << (2 * rest)) - 1;
+      size += (size_t)__builtin_popcountll(~(difference | difference >> 1) & low_bits & mask);
+   }
+   return size;
+}
+
+/********************************************************************************
+* person_snapshot_count_code: Returnerar antalet poster med angiven kod i
+*                             angiven ordlista.
+*
+*                             - self      : Pekare till aktuell person_snapshot.
+*                             - dictionary: Aktuell ordlista.
+*                             - code      : Koden som ska räknas.
+********************************************************************************/
+size_t person_snapshot_count_code(const struct person_snapshot* self,
+                                  const enum person_snapshot_dictionary dictionary,
+                                  const uint32_t code)
+{
+   const uint64_t* words = self->codes[dictionary];
+   const unsigned int bits = self->code_bits[dictionary];
+   size_t size = 0;
+   if (code >= self->dictionary_sizes[dictionary]) return 0;
+
+   for (size_t i = 0; i < self->count; ++i)
+   {
+      size += person_snapshot_unpack(words, i, bits) == code;
+   }
+   return size;
+}
+
+/********************************************************************************
+* person_snapshot_vtable_ptr_new: Returnerar en pekare till ett statiskt
+*                                 vtable för vyer över poster i en
+*                                 person_snapshot.
+********************************************************************************/
+static const struct person_vtable* person_snapshot_vtable_ptr_new(void)
+{
+   static const struct person_vtable self =
+   {
+      .print = &person_print,
+      .gender_str = &person_snapshot_view_gender_str,
+      .name = &person_snapshot_view_name,
+      .age = &person_snapshot_view_age,
+      .address = &person_snapshot_view_address,
+      .occupation = &person_snapshot_view_occupation,
+      .gender = &person_snapshot_view_gender,
+      .clear = &person_snapshot_view_clear
+   };
+
+   return &self;
+}
+
+/********************************************************************************
+* person_snapshot_bits: Returnerar antalet bitar som krävs för att lagra
+*                       angivet värde (0 för värdet 0).
+*
+*                       - value: Värdet som ska lagras.
+********************************************************************************/
+static unsigned int person_snapshot_bits(uint64_t value)
+{
+   unsigned int bits = 0;
+
+   while (value)
+   {
+      bits++;
+      value >>= 1;
+   }
+   return bits;
+}
+
+/********************************************************************************
+* person_snapshot_words: Returnerar antalet 64-bitars ord som krävs för att
+*                        lagra angivet antal bitpackade värden, inklusive ett
+*                        extra ord som gör att avkodning alltid kan läsa två
+*                        ord utan gränskontroll.
+*
+*                        - count: Antal värden.
+*                        - bits : Antal bitar per värde.
+********************************************************************************/
+static size_t person_snapshot_words(const size_t count,
+                                    const unsigned int bits)
+{
+   return (count * bits + 63) / 64 + 1;
+}
+
+/********************************************************************************
+* person_snapshot_pack: Lagrar angivet värde på angivet index i en nollställd
+*                       bitpackad array.
+*
+*                       - words: Den bitpackade arrayen.
+*                       - index: Värdets index.
+*                       - bits : Antal bitar per värde (0 - 63).
+*                       - value: Värdet som ska lagras.
+********************************************************************************/
+static void person_snapshot_pack(uint64_t* words,
+                                 const size_t index,
+                                 const unsigned int bits,
+                                 const uint64_t value)
+{
+   if (!bits) return;
+   const size_t bit = index * bits;
+   const size_t word = bit / 64;
+   const unsigned int shift = (unsigned int)(bit % 64);
+
+   words[word] |= value << shift;
+   if (shift + bits > 64) words[word + 1] |= value >> (64 - shift);
+   return;
+}
+
+/********************************************************************************
+* person_snapshot_unpack: Returnerar värdet på angivet index i en bitpackad
+*                         array.
+*
+*                         - words: Den bitpackade arrayen.
+*                         - index: Värdets index.
+*                         - bits : Antal bitar per värde (0 - 63).
+********************************************************************************/
+static inline uint64_t person_snapshot_unpack(const uint64_t* words,
+                                              const size_t index,
+                                              const unsigned int bits)
+{
+   const size_t bit = index * bits;
+   const size_t word = bit / 64;
+   const unsigned int shift = (unsigned int)(bit % 64);
+   uint64_t value = words[word] >> shift;
+
+   if (shift + bits > 64) value |= words[word + 1] << (64 - shift);
+   return value & (((uint64_t)1 << bits) - 1);
+}
+
+/********************************************************************************
+* person_snapshot_range: Returnerar antalet poster från och med angivet index,
+*                        dock högst angivet antal.
+*
+*                        - self : Pekare till aktuell person_snapshot.
+*                        - begin: Index för första posten.
+*                        - count: Önskat antal poster.
+********************************************************************************/
+static size_t person_snapshot_range(const struct person_snapshot* self,
+                                    const size_t begin,
+                                    const size_t count)
+{
+   if (begin >= self->count) return 0;
+   return self->count - begin < count ? self->count - begin : count;
+}
+
+/********************************************************************************
+* person_snapshot_load: Validerar huvudet i snapshotens data och sätter
+*                       pekarna till respektive sektion. Vid giltig data
+*                       returneras 0, annars returneras 1.
+*
+*                       - self: Pekare till aktuell person_snapshot.
+********************************************************************************/
+static int person_snapshot_load(struct person_snapshot* self)
+{
+   const struct person_snapshot_header* header = (const struct person_snapshot_header*)self->data;
+   const char* base = (const char*)self->data;
+   const uint64_t count = header->count;
+
+   if (memcmp(header->magic, PERSON_SNAPSHOT_MAGIC, sizeof(header->magic)) ||
+       header->version != PERSON_SNAPSHOT_VERSION || header->flags != 0 ||
+       header->age_bits > 32 || header->offset_bits > 63 ||
+       header->code_bits[0] > 32 || header->code_bits[1] > 32 ||
+       count > self->size ||
+       header->dictionary_sizes[0] > count || header->dictionary_sizes[1] > count)
+   {
+      return 1;
+   }
+
+   self->count = (size_t)count;
+   self->age_base = header->age_base;
+   self->age_bits = header->age_bits;
+   self->offset_bits = header->offset_bits;
+
+   if (!person_snapshot_section_valid(self, header->ages, self->count, self->age_bits) ||
+       !person_snapshot_section_valid(self, header->genders, self->count, 2) ||
+       !person_snapshot_section_valid(self, header->names, self->count, self->offset_bits) ||
+       header->heap > self->size || header->heap_size > self->size - header->heap ||
+       (header->heap_size && base[header->heap + header->heap_size - 1] != '\0'))
+   {
+      return 1;
+   }
+
+   for (size_t d = 0; d < PERSON_SNAPSHOT_DICTIONARIES; ++d)
+   {
+      self->code_bits[d] = header->code_bits[d];
+      self->dictionary_sizes[d] = (size_t)header->dictionary_sizes[d];
+      if (!person_snapshot_section_valid(self, header->codes[d], self->count, self->code_bits[d]) ||
+          !person_snapshot_section_valid(self, header->dictionaries[d], self->dictionary_sizes[d],
+                                         self->offset_bits))
+      {
+         return 1;
+      }
+      self->codes[d] = (const uint64_t*)(base + header->codes[d]);
+      self->dictionaries[d] = (const uint64_t*)(base + header->dictionaries[d]);
+   }
+
+   self->ages = (const uint64_t*)(base + header->ages);
+   self->genders = (const uint64_t*)(base + header->genders);
+   self->names = (const uint64_t*)(base + header->names);
+   self->heap = base + header->heap;
+   self->heap_size = (size_t)header->heap_size;
+   return 0;
+}
+
+/********************************************************************************
+* person_snapshot_section_valid: Indikerar ifall en bitpackad sektion med
+*                                angivet offset, antal värden och antal bitar
+*                                per värde ryms i snapshoten och är justerad.
+*
+*                                - self  : Pekare till aktuell person_snapshot.
+*                                - offset: Sektionens offset.
+*                                - count : Antal värden i sektionen.
+*                                - bits  : Antal bitar per värde.
+********************************************************************************/
+static int person_snapshot_section_valid(const struct person_snapshot* self,
+                                         const uint64_t offset,
+                                         const size_t count,
+                                         const unsigned int bits)
+{
+   const uint64_t size = 8 * (uint64_t)person_snapshot_words(count, bits);
+   return offset % 8 == 0 && offset <= self->size && size <= self->size - offset;
+}
+
+/********************************************************************************
+* person_snapshot_heap_string: Returnerar en pekare till strängen på angivet
+*                              offset i strängheapen. Ett ogiltigt offset ger
+*                              en tom sträng.
+*
+*                              - self  : Pekare till aktuell person_snapshot.
+*                              - offset: Strängens offset i strängheapen.
+********************************************************************************/
+static const char* person_snapshot_heap_string(const struct person_snapshot* self,
+                                               const uint64_t offset)
+{
+   return offset < self->heap_size ? self->heap + offset : "";
+}
+
+/********************************************************************************
+* person_snapshot_map_init: Initierar en ny tom hashtabell med angivet antal
+*                           platser (tvåpotens). Vid lyckad initiering
+*                           returneras 0, annars returneras 1.
+*
+*                           - self    : Pekare till tabellen som ska initieras.
+*                           - capacity: Antal platser i tabellen.
+********************************************************************************/
+static int person_snapshot_map_init(struct person_snapshot_map* self,
+                                    const size_t capacity)
+{
+   memset(self, 0, sizeof(*self));
+   self->slots = (size_t*)calloc(capacity, sizeof(size_t));
+   self->strings = (const char**)malloc(capacity / 2 * sizeof(const char*));
+
+   if (!self->slots || !self->strings)
+   {
+      person_snapshot_map_clear(self);
+      return 1;
+   }
+
+   self->slot_count = capacity;
+   return 0;
+}
+
+/********************************************************************************
+* person_snapshot_map_clear: Frigör minne allokerat av angiven hashtabell.
+*
+*                            - self: Pekare till tabellen som ska nollställas.
+********************************************************************************/
+static void person_snapshot_map_clear(struct person_snapshot_map* self)
+{
+   free(self->strings);
+   free(self->slots);
+   memset(self, 0, sizeof(*self));
+   return;
+}
+
+/********************************************************************************
+* person_snapshot_map_code: Lagrar koden för angiven sträng på angiven adress,
+*                           där strängen tilldelas nästa lediga kod om den
+*                           inte redan finns i tabellen. Tabellen fördubblas
+*                           när hälften av platserna är upptagna. Vid lyckad
+*                           uppslagning returneras 0, annars returneras 1.
+*
+*                           - self: Pekare till aktuell hashtabell.
+*                           - s   : Strängen som ska slås upp.
+*                           - code: Adress där koden ska lagras.
+********************************************************************************/
+static int person_snapshot_map_code(struct person_snapshot_map* self,
+                                    const char* s,
+                                    size_t* code)
+{
+   size_t slot = (size_t)person_intern_hash_str(s) & (self->slot_count - 1);
+
+   while (self->slots[slot])
+   {
+      if (!strcmp(self->strings[self->slots[slot] - 1], s))
+      {
+         *code = self->slots[slot] - 1;
+         return 0;
+      }
+      slot = (slot + 1) & (self->slot_count - 1);
+   }
+
+   if (self->size + 1 > self->slot_count / 2)
+   {
+      const size_t slot_count = self->slot_count * 2;
+      size_t* slots = (size_t*)calloc(slot_count, sizeof(size_t));
+      const char** strings = (const char**)realloc(self->strings, slot_count / 2 * sizeof(const char*));
+      if (strings) self->strings = strings;
+
+      if (!slots || !strings)
+      {
+         free(slots);
+         return 1;
+      }
+
+      for (size_t i = 0; i < self->size; ++i)
+      {
+         size_t j = (size_t)person_intern_hash_str(self->strings[i]) & (slot_count - 1);
+         while (slots[j]) j = (j + 1) & (slot_count - 1);
+         slots[j] = i + 1;
+      }
+
+      free(self->slots);
+      self->slots = slots;
+      self->slot_count = slot_count;
+      slot = (size_t)person_intern_hash_str(s) & (slot_count - 1);
+      while (self->slots[slot]) slot = (slot + 1) & (slot_count - 1);
+   }
+
+   self->strings[self->size] = s;
+   self->slots[slot] = ++self->size;
+   self->bytes += strlen(s) + 1;
+   *code = self->size - 1;
+   return 0;
+}
+
+/********************************************************************************
+* person_snapshot_view_name: Returnerar namnet för posten som vyn refererar
+*                            till.
+*
+*                            - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_snapshot_view_name(const struct person* self)
+{
+   const struct person_snapshot_view* view = (const struct person_snapshot_view*)self;
+   return person_snapshot_name(view->snapshot, view->index);
+}
+
+/********************************************************************************
+* person_snapshot_view_age: Returnerar åldern för posten som vyn refererar
+*                           till.
+*
+*                           - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static unsigned int person_snapshot_view_age(const struct person* self)
+{
+   const struct person_snapshot_view* view = (const struct person_snapshot_view*)self;
+   return person_snapshot_age(view->snapshot, view->index);
+}
+
+/********************************************************************************
+* person_snapshot_view_address: Returnerar hemadressen för posten som vyn
+*                               refererar till.
+*
+*                               - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_snapshot_view_address(const struct person* self)
+{
+   const struct person_snapshot_view* view = (const struct person_snapshot_view*)self;
+   return person_snapshot_address(view->snapshot, view->index);
+}
+
+/********************************************************************************
+* person_snapshot_view_occupation: Returnerar yrket för posten som vyn
+*                                  refererar till.
+*
+*                                  - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_snapshot_view_occupation(const struct person* self)
+{
+   const struct person_snapshot_view* view = (const struct person_snapshot_view*)self;
+   return person_snapshot_occupation(view->snapshot, view->index);
+}
+
+/********************************************************************************
+* person_snapshot_view_gender: Returnerar könet för posten som vyn refererar
+*                              till.
+*
+*                              - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static enum gender person_snapshot_view_gender(const struct person* self)
+{
+   const struct person_snapshot_view* view = (const struct person_snapshot_view*)self;
+   return person_snapshot_gender(view->snapshot, view->index);
+}
+
+/********************************************************************************
+* person_snapshot_view_gender_str: Returnerar könet för posten som vyn
+*                                  refererar till på textform.
+*
+*                                  - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_snapshot_view_gender_str(const struct person* self)
+{
+   return gender_str(person_snapshot_view_gender(self));
+}
+
+/********************************************************************************
+* person_snapshot_view_clear: Nollställer vyn. Snapshoten påverkas inte.
+*
+*                             - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static void person_snapshot_view_clear(struct person* self)
+{
+   struct person_snapshot_view* view = (struct person_snapshot_view*)self;
+   view->base.vptr = 0;
+   view->snapshot = 0;
+   view->index = 0;
+   return;
+}
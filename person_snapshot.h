@@ -0,0 +1,361 @@
+/********************************************************************************
+* person_snapshot.h: Innehåller komprimerade kolumnbaserade ögonblicksbilder
+*                    av persondata via strukten person_snapshot. En snapshot
+*                    skapas från en person_store och utgör ett enda
+*                    sammanhängande minnesblock, som kan skrivas till fil och
+*                    läsas in via minnesmappning utan tolkning eller
+*                    kopiering.
+*
+*                    Kolumnerna lagras bitpackade i 64-bitars ord:
+*                    - Kön med 2 bitar per post.
+*                    - Ålder relativt den lägsta åldern (frame of reference)
+*                      med så få bitar som spannet mellan lägsta och högsta
+*                      ålder kräver.
+*                    - Yrke och hemadress som koder i var sin ordlista
+*                      (dictionary encoding) med så få bitar som ordlistans
+*                      storlek kräver, där varje unik sträng lagras en gång.
+*                    - Namn som offset i strängheapen.
+*
+*                    Kolumnerna kan avkodas var för sig och i delar, och
+*                    filtrering på ålder, kön och kod sker direkt på den
+*                    komprimerade datan utan att övriga kolumner läses.
+*
+*                    Format (version 1, samtliga heltal i värdens byteordning):
+*                    - Huvud om 120 bytes, se strukten person_snapshot_header.
+*                    - Bitpackade kolumner för ålder, kön, yrkeskoder,
+*                      adresskoder och namn.
+*                    - Bitpackade offset för ordlistornas strängar.
+*                    - Strängheap med nollterminerade strängar.
+*                    Varje bitpackad sektion avslutas med ett extra ord och
+*                    samtliga sektioner börjar på en adress som är jämnt
+*                    delbar med 8.
+********************************************************************************/
+#ifndef PERSON_SNAPSHOT_H_
+#define PERSON_SNAPSHOT_H_
+
+/* Inkluderingsdirektiv: */
+#include "person_store.h"
+#include <stdint.h>
+
+/* Magiskt värde i början av varje snapshot. */
+#define PERSON_SNAPSHOT_MAGIC "PERSONSZ"
+
+/* Aktuell version av formatet. */
+#define PERSON_SNAPSHOT_VERSION 1
+
+/********************************************************************************
+* person_snapshot_dictionary: Enumeration för snapshotens ordlistor.
+********************************************************************************/
+typedef enum person_snapshot_dictionary
+{
+   PERSON_SNAPSHOT_OCCUPATIONS, /* Ordlista med yrken. */
+   PERSON_SNAPSHOT_ADDRESSES,   /* Ordlista med hemadresser. */
+   PERSON_SNAPSHOT_DICTIONARIES /* Antal ordlistor. */
+} person_snapshot_dictionary_t;
+
+/********************************************************************************
+* person_snapshot_header: Huvud med fast storlek. Samtliga offset anges i bytes
+*                         från snapshotens början. Fälten indexerade via
+*                         person_snapshot_dictionary avser yrken respektive
+*                         hemadresser.
+********************************************************************************/
+typedef struct person_snapshot_header
+{
+   char magic[8];                                           /* Magiskt värde, PERSON_SNAPSHOT_MAGIC. */
+   uint32_t version;                                        /* Formatets version. */
+   uint32_t age_base;                                       /* Lägsta åldern, som åldrarna lagras relativt. */
+   uint64_t count;                                          /* Antal poster. */
+   uint64_t dictionary_sizes[PERSON_SNAPSHOT_DICTIONARIES]; /* Antal unika strängar per ordlista. */
+   uint8_t age_bits;                                        /* Antal bitar per ålder. */
+   uint8_t code_bits[PERSON_SNAPSHOT_DICTIONARIES];         /* Antal bitar per kod. */
+   uint8_t offset_bits;                                     /* Antal bitar per strängoffset. */
+   uint32_t flags;                                          /* Reserverat för framtida bruk, ska vara 0. */
+   uint64_t ages;                                           /* Offset till åldrarna. */
+   uint64_t genders;                                        /* Offset till könen. */
+   uint64_t codes[PERSON_SNAPSHOT_DICTIONARIES];            /* Offset till koderna. */
+   uint64_t names;                                          /* Offset till namnen. */
+   uint64_t dictionaries[PERSON_SNAPSHOT_DICTIONARIES];     /* Offset till ordlistornas strängoffset. */
+   uint64_t heap;                                           /* Offset till strängheapen. */
+   uint64_t heap_size;                                      /* Strängheapens storlek i bytes. */
+} person_snapshot_header_t;
+
+/********************************************************************************
+* person_snapshot: Strukt för en komprimerad snapshot, antingen skapad i
+*                  minnet via person_snapshot_build eller minnesmappad från
+*                  en fil via person_snapshot_open.
+********************************************************************************/
+typedef struct person_snapshot
+{
+   void* data;                                                 /* Snapshotens data. */
+   size_t size;                                                /* Snapshotens storlek i bytes. */
+   int mapped;                                                 /* Indikerar att datan är minnesmappad. */
+   size_t count;                                               /* Antal poster. */
+   unsigned int age_base;                                      /* Lägsta åldern. */
+   unsigned int age_bits;                                      /* Antal bitar per ålder. */
+   unsigned int offset_bits;                                   /* Antal bitar per strängoffset. */
+   unsigned int code_bits[PERSON_SNAPSHOT_DICTIONARIES];       /* Antal bitar per kod. */
+   size_t dictionary_sizes[PERSON_SNAPSHOT_DICTIONARIES];      /* Antal unika strängar per ordlista. */
+   const uint64_t* ages;                                       /* Bitpackade åldrar. */
+   const uint64_t* genders;                                    /* Bitpackade kön. */
+   const uint64_t* codes[PERSON_SNAPSHOT_DICTIONARIES];        /* Bitpackade koder. */
+   const uint64_t* names;                                      /* Bitpackade offset för namnen. */
+   const uint64_t* dictionaries[PERSON_SNAPSHOT_DICTIONARIES]; /* Bitpackade offset för ordlistorna. */
+   const char* heap;                                           /* Pekare till strängheapen. */
+   size_t heap_size;                                           /* Strängheapens storlek i bytes. */
+} person_snapshot_t, *person_snapshot_ptr_t;
+
+/********************************************************************************
+* person_snapshot_view: Vy över en enskild post i en person_snapshot. Vyn
+*                       innehåller ett person-objekt som första medlem och kan
+*                       därmed användas som ett vanligt person-objekt.
+*                       Returnerade strängar är giltiga tills
+*                       person_snapshot_close anropas.
+********************************************************************************/
+typedef struct person_snapshot_view
+{
+   struct person base;                     /* Basobjekt, används vid anrop via vtable. */
+   const struct person_snapshot* snapshot; /* Pekare till tillhörande person_snapshot. */
+   size_t index;                           /* Postens index i snapshoten. */
+} person_snapshot_view_t, *person_snapshot_view_ptr_t;
+
+/********************************************************************************
+* person_snapshot_build: Skapar en komprimerad snapshot av samtliga poster i
+*                        angiven person_store. Vid lyckat skapande returneras
+*                        0, annars returneras 1, exempelvis om en post har ett
+*                        könsvärde som inte ryms i könskolumnens två bitar.
+*
+*                        - self : Pekare till objektet som ska lagra snapshoten.
+*                        - store: Pekare till aktuell person_store.
+********************************************************************************/
+int person_snapshot_build(struct person_snapshot* self,
+                          const struct person_store* store);
+
+/********************************************************************************
+* person_snapshot_write: Skriver angiven snapshot till en fil på angiven
+*                        sökväg. Vid lyckad skrivning returneras 0, annars 1.
+*
+*                        - self: Pekare till aktuell person_snapshot.
+*                        - path: Sökväg till filen som ska skrivas.
+********************************************************************************/
+int person_snapshot_write(const struct person_snapshot* self,
+                          const char* path);
+
+/********************************************************************************
+* person_snapshot_open: Mappar filen på angiven sökväg till minnet och
+*                       validerar dess innehåll, där bland annat okända
+*                       flaggor i huvudet underkänns. Vid lyckad inläsning
+*                       returneras 0, annars returneras 1.
+*
+*                       - self: Pekare till objektet som ska lagra snapshoten.
+*                       - path: Sökväg till filen som ska läsas in.
+********************************************************************************/
+int person_snapshot_open(struct person_snapshot* self,
+                         const char* path);
+
+/********************************************************************************
+* person_snapshot_close: Frigör eller avmappar angiven snapshot och
+*                        nollställer objektet. Samtliga vyer och strängar
+*                        hämtade från snapshoten blir ogiltiga.
+*
+*                        - self: Pekare till aktuell person_snapshot.
+********************************************************************************/
+void person_snapshot_close(struct person_snapshot* self);
+
+/********************************************************************************
+* person_snapshot_size: Returnerar antalet poster i angiven snapshot.
+*
+*                       - self: Pekare till aktuell person_snapshot.
+********************************************************************************/
+size_t person_snapshot_size(const struct person_snapshot* self);
+
+/********************************************************************************
+* person_snapshot_bytes: Returnerar snapshotens storlek i bytes.
+*
+*                        - self: Pekare till aktuell person_snapshot.
+********************************************************************************/
+size_t person_snapshot_bytes(const struct person_snapshot* self);
+
+/********************************************************************************
+* person_snapshot_name: Returnerar namnet för posten på angivet index.
+*
+*                       - self : Pekare till aktuell person_snapshot.
+*                       - index: Postens index.
+********************************************************************************/
+const char* person_snapshot_name(const struct person_snapshot* self,
+                                 const size_t index);
+
+/********************************************************************************
+* person_snapshot_age: Returnerar åldern för posten på angivet index.
+*
+*                      - self : Pekare till aktuell person_snapshot.
+*                      - index: Postens index.
+********************************************************************************/
+unsigned int person_snapshot_age(const struct person_snapshot* self,
+                                 const size_t index);
+
+/********************************************************************************
+* person_snapshot_address: Returnerar hemadressen för posten på angivet index.
+*
+*                          - self : Pekare till aktuell person_snapshot.
+*                          - index: Postens index.
+********************************************************************************/
+const char* person_snapshot_address(const struct person_snapshot* self,
+                                    const size_t index);
+
+/********************************************************************************
+* person_snapshot_occupation: Returnerar yrket för posten på angivet index.
+*
+*                             - self : Pekare till aktuell person_snapshot.
+*                             - index: Postens index.
+********************************************************************************/
+const char* person_snapshot_occupation(const struct person_snapshot* self,
+                                       const size_t index);
+
+/********************************************************************************
+* person_snapshot_gender: Returnerar könet för posten på angivet index.
+*
+*                         - self : Pekare till aktuell person_snapshot.
+*                         - index: Postens index.
+********************************************************************************/
+enum gender person_snapshot_gender(const struct person_snapshot* self,
+                                   const size_t index);
+
+/********************************************************************************
+* person_snapshot_view: Initierar en vy över posten på angivet index och
+*                       returnerar en pekare till vyns person-objekt.
+*
+*                       - self : Pekare till aktuell person_snapshot.
+*                       - index: Postens index.
+*                       - view : Pekare till vyn som ska initieras.
+********************************************************************************/
+struct person* person_snapshot_view(const struct person_snapshot* self,
+                                    const size_t index,
+                                    struct person_snapshot_view* view);
+
+/********************************************************************************
+* person_snapshot_decode_ages: Avkodar åldrarna för angivet intervall av poster
+*                              till angiven array och returnerar antalet
+*                              avkodade åldrar, som begränsas av antalet
+*                              poster efter begin.
+*
+*                              - self : Pekare till aktuell person_snapshot.
+*                              - begin: Index för första posten.
+*                              - count: Antal poster att avkoda.
+*                              - ages : Array där åldrarna lagras.
+********************************************************************************/
+size_t person_snapshot_decode_ages(const struct person_snapshot* self,
+                                   const size_t begin,
+                                   const size_t count,
+                                   unsigned int* ages);
+
+/********************************************************************************
+* person_snapshot_decode_genders: Avkodar könen för angivet intervall av poster
+*                                 till angiven array, en byte per post, och
+*                                 returnerar antalet avkodade kön.
+*
+*                                 - self   : Pekare till aktuell person_snapshot.
+*                                 - begin  : Index för första posten.
+*                                 - count  : Antal poster att avkoda.
+*                                 - genders: Array där könen lagras.
+********************************************************************************/
+size_t person_snapshot_decode_genders(const struct person_snapshot* self,
+                                      const size_t begin,
+                                      const size_t count,
+                                      unsigned char* genders);
+
+/********************************************************************************
+* person_snapshot_decode_codes: Avkodar koderna i angiven ordlista för angivet
+*                               intervall av poster till angiven array och
+*                               returnerar antalet avkodade koder. Koderna
+*                               omvandlas till text via person_snapshot_string.
+*
+*                               - self      : Pekare till aktuell person_snapshot.
+*                               - dictionary: Aktuell ordlista.
+*                               - begin     : Index för första posten.
+*                               - count     : Antal poster att avkoda.
+*                               - codes     : Array där koderna lagras.
+********************************************************************************/
+size_t person_snapshot_decode_codes(const struct person_snapshot* self,
+                                    const enum person_snapshot_dictionary dictionary,
+                                    const size_t begin,
+                                    const size_t count,
+                                    uint32_t* codes);
+
+/********************************************************************************
+* person_snapshot_dictionary_size: Returnerar antalet unika strängar i angiven
+*                                  ordlista.
+*
+*                                  - self      : Pekare till aktuell person_snapshot.
+*                                  - dictionary: Aktuell ordlista.
+********************************************************************************/
+size_t person_snapshot_dictionary_size(const struct person_snapshot* self,
+                                       const enum person_snapshot_dictionary dictionary);
+
+/********************************************************************************
+* person_snapshot_string: Returnerar strängen med angiven kod i angiven
+*                         ordlista. En ogiltig kod ger en tom sträng.
+*
+*                         - self      : Pekare till aktuell person_snapshot.
+*                         - dictionary: Aktuell ordlista.
+*                         - code      : Strängens kod.
+********************************************************************************/
+const char* person_snapshot_string(const struct person_snapshot* self,
+                                   const enum person_snapshot_dictionary dictionary,
+                                   const uint32_t code);
+
+/********************************************************************************
+* person_snapshot_code: Slår upp koden för angiven sträng i angiven ordlista
+*                       och lagrar den på angiven adress. Om strängen finns i
+*                       ordlistan returneras 0, annars returneras 1.
+*
+*                       - self      : Pekare till aktuell person_snapshot.
+*                       - dictionary: Aktuell ordlista.
+*                       - s         : Strängen som ska slås upp.
+*                       - code      : Adress där koden ska lagras.
+********************************************************************************/
+int person_snapshot_code(const struct person_snapshot* self,
+                         const enum person_snapshot_dictionary dictionary,
+                         const char* s,
+                         uint32_t* code);
+
+/********************************************************************************
+* person_snapshot_filter_age: Lagrar index för samtliga poster med en ålder
+*                             mellan min och max (inklusive) i angiven array,
+*                             som måste rymma person_snapshot_size poster, och
+*                             returnerar antalet matchande poster. Jämförelsen
+*                             sker direkt på de packade åldrarna.
+*
+*                             - self   : Pekare till aktuell person_snapshot.
+*                             - min    : Lägsta ålder.
+*                             - max    : Högsta ålder.
+*                             - indices: Array där matchande index lagras.
+********************************************************************************/
+size_t person_snapshot_filter_age(const struct person_snapshot* self,
+                                  const unsigned int min,
+                                  const unsigned int max,
+                                  size_t* indices);
+
+/********************************************************************************
+* person_snapshot_count_gender: Returnerar antalet poster med angivet kön.
+*                               Räkningen sker direkt på de packade könen,
+*                               32 poster per ord.
+*
+*                               - self  : Pekare till aktuell person_snapshot.
+*                               - gender: Könet som ska räknas.
+********************************************************************************/
+size_t person_snapshot_count_gender(const struct person_snapshot* self,
+                                    const enum gender gender);
+
+/********************************************************************************
+* person_snapshot_count_code: Returnerar antalet poster med angiven kod i
+*                             angiven ordlista, utan strängjämförelser.
+*
+*                             - self      : Pekare till aktuell person_snapshot.
+*                             - dictionary: Aktuell ordlista.
+*                             - code      : Koden som ska räknas.
+********************************************************************************/
+size_t person_snapshot_count_code(const struct person_snapshot* self,
+                                  const enum person_snapshot_dictionary dictionary,
+                                  const uint32_t code);
+
+#endif /* PERSON_SNAPSHOT_H_ */
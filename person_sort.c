@@ -0,0 +1,712 @@
+/********************************************************************************
+* person_sort.c: Innehåller definitioner av funktioner för sortering, partiell
+*                sortering samt urval av person-objekt efter ålder eller namn.
+********************************************************************************/
+#include "person_sort.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Minsta antal objekt för att sortering på namn ska ske parallellt. */
+#define PERSON_SORT_PARALLEL_MIN 65536
+
+/* Största antal objekt som sorteras via insättningssortering. */
+#define PERSON_SORT_INSERTION_MAX 16
+
+/********************************************************************************
+* person_sort_item: Sorteringsnyckel för ett objekt. Vid sortering på namn
+*                   innehåller nyckeln namnets första åtta tecken, där det
+*                   första tecknet lagras i den mest signifikanta byten.
+********************************************************************************/
+struct person_sort_item
+{
+   uint64_t key;                /* Åldern eller namnets första åtta tecken. */
+   const char* name;            /* Namnet vid sortering på namn, annars null. */
+   const struct person* person; /* Pekare till objektet. */
+};
+
+/********************************************************************************
+* person_sort_age_item: Sorteringsnyckel för radixsortering på ålder.
+********************************************************************************/
+struct person_sort_age_item
+{
+   uint32_t key;                /* Åldern, inverterad vid fallande ordning. */
+   const struct person* person; /* Pekare till objektet. */
+};
+
+/********************************************************************************
+* person_sort_entry: Sorteringsnyckel tillsammans med objektets index, som
+*                    används för att bevara ordningen vid lika nycklar i
+*                    en heap.
+********************************************************************************/
+struct person_sort_entry
+{
+   struct person_sort_item item; /* Sorteringsnyckeln. */
+   size_t index;                 /* Objektets index i den ursprungliga arrayen. */
+};
+
+/********************************************************************************
+* person_sort_task: Kontext för parallell sortering på namn.
+********************************************************************************/
+struct person_sort_task
+{
+   struct person_sort_item* items;       /* Nycklarna som ska sorteras. */
+   struct person_sort_item* buffer;      /* Buffert av samma storlek som nycklarna. */
+   struct person_sort_item* source;      /* Sorterade delar som ska slås samman. */
+   struct person_sort_item* destination; /* Destination för sammanslagna delar. */
+   const size_t* bounds;                 /* Gränser för delarna, chunks + 1 st. */
+   size_t chunks;                        /* Antal delar, en per tråd. */
+   size_t width;                         /* Antal delar per sorterad sekvens. */
+   int descending;                       /* Indikerar fallande ordning. */
+};
+
+/* Statiska funktioner: */
+static void person_sort_item_init(struct person_sort_item* self,
+                                  const struct person* person,
+                                  const enum person_sort_order order);
+static uint64_t person_sort_prefix(const char* s);
+static int person_sort_descending(const enum person_sort_order order);
+static int person_sort_compare(const struct person_sort_item* lhs,
+                               const struct person_sort_item* rhs,
+                               const int descending);
+static int person_sort_entry_compare(const struct person_sort_entry* lhs,
+                                     const struct person_sort_entry* rhs,
+                                     const int descending);
+static int person_sort_age(const struct person** persons,
+                           const size_t count,
+                           const int descending);
+static int person_sort_name(const struct person** persons,
+                            const size_t count,
+                            struct person_workers* workers,
+                            const int descending);
+static void person_sort_merge_sort(struct person_sort_item* items,
+                                   struct person_sort_item* buffer,
+                                   const size_t count,
+                                   const int descending);
+static void person_sort_merge(const struct person_sort_item* lhs,
+                              const size_t lhs_count,
+                              const struct person_sort_item* rhs,
+                              const size_t rhs_count,
+                              struct person_sort_item* destination,
+                              const int descending);
+static size_t person_sort_corank(const size_t index,
+                                 const struct person_sort_item* lhs,
+                                 const size_t lhs_count,
+                                 const struct person_sort_item* rhs,
+                                 const size_t rhs_count,
+                                 const int descending);
+static void person_sort_chunk_job(void* context,
+                                  const size_t worker,
+                                  const size_t count);
+static void person_sort_merge_job(void* context,
+                                  const size_t worker,
+                                  const size_t count);
+static struct person_sort_entry* person_sort_select(const struct person* const* persons,
+                                                    const size_t count,
+                                                    const size_t k,
+                                                    const enum person_sort_order order);
+static void person_sort_sift_down(struct person_sort_entry* heap,
+                                  const size_t size,
+                                  size_t index,
+                                  const int descending);
+
+/********************************************************************************
+* person_sort: Sorterar angiven array av pekare till person-objekt i angiven
+*              ordning. Vid lyckad sortering returneras 0, annars returneras 1.
+*
+*              - persons: Array innehållande pekare till objekten.
+*              - count  : Antal objekt i arrayen.
+*              - workers: Pekare till trådpoolen (null = enbart anropande tråd).
+*              - order  : Sorteringsordningen.
+********************************************************************************/
+int person_sort(const struct person** persons,
+                const size_t count,
+                struct person_workers* workers,
+                const enum person_sort_order order)
+{
+   if (count < 2) return 0;
+   const int descending = person_sort_descending(order);
+
+   if (order == PERSON_SORT_AGE || order == PERSON_SORT_AGE_DESCENDING)
+   {
+      return person_sort_age(persons, count, descending);
+   }
+   return person_sort_name(persons, count, workers, descending);
+}
+
+/********************************************************************************
+* person_sort_top: Lagrar de k första objekten i angiven ordning i angiven
+*                  resultatarray. Urvalet sker via en heap med k platser,
+*                  vilket kräver O(n log k) jämförelser.
+*
+*                  - persons: Array innehållande pekare till objekten.
+*                  - count  : Antal objekt i arrayen.
+*                  - k      : Antal objekt att välja ut.
+*                  - order  : Sorteringsordningen.
+*                  - result : Array där de utvalda objekten lagras i ordning.
+********************************************************************************/
+int person_sort_top(const struct person* const* persons,
+                    const size_t count,
+                    const size_t k,
+                    const enum person_sort_order order,
+                    const struct person** result)
+{
+   const size_t size = k < count ? k : count;
+   if (!size) return 0;
+   struct person_sort_entry* entries = person_sort_select(persons, count, size, order);
+   if (!entries) return 1;
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      result[i] = entries[i].item.person;
+   }
+
+   free(entries);
+   return 0;
+}
+
+/********************************************************************************
+* person_sort_partial: Sorterar angiven array partiellt, så att de k första
+*                      objekten i angiven ordning placeras först i sorterad
+*                      ordning, följda av övriga objekt i ursprunglig ordning.
+*
+*                      - persons: Array innehållande pekare till objekten.
+*                      - count  : Antal objekt i arrayen.
+*                      - k      : Antal objekt att sortera.
+*                      - order  : Sorteringsordningen.
+********************************************************************************/
+int person_sort_partial(const struct person** persons,
+                        const size_t count,
+                        const size_t k,
+                        const enum person_sort_order order)
+{
+   const size_t size = k < count ? k : count;
+   if (!size) return 0;
+   struct person_sort_entry* entries = person_sort_select(persons, count, size, order);
+   unsigned char* selected = (unsigned char*)calloc(count, 1);
+
+   if (!entries || !selected)
+   {
+      free(selected);
+      free(entries);
+      return 1;
+   }
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      selected[entries[i].index] = 1;
+   }
+
+   size_t rest = 0;
+   for (size_t i = 0; i < count; ++i)
+   {
+      if (!selected[i]) persons[rest++] = persons[i];
+   }
+
+   memmove(persons + size, persons, rest * sizeof(*persons));
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      persons[i] = entries[i].item.person;
+   }
+
+   free(selected);
+   free(entries);
+   return 0;
+}
+
+/********************************************************************************
+* person_sort_item_init: Läser sorteringsnyckeln för angivet objekt via dess
+*                        vtable.
+*
+*                        - self  : Pekare till nyckeln som ska initieras.
+*                        - person: Pekare till objektet.
+*                        - order : Sorteringsordningen.
+********************************************************************************/
+static void person_sort_item_init(struct person_sort_item* self,
+                                  const struct person* person,
+                                  const enum person_sort_order order)
+{
+   self->person = person;
+
+   if (order == PERSON_SORT_AGE || order == PERSON_SORT_AGE_DESCENDING)
+   {
+      self->key = person->vptr->age(person);
+      self->name = 0;
+   }
+   else
+   {
+      self->name = person->vptr->name(person);
+      if (!self->name) self->name = "";
+      self->key = person_sort_prefix(self->name);
+   }
+   return;
+}
+
+/********************************************************************************
+* person_sort_prefix: Returnerar angiven strängs första åtta tecken som ett
+*                     heltal, där det första tecknet lagras i den mest
+*                     signifikanta byten och kortare strängar fylls ut med
+*                     nollor. Heltalen jämförs därmed i samma ordning som
+*                     strängarna jämförs via strcmp.
+*
+*                     - s: Strängen vars prefix ska läsas.
+********************************************************************************/
+static uint64_t person_sort_prefix(const char* s)
+{
+   uint64_t key = 0;
+
+   for (size_t i = 0; i < 8; ++i)
+   {
+      key <<= 8;
+      if (*s) key |= (unsigned char)*s++;
+   }
+   return key;
+}
+
+/********************************************************************************
+* person_sort_descending: Indikerar ifall angiven ordning är fallande.
+*
+*                         - order: Sorteringsordningen.
+********************************************************************************/
+static int person_sort_descending(const enum person_sort_order order)
+{
+   return order == PERSON_SORT_AGE_DESCENDING || order == PERSON_SORT_NAME_DESCENDING;
+}
+
+/********************************************************************************
+* person_sort_compare: Jämför två sorteringsnycklar och returnerar ett
+*                      negativt värde, 0 eller ett positivt värde beroende på
+*                      om lhs ska placeras före, är likvärdig med eller ska
+*                      placeras efter rhs. Strängjämförelse sker endast när
+*                      namnens första åtta tecken är lika, där jämförelsen
+*                      då inleds efter prefixet.
+*
+*                      - lhs       : Pekare till första nyckeln.
+*                      - rhs       : Pekare till andra nyckeln.
+*                      - descending: Indikerar fallande ordning.
+********************************************************************************/
+static int person_sort_compare(const struct person_sort_item* lhs,
+                               const struct person_sort_item* rhs,
+                               const int descending)
+{
+   int result;
+
+   if (lhs->key != rhs->key) result = lhs->key < rhs->key ? -1 : 1;
+   else if (!lhs->name || !(lhs->key & 0xff)) return 0;
+   else result = strcmp(lhs->name + 8, rhs->name + 8);
+   return descending ? -result : result;
+}
+
+/********************************************************************************
+* person_sort_entry_compare: Jämför två nycklar i en heap, där lika nycklar
+*                            ordnas efter objektens ursprungliga index.
+*
+*                            - lhs       : Pekare till första nyckeln.
+*                            - rhs       : Pekare till andra nyckeln.
+*                            - descending: Indikerar fallande ordning.
+********************************************************************************/
+static int person_sort_entry_compare(const struct person_sort_entry* lhs,
+                                     const struct person_sort_entry* rhs,
+                                     const int descending)
+{
+   const int result = person_sort_compare(&lhs->item, &rhs->item, descending);
+   if (result) return result;
+   return lhs->index < rhs->index ? -1 : lhs->index > rhs->index;
+}
+
+/********************************************************************************
+* person_sort_age: Sorterar angiven array på ålder via LSD-radixsortering, en
+*                  byte i taget. Pass där samtliga åldrar har samma värde på
+*                  aktuell byte hoppas över, vilket för normala åldrar
+*                  innebär att enbart ett pass krävs. Vid lyckad sortering
+*                  returneras 0, annars returneras 1.
+*
+*                  - persons   : Array innehållande pekare till objekten.
+*                  - count     : Antal objekt i arrayen.
+*                  - descending: Indikerar fallande ordning.
+********************************************************************************/
+static int person_sort_age(const struct person** persons,
+                           const size_t count,
+                           const int descending)
+{
+   struct person_sort_age_item* items =
+      (struct person_sort_age_item*)malloc(2 * count * sizeof(struct person_sort_age_item));
+   size_t histograms[4][256];
+   if (!items) return 1;
+   memset(histograms, 0, sizeof(histograms));
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      const unsigned int age = persons[i]->vptr->age(persons[i]);
+      const uint32_t key = descending ? ~(uint32_t)age : (uint32_t)age;
+      items[i].key = key;
+      items[i].person = persons[i];
+
+      for (size_t j = 0; j < 4; ++j)
+      {
+         histograms[j][(key >> (8 * j)) & 0xff]++;
+      }
+   }
+
+   struct person_sort_age_item* source = items;
+   struct person_sort_age_item* destination = items + count;
+
+   for (size_t j = 0; j < 4; ++j)
+   {
+      const size_t shift = 8 * j;
+      size_t* histogram = histograms[j];
+      if (histogram[(source[0].key >> shift) & 0xff] == count) continue;
+
+      for (size_t digit = 0, offset = 0; digit < 256; ++digit)
+      {
+         const size_t digit_count = histogram[digit];
+         histogram[digit] = offset;
+         offset += digit_count;
+      }
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         destination[histogram[(source[i].key >> shift) & 0xff]++] = source[i];
+      }
+
+      struct person_sort_age_item* temp = source;
+      source = destination;
+      destination = temp;
+   }
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      persons[i] = source[i].person;
+   }
+
+   free(items);
+   return 0;
+}
+
+/********************************************************************************
+* person_sort_name: Sorterar angiven array på namn via mergesort. Stora arrayer
+*                   delas upp i en del per tråd, som sorteras parallellt,
+*                   varefter delarna slås samman parvis. Varje sammanslagning
+*                   fördelas i sin tur över samtliga trådar, där varje tråd
+*                   producerar en lika stor del av resultatet. Vid lyckad
+*                   sortering returneras 0, annars returneras 1.
+*
+*                   - persons   : Array innehållande pekare till objekten.
+*                   - count     : Antal objekt i arrayen.
+*                   - workers   : Pekare till trådpoolen (null = enbart anropande tråd).
+*                   - descending: Indikerar fallande ordning.
+********************************************************************************/
+static int person_sort_name(const struct person** persons,
+                            const size_t count,
+                            struct person_workers* workers,
+                            const int descending)
+{
+   const size_t threads = count < PERSON_SORT_PARALLEL_MIN ? 1 : person_workers_count(workers);
+   struct person_sort_item* items =
+      (struct person_sort_item*)malloc(2 * count * sizeof(struct person_sort_item));
+   size_t* bounds = (size_t*)malloc((threads + 1) * sizeof(size_t));
+
+   if (!items || !bounds)
+   {
+      free(bounds);
+      free(items);
+      return 1;
+   }
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      person_sort_item_init(&items[i], persons[i], descending ?
+                            PERSON_SORT_NAME_DESCENDING : PERSON_SORT_NAME);
+   }
+
+   struct person_sort_task task;
+   task.items = items;
+   task.buffer = items + count;
+   task.bounds = bounds;
+   task.chunks = threads;
+   task.descending = descending;
+
+   if (threads < 2)
+   {
+      person_sort_merge_sort(items, task.buffer, count, descending);
+      task.source = items;
+   }
+   else
+   {
+      for (size_t i = 0; i <= threads; ++i)
+      {
+         bounds[i] = count * i / threads;
+      }
+
+      person_workers_run(workers, &person_sort_chunk_job, &task);
+      task.source = items;
+      task.destination = task.buffer;
+
+      for (task.width = 1; task.width < threads; task.width *= 2)
+      {
+         person_workers_run(workers, &person_sort_merge_job, &task);
+         struct person_sort_item* temp = task.source;
+         task.source = task.destination;
+         task.destination = temp;
+      }
+   }
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      persons[i] = task.source[i].person;
+   }
+
+   free(bounds);
+   free(items);
+   return 0;
+}
+
+/********************************************************************************
+* person_sort_merge_sort: Sorterar angivna nycklar stabilt via rekursiv
+*                         mergesort, där korta sekvenser sorteras via
+*                         insättningssortering.
+*
+*                         - items     : Nycklarna som ska sorteras.
+*                         - buffer    : Buffert av minst samma storlek.
+*                         - count     : Antal nycklar.
+*                         - descending: Indikerar fallande ordning.
+********************************************************************************/
+static void person_sort_merge_sort(struct person_sort_item* items,
+                                   struct person_sort_item* buffer,
+                                   const size_t count,
+                                   const int descending)
+{
+   if (count <= PERSON_SORT_INSERTION_MAX)
+   {
+      for (size_t i = 1; i < count; ++i)
+      {
+         const struct person_sort_item item = items[i];
+         size_t j = i;
+
+         while (j > 0 && person_sort_compare(&items[j - 1], &item, descending) > 0)
+         {
+            items[j] = items[j - 1];
+            j--;
+         }
+         items[j] = item;
+      }
+      return;
+   }
+
+   const size_t half = count / 2;
+   person_sort_merge_sort(items, buffer, half, descending);
+   person_sort_merge_sort(items + half, buffer + half, count - half, descending);
+   if (person_sort_compare(&items[half - 1], &items[half], descending) <= 0) return;
+
+   memcpy(buffer, items, count * sizeof(struct person_sort_item));
+   person_sort_merge(buffer, half, buffer + half, count - half, items, descending);
+   return;
+}
+
+/********************************************************************************
+* person_sort_merge: Slår samman två sorterade sekvenser till angiven
+*                    destination. Vid lika nycklar placeras nyckeln från lhs
+*                    först, vilket gör sammanslagningen stabil.
+*
+*                    - lhs        : Första sekvensen.
+*                    - lhs_count  : Antal nycklar i första sekvensen.
+*                    - rhs        : Andra sekvensen.
+*                    - rhs_count  : Antal nycklar i andra sekvensen.
+*                    - destination: Destination för den sammanslagna sekvensen.
+*                    - descending : Indikerar fallande ordning.
+********************************************************************************/
+static void person_sort_merge(const struct person_sort_item* lhs,
+                              const size_t lhs_count,
+                              const struct person_sort_item* rhs,
+                              const size_t rhs_count,
+                              struct person_sort_item* destination,
+                              const int descending)
+{
+   size_t i = 0, j = 0;
+
+   while (i < lhs_count && j < rhs_count)
+   {
+      if (person_sort_compare(&rhs[j], &lhs[i], descending) < 0) *destination++ = rhs[j++];
+      else *destination++ = lhs[i++];
+   }
+
+   memcpy(destination, lhs + i, (lhs_count - i) * sizeof(struct person_sort_item));
+   memcpy(destination + (lhs_count - i), rhs + j, (rhs_count - j) * sizeof(struct person_sort_item));
+   return;
+}
+
+/********************************************************************************
+* person_sort_corank: Returnerar antalet nycklar från lhs bland de index
+*                     första nycklarna i sammanslagningen av lhs och rhs,
+*                     vilket beräknas via binärsökning. Därmed kan en
+*                     sammanslagning delas upp i oberoende delar.
+*
+*                     - index    : Antal nycklar i sammanslagningens början.
+*                     - lhs      : Första sekvensen.
+*                     - lhs_count: Antal nycklar i första sekvensen.
+*                     - rhs      : Andra sekvensen.
+*                     - rhs_count: Antal nycklar i andra sekvensen.
+*                     - descending: Indikerar fallande ordning.
+********************************************************************************/
+static size_t person_sort_corank(const size_t index,
+                                 const struct person_sort_item* lhs,
+                                 const size_t lhs_count,
+                                 const struct person_sort_item* rhs,
+                                 const size_t rhs_count,
+                                 const int descending)
+{
+   size_t low = index > rhs_count ? index - rhs_count : 0;
+   size_t high = index < lhs_count ? index : lhs_count;
+
+   while (low < high)
+   {
+      const size_t i = low + (high - low) / 2;
+      const size_t j = index - i;
+
+      if (j > 0 && person_sort_compare(&lhs[i], &rhs[j - 1], descending) <= 0) low = i + 1;
+      else high = i;
+   }
+   return low;
+}
+
+/********************************************************************************
+* person_sort_chunk_job: Sorterar trådens del av nycklarna.
+*
+*                        - context: Pekare till aktuell person_sort_task.
+*                        - worker : Trådens nummer.
+*                        - count  : Antal trådar som kör jobbet.
+********************************************************************************/
+static void person_sort_chunk_job(void* context,
+                                  const size_t worker,
+                                  const size_t count)
+{
+   struct person_sort_task* task = (struct person_sort_task*)context;
+   (void)count;
+   if (worker >= task->chunks) return;
+   const size_t begin = task->bounds[worker];
+   const size_t end = task->bounds[worker + 1];
+   person_sort_merge_sort(task->items + begin, task->buffer + begin, end - begin, task->descending);
+   return;
+}
+
+/********************************************************************************
+* person_sort_merge_job: Slår samman samtliga par av sorterade sekvenser med
+*                        aktuell bredd, där tråden producerar sin andel av
+*                        varje sammanslagen sekvens.
+*
+*                        - context: Pekare till aktuell person_sort_task.
+*                        - worker : Trådens nummer.
+*                        - count  : Antal trådar som kör jobbet.
+********************************************************************************/
+static void person_sort_merge_job(void* context,
+                                  const size_t worker,
+                                  const size_t count)
+{
+   const struct person_sort_task* task = (const struct person_sort_task*)context;
+   const size_t* bounds = task->bounds;
+
+   for (size_t left = 0; left < task->chunks; left += 2 * task->width)
+   {
+      const size_t middle = left + task->width < task->chunks ? left + task->width : task->chunks;
+      const size_t right = left + 2 * task->width < task->chunks ? left + 2 * task->width : task->chunks;
+      const struct person_sort_item* lhs = task->source + bounds[left];
+      const struct person_sort_item* rhs = task->source + bounds[middle];
+      const size_t lhs_count = bounds[middle] - bounds[left];
+      const size_t rhs_count = bounds[right] - bounds[middle];
+      const size_t total = lhs_count + rhs_count;
+      const size_t begin = total * worker / count;
+      const size_t end = total * (worker + 1) / count;
+      const size_t lhs_begin = person_sort_corank(begin, lhs, lhs_count, rhs, rhs_count, task->descending);
+      const size_t lhs_end = person_sort_corank(end, lhs, lhs_count, rhs, rhs_count, task->descending);
+
+      person_sort_merge(lhs + lhs_begin, lhs_end - lhs_begin, rhs + (begin - lhs_begin),
+                        (end - lhs_end) - (begin - lhs_begin),
+                        task->destination + bounds[left] + begin, task->descending);
+   }
+   return;
+}
+
+/********************************************************************************
+* person_sort_select: Väljer ut de k första objekten i angiven ordning via en
+*                     heap med k platser, där det sämsta utvalda objektet
+*                     ligger i roten. Heapen sorteras sedan på plats. En
+*                     pekare till de sorterade nycklarna returneras, eller
+*                     null om minnesallokeringen misslyckas.
+*
+*                     - persons: Array innehållande pekare till objekten.
+*                     - count  : Antal objekt i arrayen.
+*                     - k      : Antal objekt att välja ut (1 till count).
+*                     - order  : Sorteringsordningen.
+********************************************************************************/
+static struct person_sort_entry* person_sort_select(const struct person* const* persons,
+                                                    const size_t count,
+                                                    const size_t k,
+                                                    const enum person_sort_order order)
+{
+   const int descending = person_sort_descending(order);
+   struct person_sort_entry* heap = (struct person_sort_entry*)malloc(k * sizeof(struct person_sort_entry));
+   if (!heap) return 0;
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      struct person_sort_entry entry;
+      person_sort_item_init(&entry.item, persons[i], order);
+      entry.index = i;
+
+      if (i < k)
+      {
+         size_t j = i;
+         while (j > 0 && person_sort_entry_compare(&heap[(j - 1) / 2], &entry, descending) < 0)
+         {
+            heap[j] = heap[(j - 1) / 2];
+            j = (j - 1) / 2;
+         }
+         heap[j] = entry;
+      }
+      else if (person_sort_entry_compare(&entry, &heap[0], descending) < 0)
+      {
+         heap[0] = entry;
+         person_sort_sift_down(heap, k, 0, descending);
+      }
+   }
+
+   for (size_t size = k; size > 1; --size)
+   {
+      const struct person_sort_entry last = heap[0];
+      heap[0] = heap[size - 1];
+      heap[size - 1] = last;
+      person_sort_sift_down(heap, size - 1, 0, descending);
+   }
+   return heap;
+}
+
+/********************************************************************************
+* person_sort_sift_down: Flyttar nyckeln på angivet index nedåt i angiven
+*                        heap tills heapens ordning är återställd, där den
+*                        största nyckeln ligger i roten.
+*
+*                        - heap      : Heapen.
+*                        - size      : Antal nycklar i heapen.
+*                        - index     : Index för nyckeln som ska flyttas.
+*                        - descending: Indikerar fallande ordning.
+********************************************************************************/
+static void person_sort_sift_down(struct person_sort_entry* heap,
+                                  const size_t size,
+                                  size_t index,
+                                  const int descending)
+{
+   const struct person_sort_entry entry = heap[index];
+
+   while (2 * index + 1 < size)
+   {
+      size_t child = 2 * index + 1;
+      if (child + 1 < size &&
+          person_sort_entry_compare(&heap[child], &heap[child + 1], descending) < 0) child++;
+      if (person_sort_entry_compare(&heap[child], &entry, descending) <= 0) break;
+      heap[index] = heap[child];
+      index = child;
+   }
+
+   heap[index] = entry;
+   return;
+}
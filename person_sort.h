@@ -0,0 +1,88 @@
+/********************************************************************************
+* person_sort.h: Innehåller sortering, partiell sortering samt urval av de k
+*                första person-objekten i en array av pekare till
+*                person-objekt, ordnade efter ålder eller namn.
+*
+*                Istället för att läsa persondatan via objektens vtable vid
+*                varje jämförelse (som vid qsort med en jämförelsefunktion)
+*                läses sorteringsnyckeln en gång per objekt. Sortering på
+*                ålder sker via radixsortering i linjär tid. Sortering på
+*                namn sker via mergesort, där namnets första åtta tecken
+*                lagras som ett heltal så att de flesta jämförelser sker
+*                utan strängjämförelse. Stora arrayer sorteras i delar av
+*                trådarna i en person_workers, varefter delarna slås samman
+*                parallellt.
+*
+*                Samtliga sorteringar är stabila, dvs. objekt med samma
+*                nyckel behåller sin inbördes ordning.
+********************************************************************************/
+#ifndef PERSON_SORT_H_
+#define PERSON_SORT_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+#include "person_workers.h"
+
+/********************************************************************************
+* person_sort_order: Enumeration för sorteringsordning.
+********************************************************************************/
+typedef enum person_sort_order
+{
+   PERSON_SORT_AGE,            /* Stigande ålder. */
+   PERSON_SORT_AGE_DESCENDING, /* Fallande ålder. */
+   PERSON_SORT_NAME,           /* Stigande namn (bytevis jämförelse som strcmp). */
+   PERSON_SORT_NAME_DESCENDING /* Fallande namn. */
+} person_sort_order_t;
+
+/********************************************************************************
+* person_sort: Sorterar angiven array av pekare till person-objekt i angiven
+*              ordning. Vid lyckad sortering returneras 0, annars returneras 1
+*              och arrayen lämnas oförändrad.
+*
+*              - persons: Array innehållande pekare till objekten.
+*              - count  : Antal objekt i arrayen.
+*              - workers: Pekare till trådpoolen (null = enbart anropande tråd).
+*              - order  : Sorteringsordningen.
+********************************************************************************/
+int person_sort(const struct person** persons,
+                const size_t count,
+                struct person_workers* workers,
+                const enum person_sort_order order);
+
+/********************************************************************************
+* person_sort_top: Lagrar de k första objekten i angiven ordning i angiven
+*                  resultatarray, som måste rymma minst min(k, count) pekare.
+*                  Angiven array ändras inte. Vid lyckat urval returneras 0,
+*                  annars returneras 1.
+*
+*                  - persons: Array innehållande pekare till objekten.
+*                  - count  : Antal objekt i arrayen.
+*                  - k      : Antal objekt att välja ut.
+*                  - order  : Sorteringsordningen.
+*                  - result : Array där de utvalda objekten lagras i ordning.
+********************************************************************************/
+int person_sort_top(const struct person* const* persons,
+                    const size_t count,
+                    const size_t k,
+                    const enum person_sort_order order,
+                    const struct person** result);
+
+/********************************************************************************
+* person_sort_partial: Sorterar angiven array partiellt, så att de k första
+*                      objekten i angiven ordning placeras först i arrayen i
+*                      sorterad ordning, följda av övriga objekt i sin
+*                      ursprungliga inbördes ordning. Vid lyckad sortering
+*                      returneras 0, annars returneras 1 och arrayen lämnas
+*                      oförändrad.
+*
+*                      - persons: Array innehållande pekare till objekten.
+*                      - count  : Antal objekt i arrayen.
+*                      - k      : Antal objekt att sortera.
+*                      - order  : Sorteringsordningen.
+********************************************************************************/
+int person_sort_partial(const struct person** persons,
+                        const size_t count,
+                        const size_t k,
+                        const enum person_sort_order order);
+
+#endif /* PERSON_SORT_H_ */
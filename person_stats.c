@@ -0,0 +1,375 @@
+/********************************************************************************
+* person_stats.c: Innehåller definitioner av funktioner för instrumentering av
+*                 person-objektens heta funktioner. Varje tråd uppdaterar
+*                 enbart sina egna räknare, vilket gör att mätpunkterna inte
+*                 kräver några lås. Trådarnas räknare länkas samman i en
+*                 lista som summeras vid avläsning.
+********************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "person_stats.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/********************************************************************************
+* person_stats_local_latency: Latenser för en funktion i en enskild tråd.
+********************************************************************************/
+struct person_stats_local_latency
+{
+   _Atomic uint64_t calls;                           /* Antal anrop. */
+   _Atomic uint64_t total_ns;                        /* Sammanlagd tid i nanosekunder. */
+   _Atomic uint64_t max_ns;                          /* Längsta uppmätta tid. */
+   _Atomic uint64_t histogram[PERSON_STATS_BUCKETS]; /* Antal anrop per latenshink. */
+};
+
+/********************************************************************************
+* person_stats_local: Räknare och latenser för en enskild tråd. Enbart den
+*                     ägande tråden skriver, medan avläsning kan ske från
+*                     valfri tråd, därav atomiska variabler.
+********************************************************************************/
+struct person_stats_local
+{
+   _Atomic uint64_t counters[PERSON_STATS_COUNTERS];            /* Trådens räknare. */
+   struct person_stats_local_latency latency[PERSON_STATS_OPS]; /* Trådens latenser. */
+   struct person_stats_local* next;                             /* Nästa tråd i listan. */
+};
+
+/* Mutex som skyddar listan över trådar samt summan från avslutade trådar. */
+static pthread_mutex_t person_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Lista innehållande räknarna för samtliga levande trådar. */
+static struct person_stats_local* person_stats_threads = 0;
+
+/* Summerade räknare från trådar som har avslutats. */
+static struct person_stats person_stats_retired;
+
+/* Nyckel vars destruktor flyttar en avslutad tråds räknare till person_stats_retired. */
+static pthread_key_t person_stats_key;
+static pthread_once_t person_stats_once = PTHREAD_ONCE_INIT;
+
+/* Den anropande trådens räknare, allokeras vid första mätningen. */
+static _Thread_local struct person_stats_local* person_stats_self = 0;
+
+/* Namn på räknare samt funktioner vid utskrift. */
+static const char* person_stats_counter_names[PERSON_STATS_COUNTERS] =
+{
+   "alloc_calls", "alloc_bytes", "free_calls", "free_bytes", "bytes_written"
+};
+
+static const char* person_stats_op_names[PERSON_STATS_OPS] =
+{
+   "person_mem_new", "person_mem_delete", "person_new", "person_delete", "person_print"
+};
+
+/* Statiska funktioner: */
+static struct person_stats_local* person_stats_local(void);
+static void person_stats_key_init(void);
+static void person_stats_thread_exit(void* arg);
+static void person_stats_merge(struct person_stats* self,
+                               struct person_stats_local* local);
+static void person_stats_add(_Atomic uint64_t* counter,
+                             const uint64_t value);
+
+/********************************************************************************
+* person_stats_enabled: Returnerar 1 om instrumenteringen är aktiverad vid
+*                       kompilering, annars 0.
+********************************************************************************/
+int person_stats_enabled(void)
+{
+#ifdef PERSON_STATS
+   return 1;
+#else
+   return 0;
+#endif
+}
+
+/********************************************************************************
+* person_stats_snapshot: Summerar räknare och latenser från samtliga trådar,
+*                        inklusive avslutade trådar, i angiven strukt.
+*
+*                        - self: Pekare till strukten där summan lagras.
+********************************************************************************/
+void person_stats_snapshot(struct person_stats* self)
+{
+   pthread_mutex_lock(&person_stats_mutex);
+   *self = person_stats_retired;
+
+   for (struct person_stats_local* i = person_stats_threads; i; i = i->next)
+   {
+      person_stats_merge(self, i);
+   }
+
+   pthread_mutex_unlock(&person_stats_mutex);
+   return;
+}
+
+/********************************************************************************
+* person_stats_reset: Nollställer samtliga trådars räknare och latenser.
+*                     Uppdateringar som sker samtidigt kan gå förlorade, så
+*                     funktionen bör anropas när inga mätningar pågår.
+********************************************************************************/
+void person_stats_reset(void)
+{
+   pthread_mutex_lock(&person_stats_mutex);
+   memset(&person_stats_retired, 0, sizeof(person_stats_retired));
+
+   for (struct person_stats_local* i = person_stats_threads; i; i = i->next)
+   {
+      for (size_t j = 0; j < PERSON_STATS_COUNTERS; ++j)
+      {
+         atomic_store_explicit(&i->counters[j], 0, memory_order_relaxed);
+      }
+
+      for (size_t j = 0; j < PERSON_STATS_OPS; ++j)
+      {
+         struct person_stats_local_latency* latency = i->latency + j;
+         atomic_store_explicit(&latency->calls, 0, memory_order_relaxed);
+         atomic_store_explicit(&latency->total_ns, 0, memory_order_relaxed);
+         atomic_store_explicit(&latency->max_ns, 0, memory_order_relaxed);
+
+         for (size_t k = 0; k < PERSON_STATS_BUCKETS; ++k)
+         {
+            atomic_store_explicit(&latency->histogram[k], 0, memory_order_relaxed);
+         }
+      }
+   }
+
+   pthread_mutex_unlock(&person_stats_mutex);
+   return;
+}
+
+/********************************************************************************
+* person_stats_percentile: Returnerar en övre gräns i nanosekunder för angiven
+*                          percentil (0.0 - 1.0) av uppmätta latenser, dvs.
+*                          övre gränsen för den hink där percentilen hamnar.
+*                          Om inga anrop har gjorts returneras 0.
+*
+*                          - self      : Pekare till aktuella latenser.
+*                          - percentile: Percentilen, exempelvis 0.99.
+********************************************************************************/
+uint64_t person_stats_percentile(const struct person_stats_latency* self,
+                                 const double percentile)
+{
+   uint64_t total = 0;
+   for (size_t i = 0; i < PERSON_STATS_BUCKETS; ++i)
+   {
+      total += self->histogram[i];
+   }
+   if (!total) return 0;
+
+   uint64_t target = (uint64_t)(percentile * total + 0.5);
+   if (target < 1) target = 1;
+   if (target > total) target = total;
+
+   uint64_t seen = 0;
+   for (size_t i = 0; i < PERSON_STATS_BUCKETS; ++i)
+   {
+      seen += self->histogram[i];
+      if (seen >= target)
+      {
+         const uint64_t upper = (uint64_t)1 << (i + 1);
+         return upper < self->max_ns ? upper : self->max_ns;
+      }
+   }
+   return self->max_ns;
+}
+
+/********************************************************************************
+* person_stats_dump: Skriver ut angiven ögonblicksbild via angiven utström.
+*
+*                    - self   : Pekare till ögonblicksbilden.
+*                    - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+void person_stats_dump(const struct person_stats* self,
+                       FILE* ostream)
+{
+   if (!ostream) ostream = stdout;
+   fprintf(ostream, "--------------------------------------------------------------------------------\n");
+
+   for (size_t i = 0; i < PERSON_STATS_COUNTERS; ++i)
+   {
+      fprintf(ostream, "%-18s %20llu\n", person_stats_counter_names[i],
+              (unsigned long long)self->counters[i]);
+   }
+
+   fprintf(ostream, "\n%-18s %12s %10s %10s %10s %10s\n",
+           "function", "calls", "mean_ns", "p50_ns", "p99_ns", "max_ns");
+
+   for (size_t i = 0; i < PERSON_STATS_OPS; ++i)
+   {
+      const struct person_stats_latency* latency = self->latency + i;
+      fprintf(ostream, "%-18s %12llu %10.1f %10llu %10llu %10llu\n",
+              person_stats_op_names[i], (unsigned long long)latency->calls,
+              latency->calls ? (double)latency->total_ns / latency->calls : 0.0,
+              (unsigned long long)person_stats_percentile(latency, 0.5),
+              (unsigned long long)person_stats_percentile(latency, 0.99),
+              (unsigned long long)latency->max_ns);
+   }
+
+   fprintf(ostream, "--------------------------------------------------------------------------------\n\n");
+   return;
+}
+
+/********************************************************************************
+* person_stats_now: Returnerar aktuell tid i nanosekunder från en monoton klocka.
+********************************************************************************/
+uint64_t person_stats_now(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/********************************************************************************
+* person_stats_count: Räknar upp angiven räknare för den anropande tråden.
+*
+*                     - counter: Räknaren som ska räknas upp.
+*                     - value  : Värdet som ska adderas.
+********************************************************************************/
+void person_stats_count(const enum person_stats_counter counter,
+                        const uint64_t value)
+{
+   struct person_stats_local* self = person_stats_local();
+   if (!self) return;
+   person_stats_add(&self->counters[counter], value);
+   return;
+}
+
+/********************************************************************************
+* person_stats_record: Registrerar ett anrop av angiven funktion med angiven
+*                      latens för den anropande tråden.
+*
+*                      - op: Funktionen som anropades.
+*                      - ns: Anropets latens i nanosekunder.
+********************************************************************************/
+void person_stats_record(const enum person_stats_op op,
+                         const uint64_t ns)
+{
+   struct person_stats_local* self = person_stats_local();
+   if (!self) return;
+
+   struct person_stats_local_latency* latency = self->latency + op;
+   size_t bucket = ns ? 63 - (size_t)__builtin_clzll(ns) : 0;
+   if (bucket >= PERSON_STATS_BUCKETS) bucket = PERSON_STATS_BUCKETS - 1;
+
+   person_stats_add(&latency->calls, 1);
+   person_stats_add(&latency->total_ns, ns);
+   person_stats_add(&latency->histogram[bucket], 1);
+
+   if (ns > atomic_load_explicit(&latency->max_ns, memory_order_relaxed))
+   {
+      atomic_store_explicit(&latency->max_ns, ns, memory_order_relaxed);
+   }
+   return;
+}
+
+/********************************************************************************
+* person_stats_local: Returnerar den anropande trådens räknare. Vid första
+*                     anropet allokeras räknarna och läggs till i listan över
+*                     trådar. Om minnesallokeringen misslyckas returneras null.
+********************************************************************************/
+static struct person_stats_local* person_stats_local(void)
+{
+   if (person_stats_self) return person_stats_self;
+
+   pthread_once(&person_stats_once, &person_stats_key_init);
+   struct person_stats_local* self = (struct person_stats_local*)calloc(1, sizeof(struct person_stats_local));
+   if (!self) return 0;
+
+   pthread_mutex_lock(&person_stats_mutex);
+   self->next = person_stats_threads;
+   person_stats_threads = self;
+   pthread_mutex_unlock(&person_stats_mutex);
+
+   pthread_setspecific(person_stats_key, self);
+   person_stats_self = self;
+   return self;
+}
+
+/********************************************************************************
+* person_stats_key_init: Skapar nyckeln vars destruktor anropas när en tråd
+*                        med allokerade räknare avslutas.
+********************************************************************************/
+static void person_stats_key_init(void)
+{
+   pthread_key_create(&person_stats_key, &person_stats_thread_exit);
+   return;
+}
+
+/********************************************************************************
+* person_stats_thread_exit: Flyttar en avslutad tråds räknare till summan för
+*                           avslutade trådar och frigör räknarna.
+*
+*                           - arg: Pekare till trådens räknare.
+********************************************************************************/
+static void person_stats_thread_exit(void* arg)
+{
+   struct person_stats_local* self = (struct person_stats_local*)arg;
+   pthread_mutex_lock(&person_stats_mutex);
+   person_stats_merge(&person_stats_retired, self);
+
+   for (struct person_stats_local** i = &person_stats_threads; *i; i = &(*i)->next)
+   {
+      if (*i == self)
+      {
+         *i = self->next;
+         break;
+      }
+   }
+
+   pthread_mutex_unlock(&person_stats_mutex);
+   person_stats_self = 0;
+   free(self);
+   return;
+}
+
+/********************************************************************************
+* person_stats_merge: Adderar en tråds räknare och latenser till angiven summa.
+*
+*                     - self : Pekare till summan.
+*                     - local: Pekare till trådens räknare.
+********************************************************************************/
+static void person_stats_merge(struct person_stats* self,
+                               struct person_stats_local* local)
+{
+   for (size_t i = 0; i < PERSON_STATS_COUNTERS; ++i)
+   {
+      self->counters[i] += atomic_load_explicit(&local->counters[i], memory_order_relaxed);
+   }
+
+   for (size_t i = 0; i < PERSON_STATS_OPS; ++i)
+   {
+      struct person_stats_latency* latency = self->latency + i;
+      struct person_stats_local_latency* source = local->latency + i;
+      const uint64_t max_ns = atomic_load_explicit(&source->max_ns, memory_order_relaxed);
+
+      latency->calls += atomic_load_explicit(&source->calls, memory_order_relaxed);
+      latency->total_ns += atomic_load_explicit(&source->total_ns, memory_order_relaxed);
+      if (max_ns > latency->max_ns) latency->max_ns = max_ns;
+
+      for (size_t j = 0; j < PERSON_STATS_BUCKETS; ++j)
+      {
+         latency->histogram[j] += atomic_load_explicit(&source->histogram[j], memory_order_relaxed);
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* person_stats_add: Adderar angivet värde till angiven räknare. Eftersom enbart
+*                   den ägande tråden skriver till räknaren räcker en atomisk
+*                   läsning följd av en atomisk skrivning, vilket undviker
+*                   kostnaden för en låst instruktion.
+*
+*                   - counter: Pekare till räknaren.
+*                   - value  : Värdet som ska adderas.
+********************************************************************************/
+static void person_stats_add(_Atomic uint64_t* counter,
+                             const uint64_t value)
+{
+   atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+                         memory_order_relaxed);
+   return;
+}
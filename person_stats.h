@@ -0,0 +1,159 @@
+/********************************************************************************
+* person_stats.h: Innehåller valbar instrumentering av person-objektens
+*                 heta funktioner (person_mem_new, person_mem_delete,
+*                 person_new, person_delete samt person_print). Antal
+*                 allokeringar, allokerade bytes, antal anrop, utskrivna
+*                 bytes samt latenshistogram räknas per tråd och summeras
+*                 vid avläsning via person_stats_snapshot.
+*
+*                 Instrumenteringen aktiveras genom att makrot PERSON_STATS
+*                 definieras vid kompilering (exempelvis via cmake
+*                 -DPERSON_STATS=ON). Annars ersätts mätpunkterna av tomma
+*                 makron och medför ingen kostnad, medan avläsningen
+*                 returnerar nollställda värden.
+********************************************************************************/
+#ifndef PERSON_STATS_H_
+#define PERSON_STATS_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdio.h>
+#include <stdint.h>
+
+/* Antal hinkar per latenshistogram, där hink i rymmer latenser i [2^i, 2^(i + 1)) ns. */
+#define PERSON_STATS_BUCKETS 32
+
+/********************************************************************************
+* person_stats_counter: Enumeration för de räknare som uppdateras av instrumenteringen.
+********************************************************************************/
+enum person_stats_counter
+{
+   PERSON_STATS_ALLOC_CALLS,   /* Antal allokeringar. */
+   PERSON_STATS_ALLOC_BYTES,   /* Antal allokerade bytes. */
+   PERSON_STATS_FREE_CALLS,    /* Antal frigöranden. */
+   PERSON_STATS_FREE_BYTES,    /* Antal frigjorda bytes. */
+   PERSON_STATS_BYTES_WRITTEN, /* Antal bytes skrivna via person_print. */
+   PERSON_STATS_COUNTERS       /* Antal räknare. */
+};
+
+/********************************************************************************
+* person_stats_op: Enumeration för de funktioner vars latens mäts.
+********************************************************************************/
+enum person_stats_op
+{
+   PERSON_STATS_MEM_NEW,    /* person_mem_new. */
+   PERSON_STATS_MEM_DELETE, /* person_mem_delete. */
+   PERSON_STATS_NEW,        /* person_new samt person_new_with. */
+   PERSON_STATS_DELETE,     /* person_delete samt person_delete_with. */
+   PERSON_STATS_PRINT,      /* person_print. */
+   PERSON_STATS_OPS         /* Antal funktioner. */
+};
+
+/********************************************************************************
+* person_stats_latency: Strukt innehållande antal anrop samt latenser för en
+*                       instrumenterad funktion.
+********************************************************************************/
+typedef struct person_stats_latency
+{
+   uint64_t calls;                           /* Antal anrop. */
+   uint64_t total_ns;                        /* Sammanlagd tid i nanosekunder. */
+   uint64_t max_ns;                          /* Längsta uppmätta tid i nanosekunder. */
+   uint64_t histogram[PERSON_STATS_BUCKETS]; /* Antal anrop per latenshink. */
+} person_stats_latency_t;
+
+/********************************************************************************
+* person_stats: Strukt innehållande en ögonblicksbild av samtliga räknare och
+*               latenser, summerade över samtliga trådar.
+********************************************************************************/
+typedef struct person_stats
+{
+   uint64_t counters[PERSON_STATS_COUNTERS];              /* Räknare, se person_stats_counter. */
+   struct person_stats_latency latency[PERSON_STATS_OPS]; /* Latenser, se person_stats_op. */
+} person_stats_t, *person_stats_ptr_t;
+
+/********************************************************************************
+* person_stats_enabled: Returnerar 1 om instrumenteringen är aktiverad vid
+*                       kompilering, annars 0.
+********************************************************************************/
+int person_stats_enabled(void);
+
+/********************************************************************************
+* person_stats_snapshot: Summerar räknare och latenser från samtliga trådar,
+*                        inklusive avslutade trådar, i angiven strukt.
+*
+*                        - self: Pekare till strukten där summan lagras.
+********************************************************************************/
+void person_stats_snapshot(struct person_stats* self);
+
+/********************************************************************************
+* person_stats_reset: Nollställer samtliga trådars räknare och latenser.
+*                     Uppdateringar som sker samtidigt kan gå förlorade, så
+*                     funktionen bör anropas när inga mätningar pågår.
+********************************************************************************/
+void person_stats_reset(void);
+
+/********************************************************************************
+* person_stats_percentile: Returnerar en övre gräns i nanosekunder för angiven
+*                          percentil (0.0 - 1.0) av uppmätta latenser, dvs.
+*                          övre gränsen för den hink där percentilen hamnar.
+*                          Om inga anrop har gjorts returneras 0.
+*
+*                          - self      : Pekare till aktuella latenser.
+*                          - percentile: Percentilen, exempelvis 0.99.
+********************************************************************************/
+uint64_t person_stats_percentile(const struct person_stats_latency* self,
+                                 const double percentile);
+
+/********************************************************************************
+* person_stats_dump: Skriver ut angiven ögonblicksbild via angiven utström.
+*
+*                    - self   : Pekare till ögonblicksbilden.
+*                    - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+void person_stats_dump(const struct person_stats* self,
+                       FILE* ostream);
+
+/********************************************************************************
+* person_stats_now: Returnerar aktuell tid i nanosekunder från en monoton klocka.
+********************************************************************************/
+uint64_t person_stats_now(void);
+
+/********************************************************************************
+* person_stats_count: Räknar upp angiven räknare för den anropande tråden.
+*
+*                     - counter: Räknaren som ska räknas upp.
+*                     - value  : Värdet som ska adderas.
+********************************************************************************/
+void person_stats_count(const enum person_stats_counter counter,
+                        const uint64_t value);
+
+/********************************************************************************
+* person_stats_record: Registrerar ett anrop av angiven funktion med angiven
+*                      latens för den anropande tråden.
+*
+*                      - op: Funktionen som anropades.
+*                      - ns: Anropets latens i nanosekunder.
+********************************************************************************/
+void person_stats_record(const enum person_stats_op op,
+                         const uint64_t ns);
+
+/********************************************************************************
+* Mätpunkter som används i de instrumenterade funktionerna. Om PERSON_STATS
+* inte är definierat så kompileras samtliga mätpunkter bort.
+********************************************************************************/
+#ifdef PERSON_STATS
+#define PERSON_STATS_START(start) const uint64_t start = person_stats_now()
+#define PERSON_STATS_STOP(op, start) person_stats_record((op), person_stats_now() - (start))
+#define PERSON_STATS_ALLOC(size) (person_stats_count(PERSON_STATS_ALLOC_CALLS, 1), \
+                                  person_stats_count(PERSON_STATS_ALLOC_BYTES, (size)))
+#define PERSON_STATS_FREE(size) (person_stats_count(PERSON_STATS_FREE_CALLS, 1), \
+                                 person_stats_count(PERSON_STATS_FREE_BYTES, (size)))
+#define PERSON_STATS_WRITE(bytes) person_stats_count(PERSON_STATS_BYTES_WRITTEN, (bytes))
+#else
+#define PERSON_STATS_START(start) ((void)0)
+#define PERSON_STATS_STOP(op, start) ((void)0)
+#define PERSON_STATS_ALLOC(size) ((void)0)
+#define PERSON_STATS_FREE(size) ((void)0)
+#define PERSON_STATS_WRITE(bytes) ((void)(bytes))
+#endif /* PERSON_STATS */
+
+#endif /* PERSON_STATS_H_ */
@@ -0,0 +1,534 @@
+/********************************************************************************
+* person_store.c: Innehåller definitioner av associerade funktioner tillhörande
+*                 strukten person_store, som används för kolumnbaserad lagring
+*                 av stora mängder persondata.
+********************************************************************************/
+#include "person_store.h"
+#include "person_writer.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Antal textfält per post (namn, hemadress och yrke). */
+#define PERSON_STORE_STRINGS 3
+
+/* Statiska funktioner: */
+static const struct person_vtable* person_store_vtable_ptr_new(void);
+static int person_store_grow(struct person_store* self);
+static int person_store_strings_reserve(struct person_store* self,
+                                        const char* strings[PERSON_STORE_STRINGS]);
+static size_t person_store_string_new(struct person_store* self,
+                                      const char* s);
+static const char* person_store_view_name(const struct person* self);
+static unsigned int person_store_view_age(const struct person* self);
+static const char* person_store_view_address(const struct person* self);
+static const char* person_store_view_occupation(const struct person* self);
+static enum gender person_store_view_gender(const struct person* self);
+static const char* person_store_view_gender_str(const struct person* self);
+static void person_store_view_clear(struct person* self);
+
+/********************************************************************************
+* person_store_init: Initierar en ny tom person_store.
+*
+*                    - self: Pekare till objektet som ska initieras.
+********************************************************************************/
+void person_store_init(struct person_store* self)
+{
+   self->ages = 0;
+   self->genders = 0;
+   self->names = 0;
+   self->addresses = 0;
+   self->occupations = 0;
+   self->strings = 0;
+   self->strings_size = 0;
+   self->strings_capacity = 0;
+   self->size = 0;
+   self->capacity = 0;
+   return;
+}
+
+/********************************************************************************
+* person_store_clear: Frigör minne allokerat av angiven person_store och
+*                     nollställer denna.
+*
+*                     - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_store_clear(struct person_store* self)
+{
+   free(self->ages);
+   free(self->genders);
+   free(self->names);
+   free(self->addresses);
+   free(self->occupations);
+   free(self->strings);
+   person_store_init(self);
+   return;
+}
+
+/********************************************************************************
+* person_store_reserve: Allokerar minne så att minst angivet antal personer
+*                       ryms utan ytterligare omallokering. Vid lyckad
+*                       allokering returneras 0, annars returneras 1.
+*
+*                       - self    : Pekare till aktuell person_store.
+*                       - capacity: Antal personer som ska rymmas.
+********************************************************************************/
+int person_store_reserve(struct person_store* self,
+                         const size_t capacity)
+{
+   if (capacity <= self->capacity) return 0;
+
+   unsigned int* ages = (unsigned int*)realloc(self->ages, capacity * sizeof(unsigned int));
+   if (!ages) return 1;
+   self->ages = ages;
+
+   unsigned char* genders = (unsigned char*)realloc(self->genders, capacity);
+   if (!genders) return 1;
+   self->genders = genders;
+
+   size_t* names = (size_t*)realloc(self->names, capacity * sizeof(size_t));
+   if (!names) return 1;
+   self->names = names;
+
+   size_t* addresses = (size_t*)realloc(self->addresses, capacity * sizeof(size_t));
+   if (!addresses) return 1;
+   self->addresses = addresses;
+
+   size_t* occupations = (size_t*)realloc(self->occupations, capacity * sizeof(size_t));
+   if (!occupations) return 1;
+   self->occupations = occupations;
+
+   self->capacity = capacity;
+   return 0;
+}
+
+/********************************************************************************
+* person_store_push: Lägger till en ny person sist i angiven person_store.
+*                    Textfälten kopieras in i strängpoolen, vilket medför att
+*                    anroparen inte behöver behålla originalsträngarna. En
+*                    nullpekare lagras som en tom sträng. Vid lyckad
+*                    tilläggning returneras 0, annars returneras 1.
+*
+*                    - self      : Pekare till aktuell person_store.
+*                    - name      : Personens namn.
+*                    - age       : Personens ålder.
+*                    - address   : Personens hemadress.
+*                    - occupation: Personens yrke.
+*                    - gender    : Personens kön.
+********************************************************************************/
+int person_store_push(struct person_store* self,
+                      const char* name,
+                      const unsigned int age,
+                      const char* address,
+                      const char* occupation,
+                      const enum gender gender)
+{
+   const char* strings[PERSON_STORE_STRINGS] = { name ? name : "", address ? address : "",
+                                                 occupation ? occupation : "" };
+   size_t offsets[PERSON_STORE_STRINGS];
+
+   if (self->size == self->capacity && person_store_grow(self)) return 1;
+   if (person_store_strings_reserve(self, strings)) return 1;
+
+   for (size_t i = 0; i < PERSON_STORE_STRINGS; ++i)
+   {
+      offsets[i] = person_store_string_new(self, strings[i]);
+   }
+
+   self->ages[self->size] = age;
+   self->genders[self->size] = (unsigned char)gender;
+   self->names[self->size] = offsets[0];
+   self->addresses[self->size] = offsets[1];
+   self->occupations[self->size] = offsets[2];
+   self->size++;
+   return 0;
+}
+
+/********************************************************************************
+* person_store_push_person: Kopierar persondata från angivet person-objekt och
+*                           lägger till denna sist i angiven person_store.
+*                           Vid lyckad tilläggning returneras 0, annars 1.
+*
+*                           - self  : Pekare till aktuell person_store.
+*                           - person: Pekare till objektet vars data ska kopieras.
+********************************************************************************/
+int person_store_push_person(struct person_store* self,
+                             const struct person* person)
+{
+   return person_store_push(self, person->vptr->name(person), person->vptr->age(person),
+                            person->vptr->address(person), person->vptr->occupation(person),
+                            person->vptr->gender(person));
+}
+
+/********************************************************************************
+* person_store_remove: Tar bort posten på angivet index genom att flytta den
+*                      sista posten till dess plats. Borttagningen sker därmed
+*                      i konstant tid, men postordningen bevaras inte. Texten
+*                      för den borttagna posten ligger kvar i strängpoolen tills
+*                      person_store_clear anropas.
+*
+*                      - self : Pekare till aktuell person_store.
+*                      - index: Index för posten som ska tas bort.
+********************************************************************************/
+void person_store_remove(struct person_store* self,
+                         const size_t index)
+{
+   if (index >= self->size) return;
+   const size_t last = --self->size;
+   self->ages[index] = self->ages[last];
+   self->genders[index] = self->genders[last];
+   self->names[index] = self->names[last];
+   self->addresses[index] = self->addresses[last];
+   self->occupations[index] = self->occupations[last];
+   return;
+}
+
+/********************************************************************************
+* person_store_size: Returnerar antalet personer lagrade i angiven person_store.
+*
+*                    - self: Pekare till aktuell person_store.
+********************************************************************************/
+size_t person_store_size(const struct person_store* self)
+{
+   return self->size;
+}
+
+/********************************************************************************
+* person_store_name: Returnerar namnet för posten på angivet index.
+*
+*                    - self : Pekare till aktuell person_store.
+*                    - index: Postens index.
+********************************************************************************/
+const char* person_store_name(const struct person_store* self,
+                              const size_t index)
+{
+   return self->strings + self->names[index];
+}
+
+/********************************************************************************
+* person_store_age: Returnerar åldern för posten på angivet index.
+*
+*                   - self : Pekare till aktuell person_store.
+*                   - index: Postens index.
+********************************************************************************/
+unsigned int person_store_age(const struct person_store* self,
+                              const size_t index)
+{
+   return self->ages[index];
+}
+
+/********************************************************************************
+* person_store_address: Returnerar hemadressen för posten på angivet index.
+*
+*                       - self : Pekare till aktuell person_store.
+*                       - index: Postens index.
+********************************************************************************/
+const char* person_store_address(const struct person_store* self,
+                                 const size_t index)
+{
+   return self->strings + self->addresses[index];
+}
+
+/********************************************************************************
+* person_store_occupation: Returnerar yrket för posten på angivet index.
+*
+*                          - self : Pekare till aktuell person_store.
+*                          - index: Postens index.
+********************************************************************************/
+const char* person_store_occupation(const struct person_store* self,
+                                    const size_t index)
+{
+   return self->strings + self->occupations[index];
+}
+
+/********************************************************************************
+* person_store_gender: Returnerar könet för posten på angivet index.
+*
+*                      - self : Pekare till aktuell person_store.
+*                      - index: Postens index.
+********************************************************************************/
+enum gender person_store_gender(const struct person_store* self,
+                                const size_t index)
+{
+   return (enum gender)self->genders[index];
+}
+
+/********************************************************************************
+* person_store_view: Initierar en vy över posten på angivet index och returnerar
+*                    en pekare till vyns person-objekt, som kan användas precis
+*                    som ett person-objekt initierat via person_init.
+*
+*                    - self : Pekare till aktuell person_store.
+*                    - index: Postens index.
+*                    - view : Pekare till vyn som ska initieras.
+********************************************************************************/
+struct person* person_store_view(const struct person_store* self,
+                                 const size_t index,
+                                 struct person_store_view* view)
+{
+   view->base.mem = 0;
+   view->base.vptr = person_store_vtable_ptr_new();
+   view->store = self;
+   view->index = index;
+   return &view->base;
+}
+
+/********************************************************************************
+* person_store_filter_age: Lagrar index för samtliga poster vars ålder ligger
+*                          inom intervallet [min_age, max_age] i angiven array
+*                          och returnerar antalet träffar. Arrayen måste rymma
+*                          minst person_store_size(self) element.
+*
+*                          - self   : Pekare till aktuell person_store.
+*                          - min_age: Lägsta ålder som ska inkluderas.
+*                          - max_age: Högsta ålder som ska inkluderas.
+*                          - indices: Array där index för träffarna lagras.
+********************************************************************************/
+size_t person_store_filter_age(const struct person_store* self,
+                               const unsigned int min_age,
+                               const unsigned int max_age,
+                               size_t* indices)
+{
+   const unsigned int* ages = self->ages;
+   size_t count = 0;
+
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      indices[count] = i;
+      count += ages[i] >= min_age && ages[i] <= max_age;
+   }
+   return count;
+}
+
+/********************************************************************************
+* person_store_filter_gender: Lagrar index för samtliga poster med angivet kön
+*                             i angiven array och returnerar antalet träffar.
+*                             Arrayen måste rymma minst person_store_size(self)
+*                             element.
+*
+*                             - self   : Pekare till aktuell person_store.
+*                             - gender : Könet som ska matchas.
+*                             - indices: Array där index för träffarna lagras.
+********************************************************************************/
+size_t person_store_filter_gender(const struct person_store* self,
+                                  const enum gender gender,
+                                  size_t* indices)
+{
+   const unsigned char* genders = self->genders;
+   const unsigned char value = (unsigned char)gender;
+   size_t count = 0;
+
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      indices[count] = i;
+      count += genders[i] == value;
+   }
+   return count;
+}
+
+/********************************************************************************
+* person_store_print: Skriver ut samtliga lagrade personer via angiven utström,
+*                     där standardutenheten stdout används som default.
+*                     Utskriften sker buffrat via en person_writer.
+*
+*                     - self   : Pekare till aktuell person_store.
+*                     - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+void person_store_print(const struct person_store* self,
+                        FILE* ostream)
+{
+   struct person_store_view view;
+   struct person_writer writer;
+
+   if (person_writer_init(&writer, ostream, 0))
+   {
+      for (size_t i = 0; i < self->size; ++i)
+      {
+         person_print(person_store_view(self, i, &view), ostream);
+      }
+      return;
+   }
+
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      if (person_writer_put(&writer, person_store_view(self, i, &view))) break;
+   }
+
+   person_writer_clear(&writer);
+   return;
+}
+
+/********************************************************************************
+* person_store_vtable_ptr_new: Returnerar en pekare till ett statiskt vtable
+*                              för vyer över poster i en person_store.
+*                              Utskrift sker via person_print, som läser
+*                              persondatan via vyns accessorer.
+********************************************************************************/
+static const struct person_vtable* person_store_vtable_ptr_new(void)
+{
+   static const struct person_vtable self =
+   {
+      .print = &person_print,
+      .gender_str = &person_store_view_gender_str,
+      .name = &person_store_view_name,
+      .age = &person_store_view_age,
+      .address = &person_store_view_address,
+      .occupation = &person_store_view_occupation,
+      .gender = &person_store_view_gender,
+      .clear = &person_store_view_clear
+   };
+
+   return &self;
+}
+
+/********************************************************************************
+* person_store_grow: Fördubblar kapaciteten för angiven person_store. Vid
+*                    lyckad omallokering returneras 0, annars returneras 1.
+*
+*                    - self: Pekare till aktuell person_store.
+********************************************************************************/
+static int person_store_grow(struct person_store* self)
+{
+   return person_store_reserve(self, self->capacity ? self->capacity * 2 : 16);
+}
+
+/********************************************************************************
+* person_store_strings_reserve: Säkerställer att strängpoolen rymmer angivna
+*                               strängar. Strängar som redan ligger i poolen,
+*                               exempelvis från en vy över samma person_store,
+*                               pekas om till poolens nya adress om poolen
+*                               omallokeras. Vid lyckad reservation returneras
+*                               0, annars returneras 1.
+*
+*                               - self   : Pekare till aktuell person_store.
+*                               - strings: Strängarna som ska lagras.
+********************************************************************************/
+static int person_store_strings_reserve(struct person_store* self,
+                                        const char* strings[PERSON_STORE_STRINGS])
+{
+   size_t pooled[PERSON_STORE_STRINGS];
+   size_t length = 0;
+
+   for (size_t i = 0; i < PERSON_STORE_STRINGS; ++i)
+   {
+      const uintptr_t address = (uintptr_t)strings[i];
+      const uintptr_t begin = (uintptr_t)self->strings;
+      pooled[i] = self->strings && address >= begin && address < begin + self->strings_size ?
+                  (size_t)(address - begin) : SIZE_MAX;
+      length += strlen(strings[i]) + 1;
+   }
+
+   if (self->strings_size + length <= self->strings_capacity) return 0;
+   size_t capacity = self->strings_capacity ? self->strings_capacity : 256;
+   while (self->strings_size + length > capacity) capacity *= 2;
+   char* pool = (char*)realloc(self->strings, capacity);
+   if (!pool) return 1;
+   self->strings = pool;
+   self->strings_capacity = capacity;
+
+   for (size_t i = 0; i < PERSON_STORE_STRINGS; ++i)
+   {
+      if (pooled[i] != SIZE_MAX) strings[i] = pool + pooled[i];
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_store_string_new: Kopierar angiven sträng till strängpoolen och
+*                          returnerar dess offset. Poolen måste ha reserverats
+*                          via person_store_strings_reserve.
+*
+*                          - self: Pekare till aktuell person_store.
+*                          - s   : Strängen som ska kopieras.
+********************************************************************************/
+static size_t person_store_string_new(struct person_store* self,
+                                      const char* s)
+{
+   const size_t length = strlen(s) + 1;
+   const size_t offset = self->strings_size;
+   memcpy(self->strings + offset, s, length);
+   self->strings_size += length;
+   return offset;
+}
+
+/********************************************************************************
+* person_store_view_name: Returnerar namnet för posten som vyn refererar till.
+*
+*                         - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_store_view_name(const struct person* self)
+{
+   const struct person_store_view* view = (const struct person_store_view*)self;
+   return person_store_name(view->store, view->index);
+}
+
+/********************************************************************************
+* person_store_view_age: Returnerar åldern för posten som vyn refererar till.
+*
+*                        - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static unsigned int person_store_view_age(const struct person* self)
+{
+   const struct person_store_view* view = (const struct person_store_view*)self;
+   return person_store_age(view->store, view->index);
+}
+
+/********************************************************************************
+* person_store_view_address: Returnerar hemadressen för posten som vyn
+*                            refererar till.
+*
+*                            - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_store_view_address(const struct person* self)
+{
+   const struct person_store_view* view = (const struct person_store_view*)self;
+   return person_store_address(view->store, view->index);
+}
+
+/********************************************************************************
+* person_store_view_occupation: Returnerar yrket för posten som vyn refererar
+*                               till.
+*
+*                               - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_store_view_occupation(const struct person* self)
+{
+   const struct person_store_view* view = (const struct person_store_view*)self;
+   return person_store_occupation(view->store, view->index);
+}
+
+/********************************************************************************
+* person_store_view_gender: Returnerar könet för posten som vyn refererar till.
+*
+*                           - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static enum gender person_store_view_gender(const struct person* self)
+{
+   const struct person_store_view* view = (const struct person_store_view*)self;
+   return person_store_gender(view->store, view->index);
+}
+
+/********************************************************************************
+* person_store_view_gender_str: Returnerar könet för posten som vyn refererar
+*                               till på textform.
+*
+*                               - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static const char* person_store_view_gender_str(const struct person* self)
+{
+   return gender_str(person_store_view_gender(self));
+}
+
+/********************************************************************************
+* person_store_view_clear: Nollställer vyn. Den underliggande posten påverkas
+*                          inte, utan tas bort via person_store_remove.
+*
+*                          - self: Pekare till vyns person-objekt.
+********************************************************************************/
+static void person_store_view_clear(struct person* self)
+{
+   struct person_store_view* view = (struct person_store_view*)self;
+   view->base.vptr = 0;
+   view->store = 0;
+   view->index = 0;
+   return;
+}
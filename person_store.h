@@ -0,0 +1,229 @@
+/********************************************************************************
+* person_store.h: Innehåller funktionalitet för kolumnbaserad lagring av stora
+*                 mängder persondata via strukten person_store. Istället för
+*                 ett heapallokerat person_mem-block per person lagras varje
+*                 fält i en egen sammanhängande array (struct-of-arrays), vilket
+*                 gör att exempelvis filtrering på ålder eller kön kan ske
+*                 utan pekarjakt. Enskilda poster kan vid behov användas som
+*                 vanliga person-objekt via vyer av typen person_store_view.
+********************************************************************************/
+#ifndef PERSON_STORE_H_
+#define PERSON_STORE_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+
+/********************************************************************************
+* person_store: Strukt för kolumnbaserad lagring av persondata. Textfälten
+*               lagras i en gemensam strängpool och refereras via offset,
+*               vilket gör att poolen kan växa utan att offseten blir ogiltiga.
+********************************************************************************/
+typedef struct person_store
+{
+   unsigned int* ages;       /* Personernas åldrar. */
+   unsigned char* genders;   /* Personernas kön, lagrade som en byte per person. */
+   size_t* names;            /* Offset till respektive namn i strängpoolen. */
+   size_t* addresses;        /* Offset till respektive hemadress i strängpoolen. */
+   size_t* occupations;      /* Offset till respektive yrke i strängpoolen. */
+   char* strings;            /* Strängpool innehållande samtliga textfält. */
+   size_t strings_size;      /* Antal använda bytes i strängpoolen. */
+   size_t strings_capacity;  /* Strängpoolens kapacitet i bytes. */
+   size_t size;              /* Antal lagrade personer. */
+   size_t capacity;          /* Antal personer som ryms innan omallokering. */
+} person_store_t, *person_store_ptr_t;
+
+/********************************************************************************
+* person_store_view: Vy över en enskild post i en person_store. Vyn innehåller
+*                    ett person-objekt som första medlem, vilket medför att
+*                    adressen till vyn kan användas som ett vanligt person-objekt
+*                    och att samtliga anrop via person_vtable fungerar. Pekare
+*                    till textfält som returneras via vyn är giltiga tills
+*                    strängpoolen omallokeras, dvs. nästa gång data läggs till.
+********************************************************************************/
+typedef struct person_store_view
+{
+   struct person base;               /* Basobjekt, används vid anrop via vtable. */
+   const struct person_store* store; /* Pekare till tillhörande person_store. */
+   size_t index;                     /* Postens index i person_store. */
+} person_store_view_t, *person_store_view_ptr_t;
+
+/********************************************************************************
+* person_store_init: Initierar en ny tom person_store.
+*
+*                    - self: Pekare till objektet som ska initieras.
+********************************************************************************/
+void person_store_init(struct person_store* self);
+
+/********************************************************************************
+* person_store_clear: Frigör minne allokerat av angiven person_store och
+*                     nollställer denna.
+*
+*                     - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_store_clear(struct person_store* self);
+
+/********************************************************************************
+* person_store_reserve: Allokerar minne så att minst angivet antal personer
+*                       ryms utan ytterligare omallokering. Vid lyckad
+*                       allokering returneras 0, annars returneras 1.
+*
+*                       - self    : Pekare till aktuell person_store.
+*                       - capacity: Antal personer som ska rymmas.
+********************************************************************************/
+int person_store_reserve(struct person_store* self,
+                         const size_t capacity);
+
+/********************************************************************************
+* person_store_push: Lägger till en ny person sist i angiven person_store.
+*                    Textfälten kopieras in i strängpoolen, vilket medför att
+*                    anroparen inte behöver behålla originalsträngarna.
+*                    Strängarna får ligga i samma person_store, exempelvis
+*                    via en vy eller person_store_name. En nullpekare lagras
+*                    som en tom sträng. Vid lyckad tilläggning returneras 0,
+*                    annars returneras 1.
+*
+*                    - self      : Pekare till aktuell person_store.
+*                    - name      : Personens namn.
+*                    - age       : Personens ålder.
+*                    - address   : Personens hemadress.
+*                    - occupation: Personens yrke.
+*                    - gender    : Personens kön.
+********************************************************************************/
+int person_store_push(struct person_store* self,
+                      const char* name,
+                      const unsigned int age,
+                      const char* address,
+                      const char* occupation,
+                      const enum gender gender);
+
+/********************************************************************************
+* person_store_push_person: Kopierar persondata från angivet person-objekt och
+*                           lägger till denna sist i angiven person_store.
+*                           Vid lyckad tilläggning returneras 0, annars 1.
+*
+*                           - self  : Pekare till aktuell person_store.
+*                           - person: Pekare till objektet vars data ska kopieras.
+********************************************************************************/
+int person_store_push_person(struct person_store* self,
+                             const struct person* person);
+
+/********************************************************************************
+* person_store_remove: Tar bort posten på angivet index genom att flytta den
+*                      sista posten till dess plats. Borttagningen sker därmed
+*                      i konstant tid, men postordningen bevaras inte. Texten
+*                      för den borttagna posten ligger kvar i strängpoolen tills
+*                      person_store_clear anropas.
+*
+*                      - self : Pekare till aktuell person_store.
+*                      - index: Index för posten som ska tas bort.
+********************************************************************************/
+void person_store_remove(struct person_store* self,
+                         const size_t index);
+
+/********************************************************************************
+* person_store_size: Returnerar antalet personer lagrade i angiven person_store.
+*
+*                    - self: Pekare till aktuell person_store.
+********************************************************************************/
+size_t person_store_size(const struct person_store* self);
+
+/********************************************************************************
+* person_store_name: Returnerar namnet för posten på angivet index.
+*
+*                    - self : Pekare till aktuell person_store.
+*                    - index: Postens index.
+********************************************************************************/
+const char* person_store_name(const struct person_store* self,
+                              const size_t index);
+
+/********************************************************************************
+* person_store_age: Returnerar åldern för posten på angivet index.
+*
+*                   - self : Pekare till aktuell person_store.
+*                   - index: Postens index.
+********************************************************************************/
+unsigned int person_store_age(const struct person_store* self,
+                              const size_t index);
+
+/********************************************************************************
+* person_store_address: Returnerar hemadressen för posten på angivet index.
+*
+*                       - self : Pekare till aktuell person_store.
+*                       - index: Postens index.
+********************************************************************************/
+const char* person_store_address(const struct person_store* self,
+                                 const size_t index);
+
+/********************************************************************************
+* person_store_occupation: Returnerar yrket för posten på angivet index.
+*
+*                          - self : Pekare till aktuell person_store.
+*                          - index: Postens index.
+********************************************************************************/
+const char* person_store_occupation(const struct person_store* self,
+                                    const size_t index);
+
+/********************************************************************************
+* person_store_gender: Returnerar könet för posten på angivet index.
+*
+*                      - self : Pekare till aktuell person_store.
+*                      - index: Postens index.
+********************************************************************************/
+enum gender person_store_gender(const struct person_store* self,
+                                const size_t index);
+
+/********************************************************************************
+* person_store_view: Initierar en vy över posten på angivet index och returnerar
+*                    en pekare till vyns person-objekt, som kan användas precis
+*                    som ett person-objekt initierat via person_init.
+*
+*                    - self : Pekare till aktuell person_store.
+*                    - index: Postens index.
+*                    - view : Pekare till vyn som ska initieras.
+********************************************************************************/
+struct person* person_store_view(const struct person_store* self,
+                                 const size_t index,
+                                 struct person_store_view* view);
+
+/********************************************************************************
+* person_store_filter_age: Lagrar index för samtliga poster vars ålder ligger
+*                          inom intervallet [min_age, max_age] i angiven array
+*                          och returnerar antalet träffar. Arrayen måste rymma
+*                          minst person_store_size(self) element.
+*
+*                          - self   : Pekare till aktuell person_store.
+*                          - min_age: Lägsta ålder som ska inkluderas.
+*                          - max_age: Högsta ålder som ska inkluderas.
+*                          - indices: Array där index för träffarna lagras.
+********************************************************************************/
+size_t person_store_filter_age(const struct person_store* self,
+                               const unsigned int min_age,
+                               const unsigned int max_age,
+                               size_t* indices);
+
+/********************************************************************************
+* person_store_filter_gender: Lagrar index för samtliga poster med angivet kön
+*                             i angiven array och returnerar antalet träffar.
+*                             Arrayen måste rymma minst person_store_size(self)
+*                             element.
+*
+*                             - self   : Pekare till aktuell person_store.
+*                             - gender : Könet som ska matchas.
+*                             - indices: Array där index för träffarna lagras.
+********************************************************************************/
+size_t person_store_filter_gender(const struct person_store* self,
+                                  const enum gender gender,
+                                  size_t* indices);
+
+/********************************************************************************
+* person_store_print: Skriver ut samtliga lagrade personer via angiven utström,
+*                     där standardutenheten stdout används som default.
+*                     Utskriften sker buffrat via en person_writer.
+*
+*                     - self   : Pekare till aktuell person_store.
+*                     - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+void person_store_print(const struct person_store* self,
+                        FILE* ostream);
+
+#endif /* PERSON_STORE_H_ */
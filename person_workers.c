@@ -0,0 +1,193 @@
+/********************************************************************************
+* person_workers.c: Innehåller definitioner av associerade funktioner
+*                   tillhörande strukten person_workers, som används för att
+*                   fördela arbete över flera trådar.
+********************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "person_workers.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+/********************************************************************************
+* person_workers_arg: Argument till en bakgrundstråd.
+********************************************************************************/
+struct person_workers_arg
+{
+   struct person_workers* workers; /* Pekare till tillhörande pool. */
+   size_t worker;                  /* Trådens nummer. */
+};
+
+/* Statiska funktioner: */
+static void* person_workers_main(void* arg);
+
+/********************************************************************************
+* person_workers_init: Initierar en ny trådpool med angivet antal trådar. Vid
+*                      lyckad initiering returneras 0, annars returneras 1.
+*
+*                      - self : Pekare till poolen som ska initieras.
+*                      - count: Antal trådar inklusive den anropande tråden
+*                               (0 = antal tillgängliga processorkärnor).
+********************************************************************************/
+int person_workers_init(struct person_workers* self,
+                        size_t count)
+{
+   if (!count)
+   {
+      const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+      count = cpus > 0 ? (size_t)cpus : 1;
+   }
+
+   self->threads = 0;
+   self->count = 1;
+   self->job = 0;
+   self->context = 0;
+   self->generation = 0;
+   self->pending = 0;
+   self->stop = 0;
+
+   if (pthread_mutex_init(&self->mutex, 0)) return 1;
+   if (pthread_cond_init(&self->start, 0) || pthread_cond_init(&self->done, 0))
+   {
+      pthread_mutex_destroy(&self->mutex);
+      return 1;
+   }
+   if (count == 1) return 0;
+
+   self->threads = (pthread_t*)malloc((count - 1) * sizeof(pthread_t));
+   struct person_workers_arg* args = (struct person_workers_arg*)malloc(
+      (count - 1) * sizeof(struct person_workers_arg));
+   if (!self->threads || !args)
+   {
+      free(args);
+      person_workers_clear(self);
+      return 1;
+   }
+
+   for (size_t i = 1; i < count; ++i)
+   {
+      args[i - 1].workers = self;
+      args[i - 1].worker = i;
+   }
+
+   for (size_t i = 1; i < count; ++i)
+   {
+      if (pthread_create(self->threads + i - 1, 0, &person_workers_main, args + i - 1)) break;
+      self->count++;
+   }
+
+   /* Trådarna läser sina argument innan de väntar på första jobbet. */
+   person_workers_run(self, 0, 0);
+   free(args);
+   return 0;
+}
+
+/********************************************************************************
+* person_workers_clear: Avslutar poolens trådar och frigör allokerat minne.
+*
+*                       - self: Pekare till poolen som ska nollställas.
+********************************************************************************/
+void person_workers_clear(struct person_workers* self)
+{
+   pthread_mutex_lock(&self->mutex);
+   self->stop = 1;
+   pthread_cond_broadcast(&self->start);
+   pthread_mutex_unlock(&self->mutex);
+
+   for (size_t i = 1; i < self->count; ++i)
+   {
+      pthread_join(self->threads[i - 1], 0);
+   }
+
+   free(self->threads);
+   pthread_cond_destroy(&self->start);
+   pthread_cond_destroy(&self->done);
+   pthread_mutex_destroy(&self->mutex);
+   self->threads = 0;
+   self->count = 0;
+   return;
+}
+
+/********************************************************************************
+* person_workers_count: Returnerar antalet trådar i poolen inklusive den
+*                       anropande tråden. En nullpekare motsvarar en tråd.
+*
+*                       - self: Pekare till aktuell pool (eller null).
+********************************************************************************/
+size_t person_workers_count(const struct person_workers* self)
+{
+   return self ? self->count : 1;
+}
+
+/********************************************************************************
+* person_workers_run: Kör angivet jobb på samtliga trådar i poolen och väntar
+*                     tills samtliga trådar är klara. Om poolen är null så
+*                     körs jobbet enbart av den anropande tråden.
+*
+*                     - self   : Pekare till aktuell pool (eller null).
+*                     - job    : Jobbet som ska köras.
+*                     - context: Kontext som passeras till jobbet.
+********************************************************************************/
+void person_workers_run(struct person_workers* self,
+                        person_workers_job_t job,
+                        void* context)
+{
+   if (!self || self->count == 1)
+   {
+      if (job) job(context, 0, 1);
+      return;
+   }
+
+   pthread_mutex_lock(&self->mutex);
+   self->job = job;
+   self->context = context;
+   self->pending = self->count - 1;
+   self->generation++;
+   pthread_cond_broadcast(&self->start);
+   pthread_mutex_unlock(&self->mutex);
+
+   if (job) job(context, 0, self->count);
+
+   pthread_mutex_lock(&self->mutex);
+   while (self->pending) pthread_cond_wait(&self->done, &self->mutex);
+   pthread_mutex_unlock(&self->mutex);
+   return;
+}
+
+/********************************************************************************
+* person_workers_main: Huvudfunktion för poolens bakgrundstrådar. Tråden väntar
+*                      på nya jobb, kör dessa och signalerar när den är klar,
+*                      tills poolen avslutas.
+*
+*                      - arg: Pekare till trådens argument.
+********************************************************************************/
+static void* person_workers_main(void* arg)
+{
+   struct person_workers* self = ((struct person_workers_arg*)arg)->workers;
+   const size_t worker = ((struct person_workers_arg*)arg)->worker;
+   size_t generation = 0;
+
+   pthread_mutex_lock(&self->mutex);
+
+   for (;;)
+   {
+      while (!self->stop && self->generation == generation)
+      {
+         pthread_cond_wait(&self->start, &self->mutex);
+      }
+      if (self->stop) break;
+
+      generation = self->generation;
+      const person_workers_job_t job = self->job;
+      void* context = self->context;
+      const size_t count = self->count;
+      pthread_mutex_unlock(&self->mutex);
+
+      if (job) job(context, worker, count);
+
+      pthread_mutex_lock(&self->mutex);
+      if (--self->pending == 0) pthread_cond_signal(&self->done);
+   }
+
+   pthread_mutex_unlock(&self->mutex);
+   return 0;
+}
@@ -0,0 +1,84 @@
+/********************************************************************************
+* person_workers.h: Innehåller en enkel trådpool via strukten person_workers,
+*                   som används för att fördela arbete över samtliga
+*                   processorkärnor, exempelvis vid parallella frågor över en
+*                   person_store. Trådarna skapas en gång och återanvänds
+*                   sedan för varje jobb.
+********************************************************************************/
+#ifndef PERSON_WORKERS_H_
+#define PERSON_WORKERS_H_
+
+/* Inkluderingsdirektiv: */
+#include <stddef.h>  /* Innehåller typen size_t. */
+#include <pthread.h> /* Innehåller funktionalitet för trådar. */
+
+/********************************************************************************
+* person_workers_job_t: Funktionspekare för ett jobb som körs av samtliga
+*                       trådar i poolen.
+*
+*                       - context: Kontext angiven vid start av jobbet.
+*                       - worker : Trådens nummer, 0 till worker_count - 1.
+*                       - count  : Antal trådar som kör jobbet.
+********************************************************************************/
+typedef void (*person_workers_job_t)(void* context,
+                                     const size_t worker,
+                                     const size_t count);
+
+/********************************************************************************
+* person_workers: Trådpool där den anropande tråden deltar som tråd 0 och
+*                 övriga trådar väntar på nya jobb mellan körningarna.
+********************************************************************************/
+typedef struct person_workers
+{
+   pthread_t* threads;       /* Poolens bakgrundstrådar. */
+   size_t count;             /* Antal trådar inklusive den anropande tråden. */
+   pthread_mutex_t mutex;    /* Mutex som skyddar poolens tillstånd. */
+   pthread_cond_t start;     /* Signaleras när ett nytt jobb finns. */
+   pthread_cond_t done;      /* Signaleras när en tråd blir klar med jobbet. */
+   person_workers_job_t job; /* Aktuellt jobb. */
+   void* context;            /* Kontext för aktuellt jobb. */
+   size_t generation;        /* Räknas upp för varje nytt jobb. */
+   size_t pending;           /* Antal bakgrundstrådar som inte är klara. */
+   int stop;                 /* Indikerar att trådarna ska avslutas. */
+} person_workers_t, *person_workers_ptr_t;
+
+/********************************************************************************
+* person_workers_init: Initierar en ny trådpool med angivet antal trådar. Vid
+*                      lyckad initiering returneras 0, annars returneras 1.
+*
+*                      - self : Pekare till poolen som ska initieras.
+*                      - count: Antal trådar inklusive den anropande tråden
+*                               (0 = antal tillgängliga processorkärnor).
+********************************************************************************/
+int person_workers_init(struct person_workers* self,
+                        size_t count);
+
+/********************************************************************************
+* person_workers_clear: Avslutar poolens trådar och frigör allokerat minne.
+*
+*                       - self: Pekare till poolen som ska nollställas.
+********************************************************************************/
+void person_workers_clear(struct person_workers* self);
+
+/********************************************************************************
+* person_workers_count: Returnerar antalet trådar i poolen inklusive den
+*                       anropande tråden. En nullpekare motsvarar en tråd.
+*
+*                       - self: Pekare till aktuell pool (eller null).
+********************************************************************************/
+size_t person_workers_count(const struct person_workers* self);
+
+/********************************************************************************
+* person_workers_run: Kör angivet jobb på samtliga trådar i poolen och väntar
+*                     tills samtliga trådar är klara. Om poolen är null så
+*                     körs jobbet enbart av den anropande tråden.
+*
+*                     - self   : Pekare till aktuell pool (eller null).
+*                     - job    : Jobbet som ska köras.
+*                     - context: Kontext som passeras till jobbet.
+********************************************************************************/
+void person_workers_run(struct person_workers* self,
+                        person_workers_job_t job,
+                        void* context);
+
+#endif /* PERSON_WORKERS_H_ */
@@ -0,0 +1,245 @@
+/********************************************************************************
+* person_writer.c: Innehåller definitioner av associerade funktioner
+*                  tillhörande strukten person_writer, som används för
+*                  buffrad utskrift av stora mängder persondata.
+********************************************************************************/
+#include "person_writer.h"
+#include <string.h>
+
+/* Avskiljare som skrivs före samt efter varje person, se person_print. */
+#define PERSON_WRITER_SEPARATOR \
+   "--------------------------------------------------------------------------------\n"
+
+/* Statiska funktioner: */
+static char* person_writer_copy(char* dst,
+                                const char* src,
+                                const size_t length);
+static size_t person_writer_uint_str(unsigned int value,
+                                     char* digits);
+
+/********************************************************************************
+* person_writer_init: Initierar en ny person_writer med en buffert av angiven
+*                     storlek. Vid lyckad allokering returneras 0, annars 1.
+*
+*                     - self    : Pekare till objektet som ska initieras.
+*                     - ostream : Pekare till angiven utström (default = stdout).
+*                     - capacity: Buffertens storlek i bytes (0 = 64 kB).
+********************************************************************************/
+int person_writer_init(struct person_writer* self,
+                       FILE* ostream,
+                       const size_t capacity)
+{
+   self->capacity = capacity ? capacity : 64 * 1024;
+   self->buffer = (char*)malloc(self->capacity);
+   self->size = 0;
+   self->ostream = ostream ? ostream : stdout;
+
+   if (!self->buffer)
+   {
+      self->capacity = 0;
+      return 1;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* person_writer_clear: Tömmer kvarvarande data till utströmmen, frigör
+*                      bufferten och nollställer angiven person_writer.
+*
+*                      - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_writer_clear(struct person_writer* self)
+{
+   person_writer_flush(self);
+   free(self->buffer);
+   self->buffer = 0;
+   self->size = 0;
+   self->capacity = 0;
+   self->ostream = 0;
+   return;
+}
+
+/********************************************************************************
+* person_writer_put: Formaterar angivet person-objekt in i bufferten. Bufferten
+*                    töms automatiskt när den blir full. Om skrivning till
+*                    utströmmen misslyckas returneras 1, annars returneras 0.
+*
+*                    - self  : Pekare till aktuell person_writer.
+*                    - person: Pekare till objektet som ska skrivas ut.
+********************************************************************************/
+int person_writer_put(struct person_writer* self,
+                      const struct person* person)
+{
+   size_t length = person_writer_format(person, self->buffer + self->size,
+                                        self->capacity - self->size);
+
+   if (length > self->capacity - self->size)
+   {
+      if (person_writer_flush(self)) return 1;
+      length = person_writer_format(person, self->buffer, self->capacity);
+
+      if (length > self->capacity)
+      {
+         person_print(person, self->ostream);
+         return ferror(self->ostream) ? 1 : 0;
+      }
+   }
+
+   self->size += length;
+   return 0;
+}
+
+/********************************************************************************
+* person_writer_flush: Skriver buffrad data till utströmmen via ett anrop av
+*                      fwrite. Om skrivningen misslyckas returneras 1, annars
+*                      returneras 0.
+*
+*                      - self: Pekare till aktuell person_writer.
+********************************************************************************/
+int person_writer_flush(struct person_writer* self)
+{
+   if (!self->size) return 0;
+   const size_t written = fwrite(self->buffer, 1, self->size, self->ostream);
+   const int error = written != self->size;
+   self->size = 0;
+   return error;
+}
+
+/********************************************************************************
+* person_writer_format: Formaterar angivet person-objekt till angiven buffert
+*                       i samma format som person_print och returnerar antalet
+*                       bytes som formateringen kräver. Om detta överstiger
+*                       buffertens kapacitet så skrivs ingenting till bufferten.
+*                       Ingen nolltecken läggs till.
+*
+*                       - person  : Pekare till objektet som ska formateras.
+*                       - buffer  : Pekare till bufferten som ska skrivas till.
+*                       - capacity: Buffertens kapacitet i bytes.
+********************************************************************************/
+size_t person_writer_format(const struct person* person,
+                            char* buffer,
+                            const size_t capacity)
+{
+   const char* name = person->vptr->name(person);
+   const char* address = person->vptr->address(person);
+   const char* occupation = person->vptr->occupation(person);
+   const char* gender = person->vptr->gender_str(person);
+   char age[16];
+
+   if (!name) name = "(null)";
+   if (!address) address = "(null)";
+   if (!occupation) occupation = "(null)";
+
+   const size_t separator_length = sizeof(PERSON_WRITER_SEPARATOR) - 1;
+   const size_t name_length = strlen(name);
+   const size_t age_length = person_writer_uint_str(person->vptr->age(person), age);
+   const size_t address_length = strlen(address);
+   const size_t occupation_length = strlen(occupation);
+   const size_t gender_length = strlen(gender);
+
+   const size_t length = 2 * separator_length + 1 +
+      sizeof("Name: ") + name_length +
+      sizeof("Age: ") + age_length +
+      sizeof("Address: ") + address_length +
+      sizeof("Occupation: ") + occupation_length +
+      sizeof("Gender: ") + gender_length;
+   if (length > capacity) return length;
+
+   char* s = person_writer_copy(buffer, PERSON_WRITER_SEPARATOR, separator_length);
+   s = person_writer_copy(s, "Name: ", 6);
+   s = person_writer_copy(s, name, name_length);
+   *s++ = '\n';
+   s = person_writer_copy(s, "Age: ", 5);
+   s = person_writer_copy(s, age, age_length);
+   *s++ = '\n';
+   s = person_writer_copy(s, "Address: ", 9);
+   s = person_writer_copy(s, address, address_length);
+   *s++ = '\n';
+   s = person_writer_copy(s, "Occupation: ", 12);
+   s = person_writer_copy(s, occupation, occupation_length);
+   *s++ = '\n';
+   s = person_writer_copy(s, "Gender: ", 8);
+   s = person_writer_copy(s, gender, gender_length);
+   *s++ = '\n';
+   s = person_writer_copy(s, PERSON_WRITER_SEPARATOR, separator_length);
+   *s++ = '\n';
+   return length;
+}
+
+/********************************************************************************
+* person_print_many: Skriver ut angivna person-objekt via angiven utström i
+*                    samma format som person_print, men via en gemensam buffert
+*                    som töms med ett fåtal anrop av fwrite.
+*
+*                    - persons: Array innehållande pekare till objekten.
+*                    - count  : Antal objekt i arrayen.
+*                    - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+void person_print_many(const struct person* const* persons,
+                       const size_t count,
+                       FILE* ostream)
+{
+   struct person_writer writer;
+
+   if (person_writer_init(&writer, ostream, 0))
+   {
+      for (size_t i = 0; i < count; ++i)
+      {
+         person_print(persons[i], ostream);
+      }
+      return;
+   }
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      if (person_writer_put(&writer, persons[i])) break;
+   }
+
+   person_writer_clear(&writer);
+   return;
+}
+
+/********************************************************************************
+* person_writer_copy: Kopierar angivet antal tecken till angiven destination
+*                     och returnerar en pekare till positionen direkt efter
+*                     de kopierade tecknen.
+*
+*                     - dst   : Pekare till destinationen.
+*                     - src   : Pekare till tecknen som ska kopieras.
+*                     - length: Antal tecken som ska kopieras.
+********************************************************************************/
+static char* person_writer_copy(char* dst,
+                                const char* src,
+                                const size_t length)
+{
+   memcpy(dst, src, length);
+   return dst + length;
+}
+
+/********************************************************************************
+* person_writer_uint_str: Omvandlar angivet heltal till decimal text och
+*                         returnerar antalet siffror. Inget nolltecken läggs
+*                         till.
+*
+*                         - value : Heltalet som ska omvandlas.
+*                         - digits: Buffert som siffrorna skrivs till (minst
+*                                   10 tecken).
+********************************************************************************/
+static size_t person_writer_uint_str(unsigned int value,
+                                     char* digits)
+{
+   char reversed[16];
+   size_t length = 0;
+
+   do
+   {
+      reversed[length++] = (char)('0' + value % 10);
+      value /= 10;
+   } while (value);
+
+   for (size_t i = 0; i < length; ++i)
+   {
+      digits[i] = reversed[length - 1 - i];
+   }
+   return length;
+}
@@ -0,0 +1,94 @@
+/********************************************************************************
+* person_writer.h: Innehåller funktionalitet för buffrad utskrift av stora
+*                  mängder persondata via strukten person_writer. Persondatan
+*                  formateras direkt in i en stor återanvändbar buffert utan
+*                  formatsträngar och skrivs sedan till utströmmen via ett
+*                  enda anrop av fwrite per fylld buffert. Utskriften är
+*                  identisk med den från person_print.
+********************************************************************************/
+#ifndef PERSON_WRITER_H_
+#define PERSON_WRITER_H_
+
+/* Inkluderingsdirektiv: */
+#include "person.h"
+
+/********************************************************************************
+* person_writer: Strukt för buffrad utskrift av persondata.
+********************************************************************************/
+typedef struct person_writer
+{
+   char* buffer;    /* Buffert innehållande formaterad persondata. */
+   size_t size;     /* Antal använda bytes i bufferten. */
+   size_t capacity; /* Buffertens kapacitet i bytes. */
+   FILE* ostream;   /* Utström som bufferten töms till. */
+} person_writer_t, *person_writer_ptr_t;
+
+/********************************************************************************
+* person_writer_init: Initierar en ny person_writer med en buffert av angiven
+*                     storlek. Vid lyckad allokering returneras 0, annars 1.
+*
+*                     - self    : Pekare till objektet som ska initieras.
+*                     - ostream : Pekare till angiven utström (default = stdout).
+*                     - capacity: Buffertens storlek i bytes (0 = 64 kB).
+********************************************************************************/
+int person_writer_init(struct person_writer* self,
+                       FILE* ostream,
+                       const size_t capacity);
+
+/********************************************************************************
+* person_writer_clear: Tömmer kvarvarande data till utströmmen, frigör
+*                      bufferten och nollställer angiven person_writer.
+*
+*                      - self: Pekare till objektet som ska nollställas.
+********************************************************************************/
+void person_writer_clear(struct person_writer* self);
+
+/********************************************************************************
+* person_writer_put: Formaterar angivet person-objekt in i bufferten. Bufferten
+*                    töms automatiskt när den blir full. Om skrivning till
+*                    utströmmen misslyckas returneras 1, annars returneras 0.
+*
+*                    - self  : Pekare till aktuell person_writer.
+*                    - person: Pekare till objektet som ska skrivas ut.
+********************************************************************************/
+int person_writer_put(struct person_writer* self,
+                      const struct person* person);
+
+/********************************************************************************
+* person_writer_flush: Skriver buffrad data till utströmmen via ett anrop av
+*                      fwrite. Om skrivningen misslyckas returneras 1, annars
+*                      returneras 0.
+*
+*                      - self: Pekare till aktuell person_writer.
+********************************************************************************/
+int person_writer_flush(struct person_writer* self);
+
+/********************************************************************************
+* person_writer_format: Formaterar angivet person-objekt till angiven buffert
+*                       i samma format som person_print och returnerar antalet
+*                       bytes som formateringen kräver. Om detta överstiger
+*                       buffertens kapacitet så skrivs ingenting till bufferten.
+*                       Ingen nolltecken läggs till.
+*
+*                       - person  : Pekare till objektet som ska formateras.
+*                       - buffer  : Pekare till bufferten som ska skrivas till.
+*                       - capacity: Buffertens kapacitet i bytes.
+********************************************************************************/
+size_t person_writer_format(const struct person* person,
+                            char* buffer,
+                            const size_t capacity);
+
+/********************************************************************************
+* person_print_many: Skriver ut angivna person-objekt via angiven utström i
+*                    samma format som person_print, men via en gemensam buffert
+*                    som töms med ett fåtal anrop av fwrite.
+*
+*                    - persons: Array innehållande pekare till objekten.
+*                    - count  : Antal objekt i arrayen.
+*                    - ostream: Pekare till angiven utström (default = stdout).
+********************************************************************************/
+void person_print_many(const struct person* const* persons,
+                       const size_t count,
+                       FILE* ostream);
+
+#endif /* PERSON_WRITER_H_ */